@@ -46,8 +46,6 @@
 #include "dlpc34xx.h"
 #include "dlpc_common_private.h"
 
-static uint32_t s_Index;
-
 uint32_t DLPC34XX_WriteOperatingModeSelect(DLPC34XX_OperatingMode_e OperatingMode)
 {
     uint32_t Status = 0;
@@ -1530,10 +1528,7 @@ uint32_t DLPC34XX_ReadFlashStart(uint16_t Length, uint8_t *Data)
     Status = DLPC_COMMON_SendRead(Length);
     if (Status == 0)
     {
-        for (s_Index = 0; s_Index < Length; s_Index++)
-        {
-            Data[s_Index] = *(DLPC_COMMON_UnpackBytes(1));
-        }
+        memcpy(Data, DLPC_COMMON_UnpackBytes(Length), Length);
     }
     return Status;
 }
@@ -1566,10 +1561,7 @@ uint32_t DLPC34XX_ReadFlashContinue(uint16_t Length, uint8_t *Data)
     Status = DLPC_COMMON_SendRead(Length);
     if (Status == 0)
     {
-        for (s_Index = 0; s_Index < Length; s_Index++)
-        {
-            Data[s_Index] = *(DLPC_COMMON_UnpackBytes(1));
-        }
+        memcpy(Data, DLPC_COMMON_UnpackBytes(Length), Length);
     }
     return Status;
 }
@@ -46,8 +46,6 @@
 #include "dlpc34xx_dual.h"
 #include "dlpc_common_private.h"
 
-static uint32_t s_Index;
-
 uint32_t DLPC34XX_DUAL_WriteOperatingModeSelect(DLPC34XX_DUAL_OperatingMode_e OperatingMode)
 {
     uint32_t Status = 0;
@@ -1380,10 +1378,7 @@ uint32_t DLPC34XX_DUAL_ReadFlashStart(uint16_t Length, uint8_t *Data)
     Status = DLPC_COMMON_SendRead(Length);
     if (Status == 0)
     {
-        for (s_Index = 0; s_Index < Length; s_Index++)
-        {
-            Data[s_Index] = *(DLPC_COMMON_UnpackBytes(1));
-        }
+        memcpy(Data, DLPC_COMMON_UnpackBytes(Length), Length);
     }
     return Status;
 }
@@ -1416,10 +1411,7 @@ uint32_t DLPC34XX_DUAL_ReadFlashContinue(uint16_t Length, uint8_t *Data)
     Status = DLPC_COMMON_SendRead(Length);
     if (Status == 0)
     {
-        for (s_Index = 0; s_Index < Length; s_Index++)
-        {
-            Data[s_Index] = *(DLPC_COMMON_UnpackBytes(1));
-        }
+        memcpy(Data, DLPC_COMMON_UnpackBytes(Length), Length);
     }
     return Status;
 }
@@ -0,0 +1,568 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the helpers for reading back and verifying the flash of
+ *         the 347x controllers.
+ */
+
+#include "dlpc_common_private.h"
+#include "dlpc_common_platform.h"
+#include "dlpc_common_transport.h"
+#include "dlpc_common_tuning.h"
+#include "dlpc34xx.h"
+#include "dlpc34xx_flash.h"
+#include "string.h"
+
+#if defined(__SSE4_2__)
+#include "nmmintrin.h"
+#elif defined(__ARM_FEATURE_CRC32)
+#include "arm_acle.h"
+#endif
+
+#define OPCODE_READ_FLASH_START           0xE3
+#define OPCODE_READ_FLASH_CONTINUE        0xE4
+
+/* Smallest block size tried by the block size tuner */
+#define MIN_TUNED_BLOCK_SIZE              32
+
+/* Time allowed for a flash erase, and the interval the erase status is polled at */
+#define FLASH_ERASE_TIMEOUT_MS            30000
+#define FLASH_ERASE_POLL_INTERVAL_MS      10
+
+/* CRC32C (Castagnoli, reflected polynomial 0x82F63B78) lookup table */
+static const uint32_t s_Crc32cTable[256] =
+{
+    0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4,
+    0xC79A971F, 0x35F1141C, 0x26A1E7E8, 0xD4CA64EB,
+    0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B,
+    0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24,
+    0x105EC76F, 0xE235446C, 0xF165B798, 0x030E349B,
+    0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+    0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54,
+    0x5D1D08BF, 0xAF768BBC, 0xBC267848, 0x4E4DFB4B,
+    0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A,
+    0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35,
+    0xAA64D611, 0x580F5512, 0x4B5FA6E6, 0xB93425E5,
+    0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+    0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45,
+    0xF779DEAE, 0x05125DAD, 0x1642AE59, 0xE4292D5A,
+    0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A,
+    0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595,
+    0x417B1DBC, 0xB3109EBF, 0xA0406D4B, 0x522BEE48,
+    0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+    0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687,
+    0x0C38D26C, 0xFE53516F, 0xED03A29B, 0x1F682198,
+    0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927,
+    0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38,
+    0xDBFC821C, 0x2997011F, 0x3AC7F2EB, 0xC8AC71E8,
+    0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+    0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096,
+    0xA65C047D, 0x5437877E, 0x4767748A, 0xB50CF789,
+    0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859,
+    0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46,
+    0x7198540D, 0x83F3D70E, 0x90A324FA, 0x62C8A7F9,
+    0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+    0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36,
+    0x3CDB9BDD, 0xCEB018DE, 0xDDE0EB2A, 0x2F8B6829,
+    0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C,
+    0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93,
+    0x082F63B7, 0xFA44E0B4, 0xE9141340, 0x1B7F9043,
+    0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+    0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3,
+    0x55326B08, 0xA759E80B, 0xB4091BFF, 0x466298FC,
+    0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C,
+    0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033,
+    0xA24BB5A6, 0x502036A5, 0x4370C551, 0xB11B4652,
+    0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+    0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D,
+    0xEF087A76, 0x1D63F975, 0x0E330A81, 0xFC588982,
+    0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D,
+    0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622,
+    0x38CC2A06, 0xCAA7A905, 0xD9F75AF1, 0x2B9CD9F2,
+    0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+    0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530,
+    0x0417B1DB, 0xF67C32D8, 0xE52CC12C, 0x1747422F,
+    0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF,
+    0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0,
+    0xD3D3E1AB, 0x21B862A8, 0x32E8915C, 0xC083125F,
+    0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+    0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90,
+    0x9E902E7B, 0x6CFBAD78, 0x7FAB5E8C, 0x8DC0DD8F,
+    0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE,
+    0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1,
+    0x69E9F0D5, 0x9B8273D6, 0x88D28022, 0x7AB90321,
+    0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+    0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81,
+    0x34F4F86A, 0xC69F7B69, 0xD5CF889D, 0x27A40B9E,
+    0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E,
+    0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351,
+};
+
+uint32_t DLPC34XX_FLASH_Crc32c(uint32_t Crc, const uint8_t* Data, uint32_t Length)
+{
+    Crc = ~Crc;
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    while (Length >= 8)
+    {
+        uint64_t Word;
+        memcpy(&Word, Data, 8);
+#if defined(__SSE4_2__)
+        Crc = (uint32_t)_mm_crc32_u64(Crc, Word);
+#else
+        Crc = __crc32cd(Crc, Word);
+#endif
+        Data   += 8;
+        Length -= 8;
+    }
+#endif
+
+    while (Length > 0)
+    {
+        Crc = s_Crc32cTable[(Crc ^ *Data) & 0xFF] ^ (Crc >> 8);
+        Data++;
+        Length--;
+    }
+
+    return ~Crc;
+}
+
+/* Gets the largest block the command library write buffer can carry */
+static uint16_t GetWriteBlockSize()
+{
+    uint16_t BlockSize = DLPC_COMMON_GetWriteBufferSize();
+
+    /* Leave room for the opcode */
+    BlockSize = (BlockSize > 0) ? (BlockSize - 1) : 0;
+    if (BlockSize > DLPC34XX_FLASH_MAX_BLOCK_SIZE)
+    {
+        BlockSize = DLPC34XX_FLASH_MAX_BLOCK_SIZE;
+    }
+
+    return BlockSize;
+}
+
+/* Gets the largest block the command library read buffer can carry */
+static uint16_t GetReadBlockSize()
+{
+    uint16_t BlockSize = DLPC_COMMON_GetReadBufferSize();
+
+    if (BlockSize > DLPC34XX_FLASH_MAX_BLOCK_SIZE)
+    {
+        BlockSize = DLPC34XX_FLASH_MAX_BLOCK_SIZE;
+    }
+
+    return BlockSize;
+}
+
+/*
+ * Issues a Read Flash Start/Continue command and returns a pointer to the
+ * response in the command library read buffer. The pointer is valid until
+ * the next command is sent.
+ */
+static uint32_t ReadFlashBlock(bool Start, uint16_t Length, uint8_t** Block)
+{
+    uint32_t Status = 0;
+
+    DLPC_COMMON_ClearWriteBuffer();
+    DLPC_COMMON_ClearReadBuffer();
+
+    DLPC_COMMON_PackOpcode(1, Start ? OPCODE_READ_FLASH_START : OPCODE_READ_FLASH_CONTINUE);
+
+    DLPC_COMMON_SetCommandDestination(0);
+
+    Status = DLPC_COMMON_SendRead(Length);
+    if (Status == 0)
+    {
+        *Block = DLPC_COMMON_UnpackBytes(Length);
+    }
+    return Status;
+}
+
+/*
+ * Walks the selected flash data type in read blocks. BlockLength tracks the
+ * length last sent with Flash Data Length so the command is only resent for
+ * the final partial block.
+ */
+static uint32_t ReadNextBlock(uint32_t  Offset,
+                              uint32_t  Length,
+                              uint16_t  BlockSize,
+                              uint16_t* BlockLength,
+                              uint8_t** Block)
+{
+    uint32_t Status    = 0;
+    uint16_t NewLength = (uint16_t)((Length - Offset) < BlockSize ? (Length - Offset) : BlockSize);
+
+    if (NewLength != *BlockLength)
+    {
+        Status = DLPC34XX_WriteFlashDataLength(NewLength);
+        if (Status != 0)
+        {
+            return Status;
+        }
+        *BlockLength = NewLength;
+    }
+
+    return ReadFlashBlock(Offset == 0, NewLength, Block);
+}
+
+uint32_t DLPC34XX_FLASH_ReadFlash(DLPC34XX_FlashDataTypeSelect_e FlashSelect,
+                                  uint32_t                       Length,
+                                  uint8_t*                       Data)
+{
+    uint32_t Status      = 0;
+    uint16_t BlockSize   = GetReadBlockSize();
+    uint16_t BlockLength = 0;
+    uint32_t Offset      = 0;
+    uint8_t* Block;
+
+    if ((Data == NULL) || (BlockSize == 0))
+    {
+        return ERR_FLASH_INVALID_PARAMETER;
+    }
+
+    Status = DLPC_COMMON_AcquireBus();
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    Status = DLPC34XX_WriteFlashDataTypeSelect(FlashSelect);
+
+    while ((Status == 0) && (Offset < Length))
+    {
+        Status = ReadNextBlock(Offset, Length, BlockSize, &BlockLength, &Block);
+        if (Status == 0)
+        {
+            memcpy(&Data[Offset], Block, BlockLength);
+            Offset += BlockLength;
+        }
+    }
+
+    DLPC_COMMON_ReleaseBus();
+    return Status;
+}
+
+/* Returns the index of the first differing byte, or Length if the blocks match */
+static uint32_t FindMismatch(const uint8_t* Expected, const uint8_t* Actual, uint32_t Length)
+{
+    uint32_t Index = 0;
+    uint64_t ExpectedWord;
+    uint64_t ActualWord;
+
+    /* Skip matching words quickly, then locate the byte within the word */
+    while ((Index + 8) <= Length)
+    {
+        memcpy(&ExpectedWord, &Expected[Index], 8);
+        memcpy(&ActualWord, &Actual[Index], 8);
+        if (ExpectedWord != ActualWord)
+        {
+            break;
+        }
+        Index += 8;
+    }
+
+    while ((Index < Length) && (Expected[Index] == Actual[Index]))
+    {
+        Index++;
+    }
+
+    return Index;
+}
+
+uint32_t DLPC34XX_FLASH_VerifyFlash(DLPC34XX_FlashDataTypeSelect_e FlashSelect,
+                                    const uint8_t*                 Image,
+                                    uint32_t                       ImageSize,
+                                    DLPC34XX_FlashVerifyResult_s*  Result)
+{
+    DLPC34XX_FlashVerifyResult_s LocalResult;
+    uint32_t                     Status      = 0;
+    uint16_t                     BlockSize   = GetReadBlockSize();
+    uint16_t                     BlockLength = 0;
+    uint32_t                     Mismatch;
+    uint8_t*                     Block;
+
+    if (Result == NULL)
+    {
+        Result = &LocalResult;
+    }
+
+    Result->BytesVerified       = 0;
+    Result->FlashCrc32c         = 0;
+    Result->ImageCrc32c         = 0;
+    Result->FirstMismatchOffset = UINT32_MAX;
+
+    if ((Image == NULL) || (BlockSize == 0))
+    {
+        return ERR_FLASH_INVALID_PARAMETER;
+    }
+
+    Status = DLPC_COMMON_AcquireBus();
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    Status = DLPC34XX_WriteFlashDataTypeSelect(FlashSelect);
+
+    while ((Status == 0) && (Result->BytesVerified < ImageSize))
+    {
+        Status = ReadNextBlock(Result->BytesVerified, ImageSize, BlockSize, &BlockLength, &Block);
+        if (Status != 0)
+        {
+            break;
+        }
+
+        /* Compare and hash straight out of the read buffer */
+        if (Result->FirstMismatchOffset == UINT32_MAX)
+        {
+            Mismatch = FindMismatch(&Image[Result->BytesVerified], Block, BlockLength);
+            if (Mismatch < BlockLength)
+            {
+                Result->FirstMismatchOffset = Result->BytesVerified + Mismatch;
+            }
+        }
+
+        Result->FlashCrc32c = DLPC34XX_FLASH_Crc32c(Result->FlashCrc32c, Block, BlockLength);
+        Result->ImageCrc32c = DLPC34XX_FLASH_Crc32c(Result->ImageCrc32c, &Image[Result->BytesVerified], BlockLength);
+        Result->BytesVerified += BlockLength;
+    }
+
+    DLPC_COMMON_ReleaseBus();
+
+    if ((Status == 0) && (Result->FirstMismatchOffset != UINT32_MAX))
+    {
+        Status = ERR_FLASH_VERIFY_MISMATCH;
+    }
+
+    return Status;
+}
+
+/* Erases the selected flash data type and waits for the erase to complete */
+static uint32_t EraseFlash()
+{
+    DLPC34XX_ShortStatus_s ShortStatus;
+    uint32_t               Status = 0;
+    uint64_t               StartTime;
+
+    Status = DLPC34XX_WriteFlashErase();
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+
+    while (true)
+    {
+        Status = DLPC34XX_ReadShortStatus(&ShortStatus);
+        if ((Status != 0) || (ShortStatus.FlashEraseComplete != DLPC34XX_FE_NOT_COMPLETE))
+        {
+            return Status;
+        }
+
+        if ((DLPC_COMMON_GetTimeInMicroseconds() - StartTime) > (FLASH_ERASE_TIMEOUT_MS * 1000ULL))
+        {
+            return ERR_FLASH_ERASE_FAILED;
+        }
+
+        DLPC_COMMON_SleepMilliseconds(FLASH_ERASE_POLL_INTERVAL_MS);
+    }
+}
+
+static void ReportProgress(const DLPC34XX_FlashProgramOptions_s* Options,
+                           DLPC34XX_FlashProgramPhase_e          Phase,
+                           uint32_t                              BytesProgrammed,
+                           uint32_t                              ImageSize)
+{
+    if (Options->ProgressCallback != NULL)
+    {
+        Options->ProgressCallback(Phase, BytesProgrammed, ImageSize);
+    }
+}
+
+uint32_t DLPC34XX_FLASH_ProgramFlash(DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                                     const uint8_t*                        Image,
+                                     uint32_t                              ImageSize,
+                                     const DLPC34XX_FlashProgramOptions_s* Options,
+                                     DLPC34XX_FlashProgramResult_s*        Result)
+{
+    DLPC34XX_FlashProgramOptions_s DefaultOptions = { 0, true, false, false, 0, NULL };
+    DLPC34XX_FlashProgramResult_s  LocalResult;
+    DLPC_COMMON_BlockSizeTuner_s   Tuner;
+    uint32_t                       Status      = 0;
+    uint16_t                       BlockSize   = GetWriteBlockSize();
+    uint16_t                       BlockLength = 0;
+    uint16_t                       NewLength;
+    uint32_t                       Offset      = 0;
+    uint32_t                       MaxTransferSize;
+    uint64_t                       StartTime;
+
+    if (Options == NULL)
+    {
+        Options = &DefaultOptions;
+    }
+    if (Result == NULL)
+    {
+        Result = &LocalResult;
+    }
+
+    memset(Result, 0, sizeof(*Result));
+    Result->VerifyResult.FirstMismatchOffset = UINT32_MAX;
+
+    /* The transport limit includes the opcode byte */
+    MaxTransferSize = Options->MaxTransferSize;
+    if ((MaxTransferSize == 0) && (DLPC_COMMON_GetCommandTransport() != NULL))
+    {
+        MaxTransferSize = DLPC_COMMON_GetCommandTransport()->MaxTransferSize;
+    }
+    if ((MaxTransferSize > 1) && ((MaxTransferSize - 1) < BlockSize))
+    {
+        BlockSize = (uint16_t)(MaxTransferSize - 1);
+    }
+    if ((Options->BlockSize > 0) && (Options->BlockSize < BlockSize))
+    {
+        BlockSize = Options->BlockSize;
+    }
+
+    if ((Image == NULL) || (ImageSize == 0) || (BlockSize == 0))
+    {
+        return ERR_FLASH_INVALID_PARAMETER;
+    }
+
+    DLPC_COMMON_InitBlockSizeTuner(&Tuner, MIN_TUNED_BLOCK_SIZE, BlockSize, 1);
+
+    /* Hold the bus for the whole job, including the verification */
+    Status = DLPC_COMMON_AcquireBus();
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    /* Let the controller know which data block is going to be programmed */
+    Status = DLPC34XX_WriteFlashDataTypeSelect(FlashSelect);
+
+    if ((Status == 0) && Options->Erase)
+    {
+        ReportProgress(Options, DLPC34XX_FLASH_PHASE_ERASE, 0, ImageSize);
+        Status = EraseFlash();
+    }
+
+    ReportProgress(Options, DLPC34XX_FLASH_PHASE_PROGRAM, 0, ImageSize);
+    StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+
+    while ((Status == 0) && (Offset < ImageSize))
+    {
+        if (Options->AutoTuneBlockSize)
+        {
+            BlockSize = DLPC_COMMON_GetTunerBlockSize(&Tuner);
+        }
+
+        NewLength = (uint16_t)((ImageSize - Offset) < BlockSize ? (ImageSize - Offset) : BlockSize);
+
+        /* Resend the block size whenever it changes, e.g. for the final partial block */
+        if (NewLength != BlockLength)
+        {
+            Status = DLPC34XX_WriteFlashDataLength(NewLength);
+            if (Status != 0)
+            {
+                break;
+            }
+            BlockLength = NewLength;
+        }
+
+        if (Offset == 0)
+        {
+            Status = DLPC34XX_WriteFlashStart(BlockLength, (uint8_t*)&Image[Offset]);
+        }
+        else
+        {
+            Status = DLPC34XX_WriteFlashContinue(BlockLength, (uint8_t*)&Image[Offset]);
+        }
+
+        if (Status == 0)
+        {
+            Offset += BlockLength;
+            if (Options->AutoTuneBlockSize)
+            {
+                DLPC_COMMON_UpdateBlockSizeTuner(&Tuner, BlockLength);
+            }
+            ReportProgress(Options, DLPC34XX_FLASH_PHASE_PROGRAM, Offset, ImageSize);
+        }
+    }
+
+    Result->BlockSize = Options->AutoTuneBlockSize ? Tuner.BestBlockSize : BlockSize;
+    Result->BytesProgrammed           = Offset;
+    Result->ProgramTimeInMicroseconds = DLPC_COMMON_GetTimeInMicroseconds() - StartTime;
+    if (Result->ProgramTimeInMicroseconds > 0)
+    {
+        Result->BytesPerSecond = (Offset * 1000000.0) / Result->ProgramTimeInMicroseconds;
+    }
+
+    if ((Status == 0) && Options->Verify)
+    {
+        ReportProgress(Options, DLPC34XX_FLASH_PHASE_VERIFY, Offset, ImageSize);
+        Status = DLPC34XX_FLASH_VerifyFlash(FlashSelect, Image, ImageSize, &Result->VerifyResult);
+    }
+
+    DLPC_COMMON_ReleaseBus();
+    return Status;
+}
+
+uint32_t DLPC34XX_FLASH_ProgramFlashFromFile(const char*                           FilePath,
+                                             DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                                             const DLPC34XX_FlashProgramOptions_s* Options,
+                                             DLPC34XX_FlashProgramResult_s*        Result)
+{
+    DLPC_COMMON_MappedFile_s File;
+    uint32_t                 Status;
+
+    if (FilePath == NULL)
+    {
+        return ERR_FLASH_INVALID_PARAMETER;
+    }
+
+    Status = DLPC_COMMON_MapFile(FilePath, &File);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    Status = DLPC34XX_FLASH_ProgramFlash(FlashSelect, File.Data, File.Size, Options, Result);
+
+    DLPC_COMMON_UnmapFile(&File);
+
+    return Status;
+}
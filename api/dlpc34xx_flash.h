@@ -0,0 +1,253 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Helpers for reading back and verifying the flash of the 347x
+ *         controllers. The helpers are built on the Flash Data Type Select,
+ *         Flash Data Length and Read Flash Start/Continue commands.
+ */
+
+#ifndef DLPC34XX_FLASH_H
+#define DLPC34XX_FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc34xx.h"
+
+#define ERR_FLASH_INVALID_PARAMETER       200
+#define ERR_FLASH_VERIFY_MISMATCH         201
+#define ERR_FLASH_ERASE_FAILED            202
+
+/** Largest payload the controller accepts for one Flash Start/Continue command */
+#define DLPC34XX_FLASH_MAX_BLOCK_SIZE     1024
+
+typedef struct
+{
+    /** Number of bytes read back from the flash and compared */
+    uint32_t BytesVerified;
+
+    /** CRC32C of the data read back from the flash */
+    uint32_t FlashCrc32c;
+
+    /** CRC32C of the source image over the same range */
+    uint32_t ImageCrc32c;
+
+    /**
+     * Offset of the first byte that differs from the source image, relative
+     * to the start of the selected flash data type. UINT32_MAX if the flash
+     * content matches the image.
+     */
+    uint32_t FirstMismatchOffset;
+} DLPC34XX_FlashVerifyResult_s;
+
+typedef enum
+{
+    DLPC34XX_FLASH_PHASE_ERASE,
+    DLPC34XX_FLASH_PHASE_PROGRAM,
+    DLPC34XX_FLASH_PHASE_VERIFY
+} DLPC34XX_FlashProgramPhase_e;
+
+/**
+ * Reports the progress of DLPC34XX_FLASH_ProgramFlash. Called from the thread
+ * that programs the flash, at the start of each phase and after every block
+ * programmed.
+ *
+ * \param[in] Phase            The current phase
+ * \param[in] BytesProgrammed  Number of image bytes programmed so far
+ * \param[in] ImageSize        Number of bytes in the image
+ */
+typedef void (*DLPC34XX_FLASH_ProgressCallback)(DLPC34XX_FlashProgramPhase_e Phase,
+                                                uint32_t                     BytesProgrammed,
+                                                uint32_t                     ImageSize);
+
+typedef struct
+{
+    /**
+     * Number of bytes sent with each Flash Start/Continue command. 0 selects
+     * the largest block the command library write buffer can carry, up to
+     * DLPC34XX_FLASH_MAX_BLOCK_SIZE.
+     */
+    uint16_t BlockSize;
+
+    /** Erase the selected flash data type before programming */
+    bool     Erase;
+
+    /** Read the data back and verify it after programming */
+    bool     Verify;
+
+    /**
+     * Time the first blocks of the image with a range of block sizes and
+     * program the rest with the fastest one. BlockSize becomes the largest
+     * size tried.
+     */
+    bool     AutoTuneBlockSize;
+
+    /**
+     * Largest write transaction the transport can carry including the
+     * opcode byte, e.g. 64 for the DeVaSys adapter. 0 uses the limit of the
+     * command transport (DLPC_COMMON_GetCommandTransport), if there is one.
+     */
+    uint16_t MaxTransferSize;
+
+    /** Progress notification, may be NULL */
+    DLPC34XX_FLASH_ProgressCallback ProgressCallback;
+} DLPC34XX_FlashProgramOptions_s;
+
+typedef struct
+{
+    /** Number of bytes programmed */
+    uint32_t                     BytesProgrammed;
+
+    /** Time spent programming, excluding erase and verify */
+    uint64_t                     ProgramTimeInMicroseconds;
+
+    /** Programming throughput */
+    double                       BytesPerSecond;
+
+    /** Block size used for the bulk of the image */
+    uint16_t                     BlockSize;
+
+    /** Read back result, only valid if the Verify option was set */
+    DLPC34XX_FlashVerifyResult_s VerifyResult;
+} DLPC34XX_FlashProgramResult_s;
+
+/**
+ * Updates a running CRC32C (Castagnoli) value with the given data. Pass 0 as
+ * the Crc of the first block, then the previous return value for every
+ * following block.
+ *
+ * \param[in] Crc     The CRC of the preceding data, 0 for the first block
+ * \param[in] Data    The data bytes
+ * \param[in] Length  Number of bytes in Data
+ *
+ * \return The CRC32C of all data seen so far
+ */
+uint32_t DLPC34XX_FLASH_Crc32c(uint32_t Crc, const uint8_t* Data, uint32_t Length);
+
+/**
+ * Reads the selected flash data type back into a caller provided array. The
+ * data is requested in the largest blocks that fit the command library read
+ * buffer (up to DLPC34XX_FLASH_MAX_BLOCK_SIZE) and copied straight into Data.
+ *
+ * \param[in]  FlashSelect  The flash data type to read
+ * \param[in]  Length       Number of bytes to read
+ * \param[out] Data         Destination array of at least Length bytes
+ *
+ * \return 0 if successful, error code otherwise
+ */
+uint32_t DLPC34XX_FLASH_ReadFlash(DLPC34XX_FlashDataTypeSelect_e FlashSelect,
+                                  uint32_t                       Length,
+                                  uint8_t*                       Data);
+
+/**
+ * Reads the selected flash data type back and compares it against the image
+ * that was programmed. Each block is compared and hashed directly from the
+ * command library read buffer, so the data is never copied. The CRC32C of the
+ * flash and of the image are accumulated block by block as the read proceeds.
+ *
+ * \param[in]  FlashSelect  The flash data type to verify
+ * \param[in]  Image        The image that was programmed
+ * \param[in]  ImageSize    Number of bytes in Image
+ * \param[out] Result       The verification result. May be NULL.
+ *
+ * \return DLPC_SUCCESS               if the flash matches the image
+ *         ERR_FLASH_VERIFY_MISMATCH  if the flash differs from the image
+ *         ERR_FLASH_INVALID_PARAMETER if an argument is invalid
+ *         error code of the command callbacks otherwise
+ */
+uint32_t DLPC34XX_FLASH_VerifyFlash(DLPC34XX_FlashDataTypeSelect_e FlashSelect,
+                                    const uint8_t*                 Image,
+                                    uint32_t                       ImageSize,
+                                    DLPC34XX_FlashVerifyResult_s*  Result);
+
+/**
+ * Programs an image to the selected flash data type. The image is sent in
+ * blocks of Options->BlockSize bytes. Flash Data Length is resent whenever
+ * the block length changes, in particular for the final partial block, so
+ * the controller never receives bytes past the end of the image.
+ *
+ * With Options->AutoTuneBlockSize the block size that moves the most bytes
+ * per second is chosen while programming and returned in Result->BlockSize.
+ * Store it with DLPC_COMMON_SaveTunedValue and pass it back as
+ * Options->BlockSize to skip tuning on the next run.
+ *
+ * The job runs in one bus session (DLPC_COMMON_AcquireBus), so the bus is
+ * arbitrated once for the erase, the programming and the verification.
+ *
+ * \param[in]  FlashSelect  The flash data type to program
+ * \param[in]  Image        The image to program
+ * \param[in]  ImageSize    Number of bytes in Image
+ * \param[in]  Options      The programming options. NULL erases before
+ *                          programming, uses the largest block size and
+ *                          skips verification.
+ * \param[out] Result       Programming statistics. May be NULL.
+ *
+ * \return DLPC_SUCCESS                if successful
+ *         ERR_FLASH_ERASE_FAILED      if the erase did not complete in time
+ *         ERR_FLASH_VERIFY_MISMATCH   if the read back differs from the image
+ *         ERR_FLASH_INVALID_PARAMETER if an argument is invalid
+ *         error code of the command or bus callbacks otherwise
+ */
+uint32_t DLPC34XX_FLASH_ProgramFlash(DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                                     const uint8_t*                        Image,
+                                     uint32_t                              ImageSize,
+                                     const DLPC34XX_FlashProgramOptions_s* Options,
+                                     DLPC34XX_FlashProgramResult_s*        Result);
+
+/**
+ * Maps an image file into memory and programs it with
+ * DLPC34XX_FLASH_ProgramFlash. The file is never copied into an intermediate
+ * buffer; the pages of the mapping are handed to the flash write commands.
+ *
+ * \param[in]  FilePath     Path to the image file
+ * \param[in]  FlashSelect  The flash data type to program
+ * \param[in]  Options      The programming options, see DLPC34XX_FLASH_ProgramFlash
+ * \param[out] Result       Programming statistics. May be NULL.
+ *
+ * \return ERR_FILE_ACCESS if the file cannot be mapped,
+ *         otherwise the return value of DLPC34XX_FLASH_ProgramFlash
+ */
+uint32_t DLPC34XX_FLASH_ProgramFlashFromFile(const char*                           FilePath,
+                                             DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                                             const DLPC34XX_FlashProgramOptions_s* Options,
+                                             DLPC34XX_FlashProgramResult_s*        Result);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC34XX_FLASH_H */
@@ -0,0 +1,199 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements concurrent flash programming of several 347x
+ *         controllers.
+ */
+
+#include "dlpc34xx_fleet.h"
+#include "stddef.h"
+#include "string.h"
+
+#define WAIT_POLL_MILLISECONDS            10
+
+/* The device programmed by the calling thread, for the progress callback */
+static DLPC_COMMON_THREAD_LOCAL DLPC34XX_FleetDevice_s* s_Device;
+
+static void UpdateProgress(DLPC34XX_FlashProgramPhase_e Phase,
+                           uint32_t                     BytesProgrammed,
+                           uint32_t                     ImageSize)
+{
+    /* The image size is known from the fleet */
+    (void)ImageSize;
+
+    s_Device->Phase           = Phase;
+    s_Device->BytesProgrammed = BytesProgrammed;
+}
+
+static uint32_t ProgramDevice(void* Argument)
+{
+    DLPC34XX_FleetDevice_s* Device = (DLPC34XX_FleetDevice_s*)Argument;
+    DLPC34XX_Fleet_s*       Fleet  = Device->Fleet;
+
+    s_Device = Device;
+    DLPC_COMMON_SetCommandContext(Device->Context);
+
+    Device->Status = DLPC34XX_FLASH_ProgramFlash(Fleet->FlashSelect,
+                                                 Fleet->Image.Data,
+                                                 Fleet->Image.Size,
+                                                 &Fleet->Options,
+                                                 &Device->Result);
+
+    DLPC_COMMON_SetCommandContext(NULL);
+    Device->Done = true;
+
+    return Device->Status;
+}
+
+uint32_t DLPC34XX_FLEET_Start(DLPC34XX_Fleet_s*                     Fleet,
+                              const char*                           FilePath,
+                              DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                              const DLPC34XX_FlashProgramOptions_s* Options,
+                              DLPC34XX_FleetDevice_s*               Devices,
+                              uint32_t                              DeviceCount)
+{
+    DLPC34XX_FlashProgramOptions_s DefaultOptions = { 0, true, false, false, 0, NULL };
+    uint32_t                       Status;
+    uint32_t                       Index;
+
+    memset(Fleet, 0, sizeof(*Fleet));
+
+    if ((FilePath == NULL) || (Devices == NULL))
+    {
+        return ERR_FLASH_INVALID_PARAMETER;
+    }
+
+    Status = DLPC_COMMON_MapFile(FilePath, &Fleet->Image);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    Fleet->FlashSelect              = FlashSelect;
+    Fleet->Options                  = (Options != NULL) ? *Options : DefaultOptions;
+    Fleet->Options.ProgressCallback = UpdateProgress;
+    Fleet->Devices                  = Devices;
+    Fleet->DeviceCount              = DeviceCount;
+    Fleet->StartTime                = DLPC_COMMON_GetTimeInMicroseconds();
+
+    for (Index = 0; Index < DeviceCount; Index++)
+    {
+        DLPC34XX_FleetDevice_s* Device = &Devices[Index];
+
+        Device->Fleet           = Fleet;
+        Device->Phase           = DLPC34XX_FLASH_PHASE_ERASE;
+        Device->BytesProgrammed = 0;
+        Device->Done            = false;
+        Device->Status          = 0;
+        Device->ThreadStarted   = false;
+        memset(&Device->Result, 0, sizeof(Device->Result));
+    }
+
+    for (Index = 0; Index < DeviceCount; Index++)
+    {
+        DLPC34XX_FleetDevice_s* Device = &Devices[Index];
+
+        Status = DLPC_COMMON_CreateThread(ProgramDevice, Device, &Device->Thread);
+        if (Status != 0)
+        {
+            /* Mark the remaining devices as failed so Wait does not block on them */
+            for (; Index < DeviceCount; Index++)
+            {
+                Devices[Index].Status = Status;
+                Devices[Index].Done   = true;
+            }
+            return Status;
+        }
+
+        Device->ThreadStarted = true;
+    }
+
+    return 0;
+}
+
+bool DLPC34XX_FLEET_Wait(DLPC34XX_Fleet_s* Fleet, uint32_t TimeoutMilliseconds)
+{
+    uint64_t StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+    uint32_t Index;
+
+    while (true)
+    {
+        for (Index = 0; Index < Fleet->DeviceCount; Index++)
+        {
+            if (!Fleet->Devices[Index].Done)
+            {
+                break;
+            }
+        }
+
+        if (Index == Fleet->DeviceCount)
+        {
+            return true;
+        }
+
+        if ((DLPC_COMMON_GetTimeInMicroseconds() - StartTime) >= (uint64_t)TimeoutMilliseconds * 1000)
+        {
+            return false;
+        }
+
+        DLPC_COMMON_SleepMilliseconds(WAIT_POLL_MILLISECONDS);
+    }
+}
+
+uint32_t DLPC34XX_FLEET_Finish(DLPC34XX_Fleet_s* Fleet)
+{
+    uint32_t Status = 0;
+    uint32_t Index;
+
+    for (Index = 0; Index < Fleet->DeviceCount; Index++)
+    {
+        DLPC34XX_FleetDevice_s* Device = &Fleet->Devices[Index];
+
+        if (Device->ThreadStarted)
+        {
+            DLPC_COMMON_JoinThread(&Device->Thread);
+            Device->ThreadStarted = false;
+        }
+
+        if ((Status == 0) && (Device->Status != 0))
+        {
+            Status = Device->Status;
+        }
+    }
+
+    DLPC_COMMON_UnmapFile(&Fleet->Image);
+
+    return Status;
+}
@@ -0,0 +1,146 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Programs the flash of several 347x controllers concurrently. Each
+ *         controller is driven by its own thread through its own command
+ *         context, and all threads share one read-only mapping of the image.
+ */
+
+#ifndef DLPC34XX_FLEET_H
+#define DLPC34XX_FLEET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc_common.h"
+#include "dlpc_common_platform.h"
+#include "dlpc34xx_flash.h"
+
+struct DLPC34XX_Fleet;
+
+typedef struct
+{
+    /**
+     * Command context connected to the controller. The callbacks of the 
+     * context must only use the transport of this controller.
+     */
+    DLPC_COMMON_CommandContext_s* Context;
+
+    /** Label for progress reports, e.g. the adapter serial number */
+    const char*                   Name;
+
+    /** Progress, updated by the programming thread while it runs */
+    volatile uint32_t             Phase;
+    volatile uint32_t             BytesProgrammed;
+    volatile bool                 Done;
+
+    /** Programming status and statistics, valid after DLPC34XX_FLEET_Finish */
+    uint32_t                      Status;
+    DLPC34XX_FlashProgramResult_s Result;
+
+    /** Private, do not modify */
+    struct DLPC34XX_Fleet*        Fleet;
+    DLPC_COMMON_Thread_s          Thread;
+    bool                          ThreadStarted;
+} DLPC34XX_FleetDevice_s;
+
+typedef struct DLPC34XX_Fleet
+{
+    /** The image, mapped once and shared read-only by all threads */
+    DLPC_COMMON_MappedFile_s       Image;
+
+    DLPC34XX_FlashDataTypeSelect_e FlashSelect;
+    DLPC34XX_FlashProgramOptions_s Options;
+    DLPC34XX_FleetDevice_s*        Devices;
+    uint32_t                       DeviceCount;
+
+    /** Time DLPC34XX_FLEET_Start was called */
+    uint64_t                       StartTime;
+} DLPC34XX_Fleet_s;
+
+/**
+ * Maps the image file and starts one programming thread per device. Every
+ * thread selects the command context of its device and runs
+ * DLPC34XX_FLASH_ProgramFlash with the given options.
+ *
+ * \param[out]    Fleet        The fleet state
+ * \param[in]     FilePath     Path to the image file
+ * \param[in]     FlashSelect  The flash data type to program
+ * \param[in]     Options      The programming options for every device, NULL
+ *                             for the DLPC34XX_FLASH_ProgramFlash defaults.
+ *                             Options->ProgressCallback is ignored.
+ * \param[in,out] Devices      The devices to program
+ * \param[in]     DeviceCount  Number of entries in Devices
+ *
+ * \return 0 if all threads were started,
+ *         ERR_FILE_ACCESS if the image cannot be mapped,
+ *         ERR_THREAD_CREATE if a thread could not be started. The threads
+ *         already started keep running; call DLPC34XX_FLEET_Finish.
+ */
+uint32_t DLPC34XX_FLEET_Start(DLPC34XX_Fleet_s*                     Fleet,
+                              const char*                           FilePath,
+                              DLPC34XX_FlashDataTypeSelect_e        FlashSelect,
+                              const DLPC34XX_FlashProgramOptions_s* Options,
+                              DLPC34XX_FleetDevice_s*               Devices,
+                              uint32_t                              DeviceCount);
+
+/**
+ * Waits until every device is done or the timeout expires. Call it in a
+ * loop to refresh a progress display between waits.
+ *
+ * \param[in] Fleet                The fleet state
+ * \param[in] TimeoutMilliseconds  Maximum time to wait
+ *
+ * \return true if every device is done
+ */
+bool DLPC34XX_FLEET_Wait(DLPC34XX_Fleet_s* Fleet, uint32_t TimeoutMilliseconds);
+
+/**
+ * Waits for all programming threads and releases the image mapping
+ *
+ * \param[in] Fleet  The fleet state
+ *
+ * \return 0 if every device was programmed successfully,
+ *         the status of the first failed device otherwise
+ */
+uint32_t DLPC34XX_FLEET_Finish(DLPC34XX_Fleet_s* Fleet);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC34XX_FLEET_H */
@@ -0,0 +1,561 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the splash screen encoder and decoder of the 34xx
+ *         controllers.
+ */
+
+#include "dlpc34xx_splash.h"
+#include "string.h"
+
+#if defined(__SSE2__)
+#include "emmintrin.h"
+#endif
+
+#define BYTES_PER_PIXEL                   2
+#define MAX_RUN_LENGTH                    0x7FFF
+
+/* Escape byte of the RLE data and the codes following it */
+#define RLE_ESCAPE                        0x00
+#define RLE_END_OF_ROW                    0x00
+#define RLE_END_OF_IMAGE                  0x01
+
+typedef struct
+{
+    uint8_t* Data;                          /* NULL to only count the bytes */
+    uint32_t Size;
+    uint32_t Length;
+} Writer_s;
+
+typedef struct
+{
+    const uint8_t* Data;
+    uint32_t       Size;
+    uint32_t       Position;
+} Reader_s;
+
+static void PutBytes(Writer_s* Writer, const uint8_t* Bytes, uint32_t Length)
+{
+    if ((Writer->Data != NULL) && (Writer->Length + Length <= Writer->Size))
+    {
+        memcpy(&Writer->Data[Writer->Length], Bytes, Length);
+    }
+    Writer->Length += Length;
+}
+
+static void PutByte(Writer_s* Writer, uint8_t Byte)
+{
+    PutBytes(Writer, &Byte, 1);
+}
+
+static void PutCount(Writer_s* Writer, uint32_t Count)
+{
+    if (Count < 0x80)
+    {
+        PutByte(Writer, (uint8_t)Count);
+    }
+    else
+    {
+        PutByte(Writer, (uint8_t)((Count & 0x7F) | 0x80));
+        PutByte(Writer, (uint8_t)(Count >> 7));
+    }
+}
+
+static bool GetByte(Reader_s* Reader, uint8_t* Byte)
+{
+    if (Reader->Position >= Reader->Size)
+    {
+        return false;
+    }
+
+    *Byte = Reader->Data[Reader->Position++];
+    return true;
+}
+
+/* Reads the rest of a count whose first byte has been read */
+static bool GetCount(Reader_s* Reader, uint8_t First, uint32_t* Count)
+{
+    uint8_t High;
+
+    if ((First & 0x80) == 0)
+    {
+        *Count = First;
+        return true;
+    }
+
+    if (!GetByte(Reader, &High))
+    {
+        return false;
+    }
+
+    *Count = (First & 0x7F) | ((uint32_t)High << 7);
+    return true;
+}
+
+/* Counts the units equal to the first one, at least 1 */
+static uint32_t GetRunLength(const uint8_t* Units, uint32_t NumUnits, uint32_t UnitSize)
+{
+    uint32_t Count = 1;
+
+#if defined(__SSE2__)
+    uint32_t UnitsPerBlock = 16 / UnitSize;
+    uint32_t Value;
+    __m128i  Pattern;
+    uint32_t Mask;
+    uint32_t Byte;
+
+    memcpy(&Value, Units, UnitSize);
+    Pattern = (UnitSize == 2) ? _mm_set1_epi16((short)Value) : _mm_set1_epi32((int)Value);
+
+    /* Compare whole blocks against the first unit, up to the first differing byte */
+    for (Count = 0; Count + UnitsPerBlock <= NumUnits; Count += UnitsPerBlock)
+    {
+        Mask = (uint32_t)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&Units[Count * UnitSize]), Pattern));
+        if (Mask != 0xFFFF)
+        {
+            for (Byte = 0; (Mask >> Byte) & 1; Byte++)
+            {
+            }
+            return Count + Byte / UnitSize;
+        }
+    }
+    if (Count == 0)
+    {
+        Count = 1;
+    }
+#endif
+
+    while ((Count < NumUnits) && (memcmp(&Units[Count * UnitSize], Units, UnitSize) == 0))
+    {
+        Count++;
+    }
+
+    return Count;
+}
+
+/* Finds the first unit equal to the unit after it, NumUnits if there is none */
+static uint32_t FindRepeat(const uint8_t* Units, uint32_t NumUnits, uint32_t UnitSize)
+{
+    uint32_t Index = 0;
+
+#if defined(__SSE2__)
+    uint32_t UnitsPerBlock = 16 / UnitSize;
+    __m128i  Current;
+    __m128i  Next;
+    uint32_t Mask;
+    uint32_t Byte;
+
+    /* Compare a block of units with the block one unit further */
+    for (; Index + UnitsPerBlock < NumUnits; Index += UnitsPerBlock)
+    {
+        Current = _mm_loadu_si128((const __m128i*)&Units[Index * UnitSize]);
+        Next    = _mm_loadu_si128((const __m128i*)&Units[(Index + 1) * UnitSize]);
+
+        if (UnitSize == 2)
+        {
+            Mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(Current, Next)) & 0x5555;
+        }
+        else
+        {
+            Mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi32(Current, Next)) & 0x1111;
+        }
+
+        if (Mask != 0)
+        {
+            for (Byte = 0; ((Mask >> Byte) & 1) == 0; Byte++)
+            {
+            }
+            return Index + Byte / UnitSize;
+        }
+    }
+#endif
+
+    for (; Index + 1 < NumUnits; Index++)
+    {
+        if (memcmp(&Units[Index * UnitSize], &Units[(Index + 1) * UnitSize], UnitSize) == 0)
+        {
+            return Index;
+        }
+    }
+
+    return NumUnits;
+}
+
+static void EncodeRow(Writer_s* Writer, const uint8_t* Units, uint32_t NumUnits, uint32_t UnitSize)
+{
+    uint32_t Index = 0;
+    uint32_t Start;
+    uint32_t Run;
+
+    while (Index < NumUnits)
+    {
+        Run = GetRunLength(&Units[Index * UnitSize], NumUnits - Index, UnitSize);
+        if (Run > MAX_RUN_LENGTH)
+        {
+            Run = MAX_RUN_LENGTH;
+        }
+
+        if (Run >= 2)
+        {
+            PutCount(Writer, Run);
+            PutBytes(Writer, &Units[Index * UnitSize], UnitSize);
+            Index += Run;
+            continue;
+        }
+
+        /*
+         * Extend the literal up to a run of three units. A run of two costs
+         * more as a repeat than inside the literal.
+         */
+        Start = Index++;
+        while (Index < NumUnits)
+        {
+            Index += FindRepeat(&Units[Index * UnitSize], NumUnits - Index, UnitSize);
+            if ((Index >= NumUnits) ||
+                (GetRunLength(&Units[Index * UnitSize], NumUnits - Index, UnitSize) >= 3))
+            {
+                break;
+            }
+            Index += 2;
+        }
+        if (Index - Start > MAX_RUN_LENGTH)
+        {
+            Index = Start + MAX_RUN_LENGTH;
+        }
+
+        if (Index - Start == 1)
+        {
+            PutCount(Writer, 1);
+        }
+        else
+        {
+            PutByte(Writer, RLE_ESCAPE);
+            PutCount(Writer, Index - Start);
+        }
+        PutBytes(Writer, &Units[Start * UnitSize], (Index - Start) * UnitSize);
+    }
+
+    PutByte(Writer, RLE_ESCAPE);
+    PutByte(Writer, RLE_END_OF_ROW);
+}
+
+static uint8_t ClampToByte(int32_t Value)
+{
+    return (uint8_t)((Value < 0) ? 0 : ((Value > 255) ? 255 : Value));
+}
+
+void DLPC34XX_SPLASH_ConvertRow(const uint8_t* Rgb, uint16_t Width, DLPC34XX_PixelFormats_e PixelFormat, uint8_t* Pixels)
+{
+    const uint8_t* Pixel;
+    uint16_t       Rgb565;
+    int32_t        Cb;
+    int32_t        Cr;
+    uint32_t       Index;
+    uint32_t       Pair;
+
+    if (PixelFormat == DLPC34XX_PF_RGB565)
+    {
+        for (Index = 0; Index < Width; Index++)
+        {
+            Pixel  = &Rgb[3 * Index];
+            Rgb565 = (uint16_t)(((Pixel[0] & 0xF8) << 8) | ((Pixel[1] & 0xFC) << 3) | (Pixel[2] >> 3));
+            Pixels[2 * Index]     = (uint8_t)Rgb565;
+            Pixels[2 * Index + 1] = (uint8_t)(Rgb565 >> 8);
+        }
+        return;
+    }
+
+    /* BT.601 video levels; each pair of pixels shares the mean of their chroma */
+    for (Pair = 0; Pair + 1 < Width; Pair += 2)
+    {
+        Cb = 0;
+        Cr = 0;
+        for (Index = Pair; Index < Pair + 2; Index++)
+        {
+            Pixel = &Rgb[3 * Index];
+            Pixels[2 * Index] = ClampToByte(16 + ((66 * Pixel[0] + 129 * Pixel[1] + 25 * Pixel[2] + 128) >> 8));
+            Cb += -38 * Pixel[0] - 74 * Pixel[1] + 112 * Pixel[2];
+            Cr += 112 * Pixel[0] - 94 * Pixel[1] - 18 * Pixel[2];
+        }
+        Pixels[2 * Pair + 1] = ClampToByte(128 + ((Cb + 256) >> 9));
+        Pixels[2 * Pair + 3] = ClampToByte(128 + ((Cr + 256) >> 9));
+    }
+}
+
+static bool IsSupported(uint16_t Width, uint16_t Height, DLPC34XX_PixelFormats_e PixelFormat, DLPC34XX_CompressionTypes_e Compression)
+{
+    if ((Width == 0) || (Height == 0) || (Width > DLPC34XX_SPLASH_MAX_WIDTH))
+    {
+        return false;
+    }
+
+    switch (PixelFormat)
+    {
+        case DLPC34XX_PF_RGB565:
+            return (Compression == DLPC34XX_CT_UNCOMPRESSED) || (Compression == DLPC34XX_CT_RGB_RLE_COMPRESSED);
+        case DLPC34XX_PF_YCBCR422:
+            return ((Width % 2) == 0) &&
+                   ((Compression == DLPC34XX_CT_UNCOMPRESSED) || (Compression == DLPC34XX_CT_YUV_RLE_COMPRESSED));
+        default:
+            return false;
+    }
+}
+
+uint32_t DLPC34XX_SPLASH_GetMaxEncodedSize(uint16_t Width, uint16_t Height)
+{
+    /* A lone pixel takes a count byte; each row ends with two bytes */
+    return (uint32_t)Height * ((uint32_t)Width * (BYTES_PER_PIXEL + 1) + 2) + 2;
+}
+
+uint32_t DLPC34XX_SPLASH_EncodeImage(const uint8_t*                 Rgb,
+                                     uint16_t                       Width,
+                                     uint16_t                       Height,
+                                     uint32_t                       Stride,
+                                     DLPC34XX_PixelFormats_e        PixelFormat,
+                                     DLPC34XX_CompressionTypes_e    Compression,
+                                     uint8_t*                       Data,
+                                     uint32_t                       DataSize,
+                                     DLPC34XX_SplashScreenHeader_s* Header)
+{
+    uint8_t  Row[DLPC34XX_SPLASH_MAX_WIDTH * BYTES_PER_PIXEL];
+    uint32_t UnitSize = (PixelFormat == DLPC34XX_PF_YCBCR422) ? 2 * BYTES_PER_PIXEL : BYTES_PER_PIXEL;
+    Writer_s Writer;
+    uint32_t Index;
+
+    if (!IsSupported(Width, Height, PixelFormat, Compression) || (Stride < (uint32_t)Width * 3))
+    {
+        return ERR_SPLASH_RLE_INVALID_PARAMETER;
+    }
+
+    Writer.Data   = Data;
+    Writer.Size   = DataSize;
+    Writer.Length = 0;
+
+    for (Index = 0; Index < Height; Index++)
+    {
+        DLPC34XX_SPLASH_ConvertRow(&Rgb[Index * Stride], Width, PixelFormat, Row);
+
+        if (Compression == DLPC34XX_CT_UNCOMPRESSED)
+        {
+            PutBytes(&Writer, Row, Width * BYTES_PER_PIXEL);
+        }
+        else
+        {
+            EncodeRow(&Writer, Row, Width * BYTES_PER_PIXEL / UnitSize, UnitSize);
+        }
+    }
+
+    if (Compression != DLPC34XX_CT_UNCOMPRESSED)
+    {
+        PutByte(&Writer, RLE_ESCAPE);
+        PutByte(&Writer, RLE_END_OF_IMAGE);
+    }
+
+    Header->WidthInPixels   = Width;
+    Header->HeightInPixels  = Height;
+    Header->SizeInBytes     = Writer.Length;
+    Header->PixelFormat     = PixelFormat;
+    Header->CompressionType = Compression;
+    Header->ColorOrder      = DLPC34XX_CO_RGB;
+    Header->ChromaOrder     = DLPC34XX_CO_CB_FIRST;
+    Header->ByteOrder       = DLPC34XX_BO_LITTLE_ENDIAN;
+
+    if ((Data != NULL) && (Writer.Length > DataSize))
+    {
+        return ERR_SPLASH_RLE_BUFFER_TOO_SMALL;
+    }
+
+    return SUCCESS;
+}
+
+uint32_t DLPC34XX_SPLASH_EncodeSmallest(const uint8_t*                 Rgb,
+                                        uint16_t                       Width,
+                                        uint16_t                       Height,
+                                        uint32_t                       Stride,
+                                        uint8_t*                       Data,
+                                        uint32_t                       DataSize,
+                                        DLPC34XX_SplashScreenHeader_s* Header)
+{
+    /* In order of preference; uncompressed YCbCr is never smaller than RGB */
+    static const struct
+    {
+        DLPC34XX_PixelFormats_e     PixelFormat;
+        DLPC34XX_CompressionTypes_e Compression;
+    } s_Candidates[] =
+    {
+        { DLPC34XX_PF_RGB565,   DLPC34XX_CT_UNCOMPRESSED       },
+        { DLPC34XX_PF_RGB565,   DLPC34XX_CT_RGB_RLE_COMPRESSED },
+        { DLPC34XX_PF_YCBCR422, DLPC34XX_CT_YUV_RLE_COMPRESSED },
+    };
+
+    DLPC34XX_SplashScreenHeader_s Candidate;
+    uint32_t                      Best = 0;
+    uint32_t                      BestSize = UINT32_MAX;
+    uint32_t                      Index;
+
+    for (Index = 0; Index < sizeof(s_Candidates) / sizeof(s_Candidates[0]); Index++)
+    {
+        if (!IsSupported(Width, Height, s_Candidates[Index].PixelFormat, s_Candidates[Index].Compression))
+        {
+            continue;
+        }
+
+        if (s_Candidates[Index].Compression == DLPC34XX_CT_UNCOMPRESSED)
+        {
+            Candidate.SizeInBytes = (uint32_t)Width * Height * BYTES_PER_PIXEL;
+        }
+        else if (DLPC34XX_SPLASH_EncodeImage(Rgb, Width, Height, Stride, s_Candidates[Index].PixelFormat,
+                                             s_Candidates[Index].Compression, NULL, 0, &Candidate) != SUCCESS)
+        {
+            continue;
+        }
+
+        if (Candidate.SizeInBytes < BestSize)
+        {
+            Best     = Index;
+            BestSize = Candidate.SizeInBytes;
+        }
+    }
+
+    if (BestSize == UINT32_MAX)
+    {
+        return ERR_SPLASH_RLE_INVALID_PARAMETER;
+    }
+
+    return DLPC34XX_SPLASH_EncodeImage(Rgb, Width, Height, Stride, s_Candidates[Best].PixelFormat,
+                                       s_Candidates[Best].Compression, Data, DataSize, Header);
+}
+
+uint32_t DLPC34XX_SPLASH_DecodeImage(const DLPC34XX_SplashScreenHeader_s* Header,
+                                     const uint8_t*                       Data,
+                                     uint8_t*                             Pixels,
+                                     uint32_t                             PixelsSize)
+{
+    uint32_t RowSize  = (uint32_t)Header->WidthInPixels * BYTES_PER_PIXEL;
+    uint32_t UnitSize = (Header->PixelFormat == DLPC34XX_PF_YCBCR422) ? 2 * BYTES_PER_PIXEL : BYTES_PER_PIXEL;
+    Reader_s Reader;
+    uint8_t* Row;
+    uint32_t RowIndex;
+    uint32_t Position;
+    uint32_t Count;
+    uint8_t  Byte;
+
+    if (!IsSupported(Header->WidthInPixels, Header->HeightInPixels, Header->PixelFormat, Header->CompressionType))
+    {
+        return ERR_SPLASH_RLE_INVALID_PARAMETER;
+    }
+
+    if (RowSize * Header->HeightInPixels > PixelsSize)
+    {
+        return ERR_SPLASH_RLE_BUFFER_TOO_SMALL;
+    }
+
+    if (Header->CompressionType == DLPC34XX_CT_UNCOMPRESSED)
+    {
+        if (Header->SizeInBytes < RowSize * Header->HeightInPixels)
+        {
+            return ERR_SPLASH_RLE_CORRUPT_DATA;
+        }
+        memcpy(Pixels, Data, RowSize * Header->HeightInPixels);
+        return SUCCESS;
+    }
+
+    Reader.Data     = Data;
+    Reader.Size     = Header->SizeInBytes;
+    Reader.Position = 0;
+
+    for (RowIndex = 0; RowIndex < Header->HeightInPixels; RowIndex++)
+    {
+        Row      = &Pixels[RowIndex * RowSize];
+        Position = 0;
+
+        while (true)
+        {
+            if (!GetByte(&Reader, &Byte))
+            {
+                return ERR_SPLASH_RLE_CORRUPT_DATA;
+            }
+
+            if (Byte != RLE_ESCAPE)
+            {
+                /* Repeat run */
+                if (!GetCount(&Reader, Byte, &Count) || (Position + Count * UnitSize > RowSize) ||
+                    (Reader.Position + UnitSize > Reader.Size))
+                {
+                    return ERR_SPLASH_RLE_CORRUPT_DATA;
+                }
+                for (; Count > 0; Count--, Position += UnitSize)
+                {
+                    memcpy(&Row[Position], &Data[Reader.Position], UnitSize);
+                }
+                Reader.Position += UnitSize;
+                continue;
+            }
+
+            if (!GetByte(&Reader, &Byte) || (Byte == RLE_END_OF_IMAGE))
+            {
+                return ERR_SPLASH_RLE_CORRUPT_DATA;
+            }
+
+            if (Byte == RLE_END_OF_ROW)
+            {
+                if (Position != RowSize)
+                {
+                    return ERR_SPLASH_RLE_CORRUPT_DATA;
+                }
+                break;
+            }
+
+            /* Literal run */
+            if (!GetCount(&Reader, Byte, &Count) || (Position + Count * UnitSize > RowSize) ||
+                (Reader.Position + Count * UnitSize > Reader.Size))
+            {
+                return ERR_SPLASH_RLE_CORRUPT_DATA;
+            }
+            memcpy(&Row[Position], &Data[Reader.Position], Count * UnitSize);
+            Reader.Position += Count * UnitSize;
+            Position        += Count * UnitSize;
+        }
+    }
+
+    if (!GetByte(&Reader, &Byte) || (Byte != RLE_ESCAPE) ||
+        !GetByte(&Reader, &Byte) || (Byte != RLE_END_OF_IMAGE))
+    {
+        return ERR_SPLASH_RLE_CORRUPT_DATA;
+    }
+
+    return SUCCESS;
+}
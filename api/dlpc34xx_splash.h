@@ -0,0 +1,148 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Encodes and decodes splash screen images of the 34xx controllers,
+ *         uncompressed or run-length encoded, in the RGB 5-6-5 and
+ *         YCbCr 4:2:2 pixel formats.
+ *
+ * Encoded data is a sequence of rows, each ending with the bytes 0x00 0x00;
+ * the image ends with 0x00 0x01. A row is made of
+ *  - repeat runs: a count, then the unit repeated count times
+ *  - literal runs: 0x00, a count of at least 2, then count units
+ * Counts below 128 take one byte. Larger counts take two: the low 7 bits
+ * with bit 7 set, then the remaining bits. A unit is a pixel for RGB RLE
+ * and a pair of pixels, which share their chroma, for YUV RLE.
+ */
+
+#ifndef DLPC34XX_SPLASH_H
+#define DLPC34XX_SPLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc34xx.h"
+
+#define ERR_SPLASH_RLE_INVALID_PARAMETER  230
+#define ERR_SPLASH_RLE_BUFFER_TOO_SMALL   231
+#define ERR_SPLASH_RLE_CORRUPT_DATA       232
+
+/** Widest image the encoder accepts */
+#define DLPC34XX_SPLASH_MAX_WIDTH         2048
+
+/**
+ * Gets the buffer size that holds any encoding of an image
+ *
+ * \param[in] Width   Width of the image in pixels
+ * \param[in] Height  Height of the image in pixels
+ *
+ * \return The size in bytes
+ */
+uint32_t DLPC34XX_SPLASH_GetMaxEncodedSize(uint16_t Width, uint16_t Height);
+
+/**
+ * Converts an RGB image and encodes it as a splash screen
+ *
+ * \param[in]  Rgb          The image, 3 bytes per pixel, R first, row by row
+ * \param[in]  Width        Width of the image in pixels, even for YCbCr 4:2:2
+ * \param[in]  Height       Height of the image in pixels
+ * \param[in]  Stride       Bytes between the starts of two rows
+ * \param[in]  PixelFormat  Pixel format of the splash screen
+ * \param[in]  Compression  DLPC34XX_CT_UNCOMPRESSED, or the RLE compression
+ *                          matching the pixel format
+ * \param[out] Data         The encoded image, NULL to only compute its size
+ * \param[in]  DataSize     Size of Data in bytes
+ * \param[out] Header       Header of the encoded image; SizeInBytes is the
+ *                          size of the encoded data
+ *
+ * \return 0 if successful, ERR_SPLASH_RLE_INVALID_PARAMETER if the image or
+ *         the format is not supported, ERR_SPLASH_RLE_BUFFER_TOO_SMALL if the
+ *         encoded image does not fit Data
+ */
+uint32_t DLPC34XX_SPLASH_EncodeImage(const uint8_t*                 Rgb,
+                                     uint16_t                       Width,
+                                     uint16_t                       Height,
+                                     uint32_t                       Stride,
+                                     DLPC34XX_PixelFormats_e        PixelFormat,
+                                     DLPC34XX_CompressionTypes_e    Compression,
+                                     uint8_t*                       Data,
+                                     uint32_t                       DataSize,
+                                     DLPC34XX_SplashScreenHeader_s* Header);
+
+/**
+ * Encodes an image in whichever pixel format and compression gives the
+ * smallest data. Ties go to RGB 5-6-5, which keeps the full chroma.
+ *
+ * Parameters and return value as DLPC34XX_SPLASH_EncodeImage; the chosen
+ * format is returned in the header.
+ */
+uint32_t DLPC34XX_SPLASH_EncodeSmallest(const uint8_t*                 Rgb,
+                                        uint16_t                       Width,
+                                        uint16_t                       Height,
+                                        uint32_t                       Stride,
+                                        uint8_t*                       Data,
+                                        uint32_t                       DataSize,
+                                        DLPC34XX_SplashScreenHeader_s* Header);
+
+/**
+ * Decodes a splash screen to its pixel format, 2 bytes per pixel
+ *
+ * \param[in]  Header      Header of the image
+ * \param[in]  Data        The encoded image, Header->SizeInBytes long
+ * \param[out] Pixels      The pixels, row by row
+ * \param[in]  PixelsSize  Size of Pixels in bytes
+ *
+ * \return 0 if successful, ERR_SPLASH_RLE_INVALID_PARAMETER if the format is
+ *         not supported, ERR_SPLASH_RLE_BUFFER_TOO_SMALL if the pixels do not
+ *         fit, ERR_SPLASH_RLE_CORRUPT_DATA if the data is malformed
+ */
+uint32_t DLPC34XX_SPLASH_DecodeImage(const DLPC34XX_SplashScreenHeader_s* Header,
+                                     const uint8_t*                       Data,
+                                     uint8_t*                             Pixels,
+                                     uint32_t                             PixelsSize);
+
+/**
+ * Converts a row of RGB pixels to a splash pixel format, 2 bytes per pixel.
+ * YCbCr 4:2:2 uses BT.601 video levels with Cb first and needs an even
+ * number of pixels.
+ */
+void DLPC34XX_SPLASH_ConvertRow(const uint8_t* Rgb, uint16_t Width, DLPC34XX_PixelFormats_e PixelFormat, uint8_t* Pixels);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC34XX_SPLASH_H */
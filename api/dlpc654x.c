@@ -44,9 +44,10 @@
 #include "stdlib.h"
 #include "string.h"
 #include "dlpc654x.h"
+#include "dlpc_common_platform.h"
 #include "dlpc_common_private.h"
 
-static uint32_t s_Index;
+static DLPC_COMMON_THREAD_LOCAL uint32_t s_Index;
  
 uint32_t DLPC654X_ReadMode(DLPC654X_CmdModeT_e *AppMode, DLPC654X_CmdControllerConfigT_e *ControllerConfig)
 {
@@ -1291,10 +1292,7 @@ uint32_t DLPC654X_ReadDbHistogram(uint8_t *HistPtr)
     Status = DLPC_COMMON_SendRead(136);
     if (Status == 0)
     {
-        for (s_Index = 0; s_Index < 136; s_Index++)
-        {
-            HistPtr[s_Index] = *(DLPC_COMMON_UnpackBytes(1));
-        }
+        memcpy(HistPtr, DLPC_COMMON_UnpackBytes(136), 136);
     }
     return Status;
 }
@@ -2540,6 +2538,11 @@ uint32_t DLPC654X_WriteManualWarpTable(uint16_t WarpTableIndex, uint16_t WarpPoi
 
     DLPC_COMMON_PackOpcode(1, 0x34);
     DLPC_COMMON_PackBytes((uint8_t*)&WarpTableIndex, 2);
+    if (WarpPointsLength > DLPC_COMMON_GetWriteBufferSize() - 3)
+    {
+        return ERR_COMMAND_BUFFER_OVERFLOW;
+    }
+    DLPC_COMMON_PackBytes((uint8_t*)WarpPoints, WarpPointsLength);
 
     DLPC_COMMON_SetCommandDestination(4);
     Status = DLPC_COMMON_SendWrite();
@@ -3691,7 +3691,7 @@ uint32_t DLPC654X_ReadFpdConfiguration(DLPC654X_FpdConfiguration_s *FpdConfigura
  * \param[in]  WarpPointsLength  Byte Length for WarpPoints
  * \param[in]  WarpPoints  Warp map points in X, Y pairs where X, Y are are in 13.3 fixed point format
  *
- * \return 0 if successful, error code otherwise
+ * \return 0 if successful, ERR_COMMAND_BUFFER_OVERFLOW if the points do not fit the write buffer, error code otherwise
  */
 uint32_t DLPC654X_WriteManualWarpTable(uint16_t WarpTableIndex, uint16_t WarpPointsLength, uint16_t WarpPoints[]);
 
@@ -3700,7 +3700,9 @@ uint32_t DLPC654X_WriteManualWarpTable(uint16_t WarpTableIndex, uint16_t WarpPoi
  *
  * \param[in]  WarpTableIndex  Start index in the table from which the data is to be read
  * \param[in]  NumEntries  Number of entries to be read
- * \param[out]  WarpPoints  Warp map points in X, Y pairs where X, Y are in 13.3 fixed point format
+ * \param[out]  WarpPoints  Warp map points in X, Y pairs where X, Y are in 13.3 fixed point format.
+ *                          The pointers point into the read buffer and are only valid until the next command,
+ *                          DLPC654X_WARP_ReadTable copies the points to a caller array.
  *
  * \return 0 if successful, error code otherwise
  */
@@ -0,0 +1,342 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the DynamicBlack histogram sampler of the 654x
+ *         controllers.
+ *
+ * The ring has a single producer, the sampler, and any number of
+ * consumers. Each slot carries the number of the sample it holds, cleared
+ * while the sampler rewrites it; a consumer copies the slot and accepts the
+ * copy only if the number was the same before and after.
+ */
+
+#include "dlpc654x_histogram.h"
+#include "string.h"
+
+#define DEFAULT_CHANGE_THRESHOLD          0.25f
+#define DEFAULT_SMOOTHING                 0.1f
+
+/* Longest sleep, bounds the time DLPC654X_HISTOGRAM_StopSampler waits */
+#define MAX_SLEEP_MILLISECONDS            100
+
+/* Bins 0 to 31 cover the intensities 0 to 256 in steps of 8 */
+#define BIN_WIDTH                         8
+#define BIN_ZERO                          32
+#define BIN_FRACTION                      33
+
+static const uint8_t s_Percentiles[DLPC654X_HISTOGRAM_NUM_PERCENTILES] = DLPC654X_HISTOGRAM_PERCENTILES;
+
+/* The bins in order of intensity */
+static const uint8_t s_BinOrder[DLPC654X_HISTOGRAM_NUM_BINS] =
+{
+    BIN_ZERO, BIN_FRACTION, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+};
+
+static float GetBinCenter(uint32_t Bin)
+{
+    switch (Bin)
+    {
+        case BIN_ZERO:
+            return 0.0f;
+        case BIN_FRACTION:
+            return 0.5f;
+        default:
+            return (float)(Bin * BIN_WIDTH) + BIN_WIDTH / 2.0f;
+    }
+}
+
+static uint16_t GetBinUpperEdge(uint32_t Bin)
+{
+    switch (Bin)
+    {
+        case BIN_ZERO:
+            return 0;
+        case BIN_FRACTION:
+            return 1;
+        default:
+            return (uint16_t)((Bin + 1) * BIN_WIDTH);
+    }
+}
+
+static void ComputeStatistics(const DLPC654X_HistogramSampler_s* Sampler,
+                              bool                               HasPrevious,
+                              DLPC654X_HistogramSample_s*        Sample)
+{
+    const DLPC654X_HistogramSample_s* Previous  = &Sampler->Previous;
+    float                             Weighted  = 0.0f;
+    float                             Change    = 0.0f;
+    float                             Smoothing = Sampler->Config.Smoothing;
+    float                             Threshold = Sampler->Config.ChangeThreshold;
+    uint64_t                          Cumulative = 0;
+    uint32_t                          Percentile = 0;
+    uint32_t                          Index;
+    uint32_t                          Bin;
+
+    Sample->Total = 0;
+    for (Index = 0; Index < DLPC654X_HISTOGRAM_NUM_BINS; Index++)
+    {
+        Sample->Total += Sample->Bins[Index];
+        Weighted      += Sample->Bins[Index] * GetBinCenter(Index);
+    }
+
+    Sample->MeanIntensity = (Sample->Total > 0) ? Weighted / Sample->Total : 0.0f;
+
+    memset(Sample->Percentiles, 0, sizeof(Sample->Percentiles));
+    for (Index = 0; (Index < DLPC654X_HISTOGRAM_NUM_BINS) && (Sample->Total > 0); Index++)
+    {
+        Bin         = s_BinOrder[Index];
+        Cumulative += Sample->Bins[Bin];
+
+        while ((Percentile < DLPC654X_HISTOGRAM_NUM_PERCENTILES) &&
+               (Cumulative * 100 >= (uint64_t)s_Percentiles[Percentile] * Sample->Total))
+        {
+            Sample->Percentiles[Percentile++] = GetBinUpperEdge(Bin);
+        }
+    }
+
+    if (!HasPrevious)
+    {
+        Sample->SmoothedMeanIntensity = Sample->MeanIntensity;
+        Sample->Change                = 0.0f;
+        Sample->SceneChange           = false;
+        return;
+    }
+
+    Sample->SmoothedMeanIntensity = Previous->SmoothedMeanIntensity +
+                                    Smoothing * (Sample->MeanIntensity - Previous->SmoothedMeanIntensity);
+
+    if ((Sample->Total > 0) && (Previous->Total > 0))
+    {
+        for (Index = 0; Index < DLPC654X_HISTOGRAM_NUM_BINS; Index++)
+        {
+            float Difference = (float)Sample->Bins[Index] / Sample->Total -
+                               (float)Previous->Bins[Index] / Previous->Total;
+
+            Change += (Difference < 0.0f) ? -Difference : Difference;
+        }
+        Change /= 2.0f;
+    }
+    else if (Sample->Total != Previous->Total)
+    {
+        Change = 1.0f;
+    }
+
+    Sample->Change      = Change;
+    Sample->SceneChange = (Change > Threshold);
+}
+
+uint32_t DLPC654X_HISTOGRAM_InitSampler(DLPC654X_HistogramSampler_s* Sampler, const DLPC654X_HistogramSamplerConfig_s* Config)
+{
+    if (Config->PeriodMicroseconds == 0)
+    {
+        return ERR_HISTOGRAM_INVALID_PARAMETER;
+    }
+
+    memset(Sampler, 0, sizeof(*Sampler));
+    Sampler->Config = *Config;
+
+    if (Sampler->Config.ChangeThreshold <= 0.0f)
+    {
+        Sampler->Config.ChangeThreshold = DEFAULT_CHANGE_THRESHOLD;
+    }
+    if (Sampler->Config.Smoothing <= 0.0f)
+    {
+        Sampler->Config.Smoothing = DEFAULT_SMOOTHING;
+    }
+
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_HISTOGRAM_Sample(DLPC654X_HistogramSampler_s* Sampler)
+{
+    uint32_t                  Sequence = Sampler->NumSamples;
+    DLPC654X_HistogramSlot_s* Slot     = &Sampler->Ring[Sequence % DLPC654X_HISTOGRAM_RING_SIZE];
+    uint32_t                  Bins[DLPC654X_HISTOGRAM_NUM_BINS];
+    uint64_t                  Timestamp;
+    uint32_t                  Status;
+
+    Timestamp = DLPC_COMMON_GetTimeInMicroseconds();
+    Status    = DLPC654X_ReadDbHistogram((uint8_t*)Bins);
+    if (Status != SUCCESS)
+    {
+        DLPC_COMMON_AtomicStore(&Sampler->Errors, Sampler->Errors + 1);
+        DLPC_COMMON_AtomicStore(&Sampler->LastError, Status);
+        return Status;
+    }
+
+    /* Invalidate the slot before the consumers can see it change */
+    DLPC_COMMON_AtomicStore(&Slot->Sequence, 0);
+    DLPC_COMMON_MemoryFence();
+
+    Slot->Sample.Timestamp = Timestamp;
+    Slot->Sample.Sequence  = Sequence;
+    memcpy(Slot->Sample.Bins, Bins, sizeof(Bins));
+    ComputeStatistics(Sampler, Sequence > 0, &Slot->Sample);
+    Sampler->Previous = Slot->Sample;
+
+    DLPC_COMMON_AtomicStore(&Slot->Sequence, Sequence + 1);
+    DLPC_COMMON_AtomicStore(&Sampler->NumSamples, Sequence + 1);
+
+    return SUCCESS;
+}
+
+static uint32_t RunSampler(void* Argument)
+{
+    DLPC654X_HistogramSampler_s* Sampler  = (DLPC654X_HistogramSampler_s*)Argument;
+    uint32_t                     Period   = Sampler->Config.PeriodMicroseconds;
+    uint64_t                     Deadline = DLPC_COMMON_GetTimeInMicroseconds();
+    uint64_t                     Now;
+    uint64_t                     Missed;
+    uint64_t                     Sleep;
+
+    DLPC_COMMON_SetCommandContext(Sampler->Context);
+
+    while (!DLPC_COMMON_AtomicLoad(&Sampler->Stop))
+    {
+        DLPC654X_HISTOGRAM_Sample(Sampler);
+
+        /* Keep the schedule of the first read; skip the ticks already passed */
+        Deadline += Period;
+        Now       = DLPC_COMMON_GetTimeInMicroseconds();
+        if (Now >= Deadline + Period)
+        {
+            Missed    = (Now - Deadline) / Period;
+            Deadline += Missed * Period;
+            DLPC_COMMON_AtomicStore(&Sampler->SkippedTicks, Sampler->SkippedTicks + (uint32_t)Missed);
+        }
+
+        while ((Now < Deadline) && !DLPC_COMMON_AtomicLoad(&Sampler->Stop))
+        {
+            Sleep = (Deadline - Now + 999) / 1000;
+            DLPC_COMMON_SleepMilliseconds((uint32_t)((Sleep < MAX_SLEEP_MILLISECONDS) ? Sleep : MAX_SLEEP_MILLISECONDS));
+            Now = DLPC_COMMON_GetTimeInMicroseconds();
+        }
+    }
+
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_HISTOGRAM_StartSampler(DLPC654X_HistogramSampler_s*             Sampler,
+                                         const DLPC654X_HistogramSamplerConfig_s* Config,
+                                         DLPC_COMMON_CommandContext_s*            Context)
+{
+    uint32_t Status = DLPC654X_HISTOGRAM_InitSampler(Sampler, Config);
+
+    if (Status != SUCCESS)
+    {
+        return Status;
+    }
+
+    Sampler->Context = Context;
+
+    return DLPC_COMMON_CreateThread(RunSampler, Sampler, &Sampler->Thread);
+}
+
+void DLPC654X_HISTOGRAM_StopSampler(DLPC654X_HistogramSampler_s* Sampler)
+{
+    DLPC_COMMON_AtomicStore(&Sampler->Stop, 1);
+    DLPC_COMMON_JoinThread(&Sampler->Thread);
+}
+
+/* Copies a sample out of the ring, false if the slot no longer holds it */
+static bool ReadSlot(const DLPC654X_HistogramSampler_s* Sampler, uint32_t Sequence, DLPC654X_HistogramSample_s* Sample)
+{
+    const DLPC654X_HistogramSlot_s* Slot = &Sampler->Ring[Sequence % DLPC654X_HISTOGRAM_RING_SIZE];
+
+    if (DLPC_COMMON_AtomicLoad(&Slot->Sequence) != Sequence + 1)
+    {
+        return false;
+    }
+
+    memcpy(Sample, &Slot->Sample, sizeof(*Sample));
+    DLPC_COMMON_MemoryFence();
+
+    return DLPC_COMMON_AtomicLoad(&Slot->Sequence) == Sequence + 1;
+}
+
+void DLPC654X_HISTOGRAM_InitReader(const DLPC654X_HistogramSampler_s* Sampler, DLPC654X_HistogramReader_s* Reader)
+{
+    Reader->NextSequence = DLPC_COMMON_AtomicLoad(&Sampler->NumSamples);
+    Reader->Dropped      = 0;
+}
+
+bool DLPC654X_HISTOGRAM_ReadNext(const DLPC654X_HistogramSampler_s* Sampler,
+                                 DLPC654X_HistogramReader_s*        Reader,
+                                 DLPC654X_HistogramSample_s*        Sample)
+{
+    uint32_t NumSamples;
+
+    while (true)
+    {
+        NumSamples = DLPC_COMMON_AtomicLoad(&Sampler->NumSamples);
+        if (Reader->NextSequence == NumSamples)
+        {
+            return false;
+        }
+
+        if (NumSamples - Reader->NextSequence > DLPC654X_HISTOGRAM_RING_SIZE)
+        {
+            Reader->Dropped     += NumSamples - DLPC654X_HISTOGRAM_RING_SIZE - Reader->NextSequence;
+            Reader->NextSequence = NumSamples - DLPC654X_HISTOGRAM_RING_SIZE;
+        }
+
+        if (ReadSlot(Sampler, Reader->NextSequence, Sample))
+        {
+            Reader->NextSequence++;
+            return true;
+        }
+
+        /* Overwritten while it was copied */
+        Reader->Dropped++;
+        Reader->NextSequence++;
+    }
+}
+
+bool DLPC654X_HISTOGRAM_ReadLatest(const DLPC654X_HistogramSampler_s* Sampler, DLPC654X_HistogramSample_s* Sample)
+{
+    uint32_t NumSamples;
+
+    do
+    {
+        NumSamples = DLPC_COMMON_AtomicLoad(&Sampler->NumSamples);
+        if (NumSamples == 0)
+        {
+            return false;
+        }
+    } while (!ReadSlot(Sampler, NumSamples - 1, Sample));
+
+    return true;
+}
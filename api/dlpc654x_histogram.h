@@ -0,0 +1,226 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Samples the DynamicBlack histogram of the 654x controllers at a
+ *         fixed rate on a thread of its own. Samples are published with
+ *         their statistics in a ring that any number of threads read
+ *         without touching the bus.
+ */
+
+#ifndef DLPC654X_HISTOGRAM_H
+#define DLPC654X_HISTOGRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc_common.h"
+#include "dlpc_common_platform.h"
+#include "dlpc654x.h"
+
+#define ERR_HISTOGRAM_INVALID_PARAMETER   240
+
+/** Bins of the DB histogram; bins 32 and 33 hold zero and fractional pixels */
+#define DLPC654X_HISTOGRAM_NUM_BINS       34
+
+/** Samples kept in the ring, a power of two */
+#define DLPC654X_HISTOGRAM_RING_SIZE      64
+
+/** Percentiles computed for every sample */
+#define DLPC654X_HISTOGRAM_NUM_PERCENTILES 3
+#define DLPC654X_HISTOGRAM_PERCENTILES    { 10, 50, 90 }
+
+typedef struct
+{
+    /** Time of the read, see DLPC_COMMON_GetTimeInMicroseconds */
+    uint64_t Timestamp;
+
+    /** Number of the sample, counting from 0 */
+    uint32_t Sequence;
+
+    /** The histogram, in units of 32 pixels */
+    uint32_t Bins[DLPC654X_HISTOGRAM_NUM_BINS];
+    uint32_t Total;
+
+    /** Mean pixel intensity, 0 to 256, estimated from the bin centers */
+    float    MeanIntensity;
+
+    /** MeanIntensity smoothed over the previous samples */
+    float    SmoothedMeanIntensity;
+
+    /** Upper intensity edge of the bins holding DLPC654X_HISTOGRAM_PERCENTILES */
+    uint16_t Percentiles[DLPC654X_HISTOGRAM_NUM_PERCENTILES];
+
+    /**
+     * Difference to the previous sample, 0 to 1: half the summed absolute
+     * difference of the bin shares
+     */
+    float    Change;
+    bool     SceneChange;
+} DLPC654X_HistogramSample_s;
+
+typedef struct
+{
+    /** Time between two reads */
+    uint32_t PeriodMicroseconds;
+
+    /** Change above which a sample is flagged as a scene change, 0 for 0.25 */
+    float    ChangeThreshold;
+
+    /** Weight of a new sample in SmoothedMeanIntensity, 0 for 0.1 */
+    float    Smoothing;
+} DLPC654X_HistogramSamplerConfig_s;
+
+typedef struct
+{
+    /* Number of the sample held plus 1, 0 while it is being written */
+    volatile uint32_t          Sequence;
+    DLPC654X_HistogramSample_s Sample;
+} DLPC654X_HistogramSlot_s;
+
+typedef struct
+{
+    DLPC654X_HistogramSamplerConfig_s Config;
+    DLPC_COMMON_CommandContext_s*     Context;
+    DLPC_COMMON_Thread_s              Thread;
+    volatile uint32_t                 Stop;
+
+    /** Number of samples published */
+    volatile uint32_t                 NumSamples;
+
+    /** Failed reads and ticks skipped because the sampler fell behind */
+    volatile uint32_t                 Errors;
+    volatile uint32_t                 LastError;
+    volatile uint32_t                 SkippedTicks;
+
+    DLPC654X_HistogramSlot_s          Ring[DLPC654X_HISTOGRAM_RING_SIZE];
+
+    /* Sampler thread only */
+    DLPC654X_HistogramSample_s        Previous;
+} DLPC654X_HistogramSampler_s;
+
+/**
+ * Position of a consumer in the ring. Each consumer thread has its own.
+ */
+typedef struct
+{
+    uint32_t NextSequence;
+
+    /** Samples overwritten before the consumer read them */
+    uint32_t Dropped;
+} DLPC654X_HistogramReader_s;
+
+/**
+ * Initializes a sampler without starting it, e.g. to sample with
+ * DLPC654X_HISTOGRAM_Sample from a loop of the caller
+ *
+ * \param[out] Sampler  The sampler
+ * \param[in]  Config   Sampling rate and statistics
+ *
+ * \return 0 if successful, ERR_HISTOGRAM_INVALID_PARAMETER if the period is 0
+ */
+uint32_t DLPC654X_HISTOGRAM_InitSampler(DLPC654X_HistogramSampler_s* Sampler, const DLPC654X_HistogramSamplerConfig_s* Config);
+
+/**
+ * Initializes a sampler and starts its thread. The thread reads the
+ * histogram on Context, which must not be used by other threads; give it
+ * bus callbacks when its transport is shared with other contexts.
+ *
+ * \param[out] Sampler  The sampler
+ * \param[in]  Config   Sampling rate and statistics
+ * \param[in]  Context  Command context of the sampler thread
+ *
+ * \return 0 if successful, ERR_HISTOGRAM_INVALID_PARAMETER if the period is
+ *         0, ERR_THREAD_CREATE if the thread cannot be started
+ */
+uint32_t DLPC654X_HISTOGRAM_StartSampler(DLPC654X_HistogramSampler_s*             Sampler,
+                                         const DLPC654X_HistogramSamplerConfig_s* Config,
+                                         DLPC_COMMON_CommandContext_s*            Context);
+
+/**
+ * Stops the thread of a sampler and waits for it. The samples stay readable.
+ *
+ * \param[in,out] Sampler  The sampler
+ */
+void DLPC654X_HISTOGRAM_StopSampler(DLPC654X_HistogramSampler_s* Sampler);
+
+/**
+ * Reads the histogram once on the current command context and publishes the
+ * sample. Only one thread may sample at a time.
+ *
+ * \param[in,out] Sampler  The sampler
+ *
+ * \return 0 if successful, error code of the command otherwise
+ */
+uint32_t DLPC654X_HISTOGRAM_Sample(DLPC654X_HistogramSampler_s* Sampler);
+
+/**
+ * Starts a consumer at the next sample to be published
+ *
+ * \param[in]  Sampler  The sampler
+ * \param[out] Reader   The consumer position
+ */
+void DLPC654X_HISTOGRAM_InitReader(const DLPC654X_HistogramSampler_s* Sampler, DLPC654X_HistogramReader_s* Reader);
+
+/**
+ * Gets the oldest sample the consumer has not read yet. If the consumer fell
+ * more than the ring size behind, it skips to the oldest sample still held.
+ *
+ * \param[in]     Sampler  The sampler
+ * \param[in,out] Reader   The consumer position
+ * \param[out]    Sample   The sample
+ *
+ * \return true if a sample was read, false if there is no new sample
+ */
+bool DLPC654X_HISTOGRAM_ReadNext(const DLPC654X_HistogramSampler_s* Sampler,
+                                 DLPC654X_HistogramReader_s*        Reader,
+                                 DLPC654X_HistogramSample_s*        Sample);
+
+/**
+ * Gets the newest sample
+ *
+ * \param[in]  Sampler  The sampler
+ * \param[out] Sample   The sample
+ *
+ * \return true if a sample was read, false if there is none yet
+ */
+bool DLPC654X_HISTOGRAM_ReadLatest(const DLPC654X_HistogramSampler_s* Sampler, DLPC654X_HistogramSample_s* Sample);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC654X_HISTOGRAM_H */
@@ -0,0 +1,338 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the on the fly splash streamer of the 654x controllers.
+ */
+
+#include "dlpc_common_private.h"
+#include "dlpc_common_platform.h"
+#include "dlpc654x_splash.h"
+#include "string.h"
+
+#if defined(__SSSE3__)
+#include "tmmintrin.h"
+#elif defined(__SSE2__)
+#include "emmintrin.h"
+#elif defined(__ARM_NEON)
+#include "arm_neon.h"
+#endif
+
+static const uint8_t s_HeaderSignature[4] = { 'S', 'p', 'l', 'c' };
+
+static uint16_t Min(uint32_t A, uint32_t B)
+{
+    return (uint16_t)((A < B) ? A : B);
+}
+
+static uint32_t GetSourceBytesPerPixel(DLPC654X_SplashSourceFormat_e SourceFormat)
+{
+    return (SourceFormat == DLPC654X_SPLASH_SOURCE_RGBA8888) ? 4 : 3;
+}
+
+void DLPC654X_SPLASH_PackHeader(const DLPC654X_SplashHeader_s* Header, uint8_t* Packed)
+{
+    memset(Packed, 0, DLPC654X_SPLASH_HEADER_SIZE);
+
+    memcpy(&Packed[0], s_HeaderSignature, 4);
+    memcpy(&Packed[4], &Header->WidthInPixels, 2);
+    memcpy(&Packed[6], &Header->HeightInPixels, 2);
+    memcpy(&Packed[8], &Header->SizeInBytes, 4);
+    Packed[12] = Header->PixelFormat;
+    Packed[13] = Header->CompressionType;
+    Packed[14] = Header->ColorOrder;
+    Packed[15] = Header->ChromaOrder;
+    Packed[16] = Header->ByteOrder;
+}
+
+uint32_t DLPC654X_SPLASH_GetBytesPerPixel(DLPC654X_SplashPixelFormat_e PixelFormat)
+{
+    switch (PixelFormat)
+    {
+        case DLPC654X_SPLASH_PF_RGB888:
+            return 3;
+        case DLPC654X_SPLASH_PF_RGB565:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+/* Converts RGBA to packed RGB, returns the number of pixels converted */
+static uint32_t ConvertRgbaToRgb888(const uint8_t* Source, uint32_t NumPixels, uint8_t* Destination)
+{
+    uint32_t Index = 0;
+
+#if defined(__SSSE3__)
+    const __m128i Pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    for (; Index + 16 <= NumPixels; Index += 16)
+    {
+        __m128i Rgb0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&Source[4 * Index]), Pack);
+        __m128i Rgb1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&Source[4 * Index + 16]), Pack);
+        __m128i Rgb2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&Source[4 * Index + 32]), Pack);
+        __m128i Rgb3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&Source[4 * Index + 48]), Pack);
+
+        /* Four runs of 12 bytes into three vectors */
+        _mm_storeu_si128((__m128i*)&Destination[3 * Index],
+                         _mm_or_si128(Rgb0, _mm_slli_si128(Rgb1, 12)));
+        _mm_storeu_si128((__m128i*)&Destination[3 * Index + 16],
+                         _mm_or_si128(_mm_srli_si128(Rgb1, 4), _mm_slli_si128(Rgb2, 8)));
+        _mm_storeu_si128((__m128i*)&Destination[3 * Index + 32],
+                         _mm_or_si128(_mm_srli_si128(Rgb2, 8), _mm_slli_si128(Rgb3, 4)));
+    }
+#elif defined(__ARM_NEON)
+    for (; Index + 16 <= NumPixels; Index += 16)
+    {
+        uint8x16x4_t Rgba = vld4q_u8(&Source[4 * Index]);
+        uint8x16x3_t Rgb;
+
+        Rgb.val[0] = Rgba.val[0];
+        Rgb.val[1] = Rgba.val[1];
+        Rgb.val[2] = Rgba.val[2];
+        vst3q_u8(&Destination[3 * Index], Rgb);
+    }
+#else
+    (void)Source;
+    (void)NumPixels;
+    (void)Destination;
+#endif
+
+    return Index;
+}
+
+/* Converts RGBA to little endian RGB 5-6-5, returns the number of pixels converted */
+static uint32_t ConvertRgbaToRgb565(const uint8_t* Source, uint32_t NumPixels, uint8_t* Destination)
+{
+    uint32_t Index = 0;
+
+#if defined(__SSE2__)
+    const __m128i RedMask   = _mm_set1_epi32(0x000000F8);
+    const __m128i GreenMask = _mm_set1_epi32(0x0000FC00);
+    const __m128i BlueMask  = _mm_set1_epi32(0x00F80000);
+    const __m128i Bias32    = _mm_set1_epi32(0x8000);
+    const __m128i Bias16    = _mm_set1_epi16((short)0x8000);
+
+    for (; Index + 8 <= NumPixels; Index += 8)
+    {
+        __m128i Pixels0 = _mm_loadu_si128((const __m128i*)&Source[4 * Index]);
+        __m128i Pixels1 = _mm_loadu_si128((const __m128i*)&Source[4 * Index + 16]);
+        __m128i Rgb0    = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(Pixels0, RedMask), 8),
+                                                    _mm_srli_epi32(_mm_and_si128(Pixels0, GreenMask), 5)),
+                                       _mm_srli_epi32(_mm_and_si128(Pixels0, BlueMask), 19));
+        __m128i Rgb1    = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(Pixels1, RedMask), 8),
+                                                    _mm_srli_epi32(_mm_and_si128(Pixels1, GreenMask), 5)),
+                                       _mm_srli_epi32(_mm_and_si128(Pixels1, BlueMask), 19));
+
+        /* Narrow to 16 bits; the signed saturation of packs is avoided with a bias */
+        __m128i Rgb565  = _mm_packs_epi32(_mm_sub_epi32(Rgb0, Bias32), _mm_sub_epi32(Rgb1, Bias32));
+
+        _mm_storeu_si128((__m128i*)&Destination[2 * Index], _mm_add_epi16(Rgb565, Bias16));
+    }
+#elif defined(__ARM_NEON)
+    for (; Index + 8 <= NumPixels; Index += 8)
+    {
+        uint8x8x4_t Rgba   = vld4_u8(&Source[4 * Index]);
+        uint16x8_t  Rgb565 = vshll_n_u8(Rgba.val[0], 8);
+
+        Rgb565 = vsriq_n_u16(Rgb565, vshll_n_u8(Rgba.val[1], 8), 5);
+        Rgb565 = vsriq_n_u16(Rgb565, vshll_n_u8(Rgba.val[2], 8), 11);
+        vst1q_u8(&Destination[2 * Index], vreinterpretq_u8_u16(Rgb565));
+    }
+#else
+    (void)Source;
+    (void)NumPixels;
+    (void)Destination;
+#endif
+
+    return Index;
+}
+
+void DLPC654X_SPLASH_ConvertPixels(const uint8_t*                Source,
+                                   DLPC654X_SplashSourceFormat_e SourceFormat,
+                                   uint32_t                      NumPixels,
+                                   DLPC654X_SplashPixelFormat_e  PixelFormat,
+                                   uint8_t*                      Destination)
+{
+    uint32_t SourceBytes = GetSourceBytesPerPixel(SourceFormat);
+    uint32_t Index       = 0;
+    uint16_t Rgb565;
+
+    if (PixelFormat == DLPC654X_SPLASH_PF_RGB888)
+    {
+        if (SourceFormat == DLPC654X_SPLASH_SOURCE_RGB888)
+        {
+            memcpy(Destination, Source, NumPixels * 3);
+            return;
+        }
+
+        /* The vector kernel converts the bulk, the loop below the remainder */
+        for (Index = ConvertRgbaToRgb888(Source, NumPixels, Destination); Index < NumPixels; Index++)
+        {
+            Destination[3 * Index]     = Source[4 * Index];
+            Destination[3 * Index + 1] = Source[4 * Index + 1];
+            Destination[3 * Index + 2] = Source[4 * Index + 2];
+        }
+    }
+    else if (PixelFormat == DLPC654X_SPLASH_PF_RGB565)
+    {
+        if (SourceFormat == DLPC654X_SPLASH_SOURCE_RGBA8888)
+        {
+            Index = ConvertRgbaToRgb565(Source, NumPixels, Destination);
+        }
+
+        for (; Index < NumPixels; Index++)
+        {
+            const uint8_t* Pixel = &Source[SourceBytes * Index];
+
+            Rgb565 = (uint16_t)(((Pixel[0] & 0xF8) << 8) | ((Pixel[1] & 0xFC) << 3) | (Pixel[2] >> 3));
+            Destination[2 * Index]     = (uint8_t)Rgb565;
+            Destination[2 * Index + 1] = (uint8_t)(Rgb565 >> 8);
+        }
+    }
+}
+
+uint32_t DLPC654X_SPLASH_InitStreamer(DLPC654X_SplashStreamer_s* Streamer, DLPC654X_SplashPixelFormat_e PixelFormat)
+{
+    if (DLPC654X_SPLASH_GetBytesPerPixel(PixelFormat) == 0)
+    {
+        return ERR_SPLASH_INVALID_PARAMETER;
+    }
+
+    memset(Streamer, 0, sizeof(*Streamer));
+    Streamer->PixelFormat = PixelFormat;
+
+    return SUCCESS;
+}
+
+static uint16_t GetChunkSize(const DLPC654X_SplashStreamer_s* Streamer)
+{
+    uint16_t ChunkSize = Min(DLPC_COMMON_GetWriteBufferSize() - 1, DLPC654X_SPLASH_MAX_CHUNK_SIZE);
+
+    if (Streamer->ChunkSize > 0)
+    {
+        ChunkSize = Min(ChunkSize, Streamer->ChunkSize);
+    }
+
+    return ChunkSize;
+}
+
+uint32_t DLPC654X_SPLASH_StreamImage(DLPC654X_SplashStreamer_s*    Streamer,
+                                     const uint8_t*                Pixels,
+                                     DLPC654X_SplashSourceFormat_e SourceFormat,
+                                     uint16_t                      Width,
+                                     uint16_t                      Height,
+                                     uint32_t                      Stride)
+{
+    uint32_t                SourceBytes = GetSourceBytesPerPixel(SourceFormat);
+    uint32_t                PixelBytes  = DLPC654X_SPLASH_GetBytesPerPixel(Streamer->PixelFormat);
+    uint32_t                ChunkPixels = GetChunkSize(Streamer) / PixelBytes;
+    uint64_t                StartTime   = DLPC_COMMON_GetTimeInMicroseconds();
+    DLPC654X_SplashHeader_s Header;
+    uint8_t                 PackedHeader[DLPC654X_SPLASH_HEADER_SIZE];
+    uint32_t                Status;
+    uint32_t                NumPixels;
+    uint32_t                Count;
+    uint16_t                Row    = 0;
+    uint16_t                Column = 0;
+
+    if ((Width == 0) || (Height == 0) || (Stride < Width * SourceBytes) || (ChunkPixels == 0))
+    {
+        return ERR_SPLASH_INVALID_PARAMETER;
+    }
+
+    memset(&Header, 0, sizeof(Header));
+    Header.WidthInPixels   = Width;
+    Header.HeightInPixels  = Height;
+    Header.SizeInBytes     = (uint32_t)Width * Height * PixelBytes;
+    Header.PixelFormat     = (uint8_t)Streamer->PixelFormat;
+    Header.CompressionType = DLPC654X_SPLASH_CT_UNCOMPRESSED;
+    DLPC654X_SPLASH_PackHeader(&Header, PackedHeader);
+
+    Status = DLPC654X_WriteInitializeOnTheFlyLoadSplashImage(PackedHeader, Width, Height);
+    Streamer->Statistics.Commands++;
+
+    while ((Status == SUCCESS) && (Row < Height))
+    {
+        /* Fill the chunk, continuing across rows */
+        NumPixels = 0;
+        while ((NumPixels < ChunkPixels) && (Row < Height))
+        {
+            Count = Min(Width - Column, ChunkPixels - NumPixels);
+            DLPC654X_SPLASH_ConvertPixels(&Pixels[Row * Stride + Column * SourceBytes], SourceFormat, Count,
+                                          Streamer->PixelFormat, &Streamer->Chunk[NumPixels * PixelBytes]);
+            NumPixels += Count;
+            Column    += (uint16_t)Count;
+            if (Column == Width)
+            {
+                Column = 0;
+                Row++;
+            }
+        }
+
+        Streamer->Statistics.Commands++;
+        Streamer->Statistics.BytesSent += NumPixels * PixelBytes;
+
+        Status = DLPC654X_WriteLoadSplashImageOnTheFly((uint16_t)(NumPixels * PixelBytes), Streamer->Chunk);
+    }
+
+    if (Status == SUCCESS)
+    {
+        Streamer->Statistics.LastImageMicroseconds = (uint32_t)(DLPC_COMMON_GetTimeInMicroseconds() - StartTime);
+        Streamer->Statistics.Microseconds         += Streamer->Statistics.LastImageMicroseconds;
+        Streamer->Statistics.Images++;
+    }
+
+    return Status;
+}
+
+double DLPC654X_SPLASH_GetFramesPerSecond(const DLPC654X_SplashStreamer_s* Streamer)
+{
+    if (Streamer->Statistics.Microseconds == 0)
+    {
+        return 0.0;
+    }
+
+    return Streamer->Statistics.Images * 1e6 / (double)Streamer->Statistics.Microseconds;
+}
+
+double DLPC654X_SPLASH_GetMegabytesPerSecond(const DLPC654X_SplashStreamer_s* Streamer)
+{
+    if (Streamer->Statistics.Microseconds == 0)
+    {
+        return 0.0;
+    }
+
+    return (double)Streamer->Statistics.BytesSent / (double)Streamer->Statistics.Microseconds;
+}
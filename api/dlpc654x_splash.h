@@ -0,0 +1,200 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Streams images to the 654x controllers with the on the fly splash
+ *         load commands, converting them to the splash pixel format on the
+ *         way.
+ */
+
+#ifndef DLPC654X_SPLASH_H
+#define DLPC654X_SPLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc654x.h"
+
+#define ERR_SPLASH_INVALID_PARAMETER      220
+
+/** Size of the header passed to DLPC654X_WriteInitializeOnTheFlyLoadSplashImage */
+#define DLPC654X_SPLASH_HEADER_SIZE       20
+
+/** Most image bytes sent with one Load Splash Image On The Fly command */
+#define DLPC654X_SPLASH_MAX_CHUNK_SIZE    4096
+
+typedef enum
+{
+    DLPC654X_SPLASH_PF_RGB888 = 0x1,                                  /**< 24-bit RGB 8-8-8, packed */
+    DLPC654X_SPLASH_PF_RGB565 = 0x2,                                  /**< 16-bit RGB 5-6-5 */
+} DLPC654X_SplashPixelFormat_e;
+
+typedef enum
+{
+    DLPC654X_SPLASH_CT_UNCOMPRESSED = 0x0,                            /**< Uncompressed */
+} DLPC654X_SplashCompression_e;
+
+typedef enum
+{
+    DLPC654X_SPLASH_SOURCE_RGB888   = 0,                              /**< 3 bytes per pixel, R first */
+    DLPC654X_SPLASH_SOURCE_RGBA8888 = 1,                              /**< 4 bytes per pixel, R first, alpha ignored */
+} DLPC654X_SplashSourceFormat_e;
+
+/**
+ * Splash image header, the same fields as the splash screen header of the
+ * DLPC34xx controllers. ColorOrder, ChromaOrder and ByteOrder are 0 for
+ * RGB, Cr first and little endian.
+ */
+typedef struct
+{
+    uint16_t WidthInPixels;
+    uint16_t HeightInPixels;
+    uint32_t SizeInBytes;
+    uint8_t  PixelFormat;
+    uint8_t  CompressionType;
+    uint8_t  ColorOrder;
+    uint8_t  ChromaOrder;
+    uint8_t  ByteOrder;
+} DLPC654X_SplashHeader_s;
+
+typedef struct
+{
+    uint32_t Images;
+    uint32_t Commands;
+    uint64_t BytesSent;
+    uint64_t Microseconds;
+
+    /** Time taken by the last image, from initialization to the last chunk */
+    uint32_t LastImageMicroseconds;
+} DLPC654X_SplashStatistics_s;
+
+typedef struct
+{
+    DLPC654X_SplashPixelFormat_e PixelFormat;
+
+    /**
+     * Image bytes sent with each command. 0 selects the most the write
+     * buffer can carry, up to DLPC654X_SPLASH_MAX_CHUNK_SIZE.
+     */
+    uint16_t                     ChunkSize;
+
+    DLPC654X_SplashStatistics_s  Statistics;
+
+    /* The chunk being converted, see DLPC654X_SPLASH_StreamImage */
+    uint8_t                      Chunk[DLPC654X_SPLASH_MAX_CHUNK_SIZE];
+} DLPC654X_SplashStreamer_s;
+
+/**
+ * Packs a splash header into the layout of the on the fly load command:
+ * the "Splc" signature, the fields in order and three reserved bytes.
+ *
+ * \param[in]  Header  The header
+ * \param[out] Packed  DLPC654X_SPLASH_HEADER_SIZE bytes
+ */
+void DLPC654X_SPLASH_PackHeader(const DLPC654X_SplashHeader_s* Header, uint8_t* Packed);
+
+/**
+ * Gets the bytes per pixel of an uncompressed splash pixel format
+ *
+ * \return The bytes per pixel, 0 if the format is not supported
+ */
+uint32_t DLPC654X_SPLASH_GetBytesPerPixel(DLPC654X_SplashPixelFormat_e PixelFormat);
+
+/**
+ * Converts pixels to a splash pixel format. Uses SSE2/SSSE3 or NEON when the
+ * compiler targets them.
+ *
+ * \param[in]  Source        The pixels
+ * \param[in]  SourceFormat  Format of the pixels
+ * \param[in]  NumPixels     Number of pixels
+ * \param[in]  PixelFormat   Splash pixel format
+ * \param[out] Destination   NumPixels * DLPC654X_SPLASH_GetBytesPerPixel bytes
+ */
+void DLPC654X_SPLASH_ConvertPixels(const uint8_t*                Source,
+                                   DLPC654X_SplashSourceFormat_e SourceFormat,
+                                   uint32_t                      NumPixels,
+                                   DLPC654X_SplashPixelFormat_e  PixelFormat,
+                                   uint8_t*                      Destination);
+
+/**
+ * Initializes a streamer
+ *
+ * \param[out] Streamer     The streamer
+ * \param[in]  PixelFormat  Splash pixel format the images are sent in
+ *
+ * \return 0 if successful, ERR_SPLASH_INVALID_PARAMETER if the format is not
+ *         supported
+ */
+uint32_t DLPC654X_SPLASH_InitStreamer(DLPC654X_SplashStreamer_s* Streamer, DLPC654X_SplashPixelFormat_e PixelFormat);
+
+/**
+ * Loads an image on the fly. The image is converted chunk by chunk; each
+ * chunk is sent with one Load Splash Image On The Fly command. Streaming is
+ * synchronous: each chunk is sent, and its command completes, before the
+ * next one is converted.
+ *
+ * \param[in,out] Streamer      The streamer
+ * \param[in]     Pixels        The image, row by row
+ * \param[in]     SourceFormat  Format of the pixels
+ * \param[in]     Width         Width of the image in pixels
+ * \param[in]     Height        Height of the image in pixels
+ * \param[in]     Stride        Bytes between the starts of two rows
+ *
+ * \return 0 if successful, ERR_SPLASH_INVALID_PARAMETER if the image is
+ *         empty or the stride too small, error code of the commands otherwise
+ */
+uint32_t DLPC654X_SPLASH_StreamImage(DLPC654X_SplashStreamer_s*    Streamer,
+                                     const uint8_t*                Pixels,
+                                     DLPC654X_SplashSourceFormat_e SourceFormat,
+                                     uint16_t                      Width,
+                                     uint16_t                      Height,
+                                     uint32_t                      Stride);
+
+/**
+ * Gets the images per second streamed so far
+ */
+double DLPC654X_SPLASH_GetFramesPerSecond(const DLPC654X_SplashStreamer_s* Streamer);
+
+/**
+ * Gets the image data rate so far, in megabytes (10^6 bytes) per second
+ */
+double DLPC654X_SPLASH_GetMegabytesPerSecond(const DLPC654X_SplashStreamer_s* Streamer);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC654X_SPLASH_H */
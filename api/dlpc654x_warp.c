@@ -0,0 +1,243 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the manual warp table helpers of the 654x controllers.
+ */
+
+#include "dlpc_common_private.h"
+#include "dlpc654x.h"
+#include "dlpc654x_warp.h"
+#include "string.h"
+
+#define OPCODE_MANUAL_WARP_TABLE          0x34
+#define WARP_COMMAND_DESTINATION          4
+
+/* Opcode and table index */
+#define WARP_COMMAND_HEADER_LENGTH        3
+
+static uint16_t Min(uint32_t A, uint32_t B)
+{
+    return (uint16_t)((A < B) ? A : B);
+}
+
+static bool IsValidRange(uint16_t StartIndex, uint16_t NumEntries)
+{
+    return (uint32_t)StartIndex + NumEntries <= DLPC654X_WARP_MAX_TABLE_ENTRIES;
+}
+
+static uint16_t GetChunkEntries(uint16_t RequestedEntries)
+{
+    uint16_t ChunkEntries = Min((DLPC_COMMON_GetWriteBufferSize() - WARP_COMMAND_HEADER_LENGTH) / 2,
+                                DLPC654X_WARP_MAX_CHUNK_ENTRIES);
+
+    if (RequestedEntries > 0)
+    {
+        ChunkEntries = Min(ChunkEntries, RequestedEntries);
+    }
+
+    return ChunkEntries;
+}
+
+uint32_t DLPC654X_WARP_WriteTable(uint16_t StartIndex, uint16_t NumEntries, const uint16_t* Entries)
+{
+    uint16_t ChunkEntries = GetChunkEntries(0);
+    uint16_t Count;
+    uint16_t Offset;
+    uint32_t Status;
+
+    if (!IsValidRange(StartIndex, NumEntries) || (ChunkEntries == 0))
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    for (Offset = 0; Offset < NumEntries; Offset += Count)
+    {
+        Count  = Min(NumEntries - Offset, ChunkEntries);
+        Status = DLPC654X_WriteManualWarpTable(StartIndex + Offset, Count * 2, (uint16_t*)&Entries[Offset]);
+        if (Status != SUCCESS)
+        {
+            return Status;
+        }
+    }
+
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_WARP_ReadTable(uint16_t StartIndex, uint16_t NumEntries, uint16_t* Entries)
+{
+    uint16_t ChunkEntries = DLPC_COMMON_GetReadBufferSize() / 2;
+    uint16_t Index;
+    uint16_t Count;
+    uint16_t Offset;
+    uint32_t Status;
+
+    if (!IsValidRange(StartIndex, NumEntries) || (ChunkEntries == 0))
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    for (Offset = 0; Offset < NumEntries; Offset += Count)
+    {
+        Count = Min(NumEntries - Offset, ChunkEntries);
+        Index = StartIndex + Offset;
+
+        /* Same request as DLPC654X_ReadManualWarpTable, unpacked into the caller array */
+        DLPC_COMMON_ClearWriteBuffer();
+        DLPC_COMMON_ClearReadBuffer();
+
+        DLPC_COMMON_PackOpcode(1, OPCODE_MANUAL_WARP_TABLE);
+        DLPC_COMMON_PackBytes((uint8_t*)&Index, 2);
+        DLPC_COMMON_PackBytes((uint8_t*)&Count, 2);
+
+        DLPC_COMMON_SetCommandDestination(WARP_COMMAND_DESTINATION);
+
+        Status = DLPC_COMMON_SendRead(0xFFFF);
+        if (Status != SUCCESS)
+        {
+            return Status;
+        }
+
+        if (DLPC_COMMON_GetBytesRead() < Count * 2)
+        {
+            return ERR_WARP_SHORT_READ;
+        }
+
+        memcpy(&Entries[Offset], DLPC_COMMON_UnpackBytes(Count * 2), Count * 2);
+    }
+
+    return SUCCESS;
+}
+
+void DLPC654X_WARP_InitUploader(DLPC654X_WarpUploader_s* Uploader, uint16_t TableEntries)
+{
+    memset(Uploader, 0, sizeof(*Uploader));
+
+    Uploader->TableEntries = (TableEntries > 0) ? Min(TableEntries, DLPC654X_WARP_MAX_TABLE_ENTRIES)
+                                                : DLPC654X_WARP_MAX_TABLE_ENTRIES;
+}
+
+void DLPC654X_WARP_InvalidateUploader(DLPC654X_WarpUploader_s* Uploader)
+{
+    Uploader->ShadowValid = false;
+}
+
+static uint32_t SendRange(DLPC654X_WarpUploader_s* Uploader,
+                          uint16_t                 ChunkEntries,
+                          uint16_t                 Start,
+                          uint16_t                 End,
+                          const uint16_t*          Entries)
+{
+    uint16_t Count;
+    uint32_t Status;
+
+    for (; Start < End; Start += Count)
+    {
+        Count  = Min(End - Start, ChunkEntries);
+        Status = DLPC654X_WriteManualWarpTable(Start, Count * 2, (uint16_t*)&Entries[Start]);
+        if (Status != SUCCESS)
+        {
+            return Status;
+        }
+
+        Uploader->Statistics.Commands++;
+        Uploader->Statistics.EntriesSent += Count;
+    }
+
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_WARP_UpdateTable(DLPC654X_WarpUploader_s* Uploader, const uint16_t* Entries)
+{
+    uint16_t ChunkEntries = GetChunkEntries(Uploader->ChunkEntries);
+    uint16_t NumEntries   = Uploader->TableEntries;
+    uint32_t EntriesSent  = Uploader->Statistics.EntriesSent;
+    uint32_t Status       = SUCCESS;
+    uint16_t Start;
+    uint16_t End;
+    uint16_t Index;
+
+    if ((ChunkEntries == 0) || (NumEntries == 0))
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    if (!Uploader->ShadowValid)
+    {
+        Status = SendRange(Uploader, ChunkEntries, 0, NumEntries, Entries);
+    }
+    else
+    {
+        Start = 0;
+        while ((Status == SUCCESS) && (Start < NumEntries))
+        {
+            if (Entries[Start] == Uploader->Shadow[Start])
+            {
+                Start++;
+                continue;
+            }
+
+            /* Extend the range over short runs of unchanged entries */
+            End = Start + 1;
+            for (Index = End; Index < NumEntries; Index++)
+            {
+                if (Entries[Index] != Uploader->Shadow[Index])
+                {
+                    End = Index + 1;
+                }
+                else if (Index - End >= DLPC654X_WARP_MERGE_GAP_ENTRIES)
+                {
+                    break;
+                }
+            }
+
+            Status = SendRange(Uploader, ChunkEntries, Start, End, Entries);
+            Start  = End;
+        }
+    }
+
+    Uploader->Statistics.EntriesSkipped = NumEntries - (Uploader->Statistics.EntriesSent - EntriesSent);
+
+    if (Status != SUCCESS)
+    {
+        /* Part of the table may have been written, resend it all next time */
+        Uploader->ShadowValid = false;
+        return Status;
+    }
+
+    memcpy(Uploader->Shadow, Entries, NumEntries * sizeof(Entries[0]));
+    Uploader->ShadowValid = true;
+
+    return SUCCESS;
+}
@@ -0,0 +1,160 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Helpers for uploading and reading back the manual warp table of
+ *         the 654x controllers in chunks that fit the command buffers. The
+ *         helpers are built on the Write/Read Manual Warp Table commands.
+ *
+ * The table is addressed in entries of one 16-bit 13.3 fixed point
+ * coordinate, the unit of the NumEntries of DLPC654X_ReadManualWarpTable.
+ * A warp point is an X, Y pair of entries.
+ */
+
+#ifndef DLPC654X_WARP_H
+#define DLPC654X_WARP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc654x.h"
+
+#define ERR_WARP_INVALID_PARAMETER        210
+#define ERR_WARP_SHORT_READ               211
+
+/** Size of the manual warp table, 1952 X, Y points */
+#define DLPC654X_WARP_MAX_TABLE_ENTRIES   (1952 * 2)
+
+/** Most entries sent with one Write Manual Warp Table command */
+#define DLPC654X_WARP_MAX_CHUNK_ENTRIES   256
+
+/**
+ * Changed ranges closer than this are sent as one command; resending the
+ * unchanged entries in between is cheaper than another command header.
+ */
+#define DLPC654X_WARP_MERGE_GAP_ENTRIES   4
+
+typedef struct
+{
+    uint32_t Commands;
+    uint32_t EntriesSent;
+
+    /** Entries of the last update that were unchanged and not sent */
+    uint32_t EntriesSkipped;
+} DLPC654X_WarpStatistics_s;
+
+/**
+ * Uploads a warp table and keeps a copy of what the controller holds, so
+ * that later updates only send the entries that changed.
+ */
+typedef struct
+{
+    /** Number of table entries mirrored, 0 selects DLPC654X_WARP_MAX_TABLE_ENTRIES */
+    uint16_t                  TableEntries;
+
+    /**
+     * Entries sent with each command. 0 selects the most the write buffer
+     * can carry, up to DLPC654X_WARP_MAX_CHUNK_ENTRIES.
+     */
+    uint16_t                  ChunkEntries;
+
+    /** The table as last uploaded, valid after the first complete update */
+    uint16_t                  Shadow[DLPC654X_WARP_MAX_TABLE_ENTRIES];
+    bool                      ShadowValid;
+
+    DLPC654X_WarpStatistics_s Statistics;
+} DLPC654X_WarpUploader_s;
+
+/**
+ * Writes entries to the manual warp table, split into commands that fit the
+ * write buffer of the command library
+ *
+ * \param[in] StartIndex  Table index of the first entry
+ * \param[in] NumEntries  Number of entries to write
+ * \param[in] Entries     The entries
+ *
+ * \return 0 if successful, ERR_WARP_INVALID_PARAMETER if the range exceeds
+ *         the table, error code of the command otherwise
+ */
+uint32_t DLPC654X_WARP_WriteTable(uint16_t StartIndex, uint16_t NumEntries, const uint16_t* Entries);
+
+/**
+ * Reads entries of the manual warp table into a caller array, split into
+ * reads that fit the read buffer of the command library
+ *
+ * \param[in]  StartIndex  Table index of the first entry
+ * \param[in]  NumEntries  Number of entries to read
+ * \param[out] Entries     The entries, NumEntries long
+ *
+ * \return 0 if successful, ERR_WARP_INVALID_PARAMETER if the range exceeds
+ *         the table, ERR_WARP_SHORT_READ if the controller returned fewer
+ *         entries, error code of the command otherwise
+ */
+uint32_t DLPC654X_WARP_ReadTable(uint16_t StartIndex, uint16_t NumEntries, uint16_t* Entries);
+
+/**
+ * Initializes an uploader. The first update sends the whole table.
+ *
+ * \param[out] Uploader      The uploader
+ * \param[in]  TableEntries  Number of entries of the table, 0 for
+ *                           DLPC654X_WARP_MAX_TABLE_ENTRIES
+ */
+void DLPC654X_WARP_InitUploader(DLPC654X_WarpUploader_s* Uploader, uint16_t TableEntries);
+
+/**
+ * Uploads a table, sending only the ranges of entries that differ from the
+ * previous upload. Call DLPC654X_WARP_InvalidateUploader after anything
+ * else changed the table on the controller. The commands are sent one by
+ * one; each completes before the next is sent.
+ *
+ * \param[in,out] Uploader  The uploader
+ * \param[in]     Entries   The complete table, TableEntries long
+ *
+ * \return 0 if successful, error code of the commands otherwise. After an
+ *         error the next update sends the whole table again.
+ */
+uint32_t DLPC654X_WARP_UpdateTable(DLPC654X_WarpUploader_s* Uploader, const uint16_t* Entries);
+
+/**
+ * Makes the next update send the whole table
+ */
+void DLPC654X_WARP_InvalidateUploader(DLPC654X_WarpUploader_s* Uploader);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC654X_WARP_H */
@@ -0,0 +1,395 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the warp table generator of the 654x controllers.
+ *
+ * Control point meshes are interpolated separably: each table row first
+ * blends the control rows around it into one line, then each table column
+ * blends the points of that line. The taps and weights of the columns are
+ * computed once per call, so the inner loops are plain multiply-adds over
+ * contiguous arrays that the compiler vectorizes.
+ */
+
+#include "dlpc654x_warp_mesh.h"
+#include "string.h"
+
+enum
+{
+    SOURCE_CONTROL_POINTS = 1,
+    SOURCE_CORNERS        = 2,
+};
+
+/* Table entries hold 13.3 fixed point coordinates */
+#define FIXED_POINT_SCALE                 8.0f
+
+static uint32_t HashBytes(uint32_t Hash, const void* Data, uint32_t Length)
+{
+    const uint8_t* Bytes = (const uint8_t*)Data;
+    uint32_t       Index;
+
+    /* FNV-1a */
+    for (Index = 0; Index < Length; Index++)
+    {
+        Hash = (Hash ^ Bytes[Index]) * 16777619u;
+    }
+
+    return Hash;
+}
+
+/* Gets the cache entry of the input, or replaces the least recently used one */
+static DLPC654X_WarpMeshCacheEntry_s* LookupCache(DLPC654X_WarpMesh_s* Mesh,
+                                                  uint8_t              Source,
+                                                  uint16_t             Columns,
+                                                  uint16_t             Rows,
+                                                  const float*         Points,
+                                                  bool*                Hit)
+{
+    DLPC654X_WarpMeshCacheEntry_s* Entry;
+    DLPC654X_WarpMeshCacheEntry_s* Oldest      = &Mesh->Cache[0];
+    uint32_t                       PointsBytes = Columns * Rows * 2 * sizeof(float);
+    uint32_t                       Hash        = 2166136261u;
+    uint32_t                       Index;
+
+    Hash = HashBytes(Hash, &Source, sizeof(Source));
+    Hash = HashBytes(Hash, &Columns, sizeof(Columns));
+    Hash = HashBytes(Hash, &Rows, sizeof(Rows));
+    Hash = HashBytes(Hash, Points, PointsBytes);
+
+    Mesh->UseCount++;
+
+    for (Index = 0; Index < DLPC654X_WARP_MESH_CACHE_SIZE; Index++)
+    {
+        Entry = &Mesh->Cache[Index];
+
+        if ((Entry->LastUsed != 0) && (Entry->Hash == Hash) && (Entry->Source == Source) &&
+            (Entry->Columns == Columns) && (Entry->Rows == Rows) &&
+            (memcmp(Entry->Points, Points, PointsBytes) == 0))
+        {
+            Entry->LastUsed = Mesh->UseCount;
+            *Hit = true;
+            return Entry;
+        }
+
+        if (Entry->LastUsed < Oldest->LastUsed)
+        {
+            Oldest = Entry;
+        }
+    }
+
+    Oldest->Hash     = Hash;
+    Oldest->Source   = Source;
+    Oldest->Columns  = Columns;
+    Oldest->Rows     = Rows;
+    Oldest->LastUsed = Mesh->UseCount;
+    memcpy(Oldest->Points, Points, PointsBytes);
+
+    *Hit = false;
+    return Oldest;
+}
+
+/*
+ * Gets the control points around a position of the mesh and their weights.
+ * Past the edge of the mesh the spline continues linearly, so a mesh of
+ * evenly spaced points maps to evenly spaced points with either
+ * interpolation.
+ */
+static void GetTaps(DLPC654X_WarpMeshInterpolation_e Interpolation,
+                    uint16_t                         NumControls,
+                    uint16_t                         Index,
+                    uint16_t                         NumSamples,
+                    uint16_t*                        Taps,
+                    float*                           Weights)
+{
+    float   Position = (float)Index * (NumControls - 1) / (NumSamples - 1);
+    int32_t Base     = (int32_t)Position;
+    float   T;
+
+    if (Base > NumControls - 2)
+    {
+        Base = NumControls - 2;
+    }
+    T = Position - Base;
+
+    Taps[0] = (uint16_t)((Base > 0) ? Base - 1 : Base);
+    Taps[1] = (uint16_t)Base;
+    Taps[2] = (uint16_t)(Base + 1);
+    Taps[3] = (uint16_t)((Base + 2 < NumControls) ? Base + 2 : Base + 1);
+
+    if (Interpolation != DLPC654X_WARP_MESH_BICUBIC)
+    {
+        Weights[0] = 0.0f;
+        Weights[1] = 1.0f - T;
+        Weights[2] = T;
+        Weights[3] = 0.0f;
+        return;
+    }
+
+    Weights[0] = ((-T + 2.0f) * T - 1.0f) * T * 0.5f;
+    Weights[1] = ((3.0f * T - 5.0f) * T * T + 2.0f) * 0.5f;
+    Weights[2] = ((-3.0f * T + 4.0f) * T + 1.0f) * T * 0.5f;
+    Weights[3] = (T - 1.0f) * T * T * 0.5f;
+
+    /* Fold the missing point P[-1] = 2 P[0] - P[1] into the others */
+    if (Base == 0)
+    {
+        Weights[1] += 2.0f * Weights[0];
+        Weights[2] -= Weights[0];
+        Weights[0]  = 0.0f;
+    }
+    if (Base + 2 >= NumControls)
+    {
+        Weights[2] += 2.0f * Weights[3];
+        Weights[1] -= Weights[3];
+        Weights[3]  = 0.0f;
+    }
+}
+
+/* Converts a row of display coordinates to table entries */
+static void StoreRow(const float* Row, uint32_t Length, uint16_t* Entries)
+{
+    uint32_t Index;
+    float    Value;
+
+    for (Index = 0; Index < Length; Index++)
+    {
+        Value = Row[Index] * FIXED_POINT_SCALE + 0.5f;
+        Value = (Value < 0.0f) ? 0.0f : ((Value > 65535.0f) ? 65535.0f : Value);
+        Entries[Index] = (uint16_t)Value;
+    }
+}
+
+static void InterpolateMesh(DLPC654X_WarpMesh_s* Mesh,
+                            uint16_t             Columns,
+                            uint16_t             Rows,
+                            const float*         Points,
+                            uint16_t*            Table)
+{
+    uint16_t WarpColumns = Mesh->Config.WarpColumns;
+    uint16_t WarpRows    = Mesh->Config.WarpRows;
+    uint32_t LineLength  = Columns * 2;
+    uint16_t RowTaps[4];
+    float    RowWeights[4];
+    uint32_t Row;
+    uint32_t Column;
+    uint32_t Tap;
+    uint32_t Index;
+
+    for (Column = 0; Column < WarpColumns; Column++)
+    {
+        GetTaps(Mesh->Config.Interpolation, Columns, Column, WarpColumns,
+                Mesh->ColumnTaps[Column], Mesh->ColumnWeights[Column]);
+    }
+
+    for (Row = 0; Row < WarpRows; Row++)
+    {
+        GetTaps(Mesh->Config.Interpolation, Rows, Row, WarpRows, RowTaps, RowWeights);
+
+        /* Blend the control rows, X and Y alike */
+        for (Index = 0; Index < LineLength; Index++)
+        {
+            Mesh->Line[Index] = 0.0f;
+        }
+        for (Tap = 0; Tap < 4; Tap++)
+        {
+            const float* ControlRow = &Points[RowTaps[Tap] * LineLength];
+            float        Weight     = RowWeights[Tap];
+
+            if (Weight == 0.0f)
+            {
+                continue;
+            }
+            for (Index = 0; Index < LineLength; Index++)
+            {
+                Mesh->Line[Index] += Weight * ControlRow[Index];
+            }
+        }
+
+        /* Blend the points of the line for each table column */
+        for (Column = 0; Column < WarpColumns; Column++)
+        {
+            const uint16_t* Taps    = Mesh->ColumnTaps[Column];
+            const float*    Weights = Mesh->ColumnWeights[Column];
+            const float*    Line    = Mesh->Line;
+
+            Mesh->Row[2 * Column]     = Weights[0] * Line[2 * Taps[0]] + Weights[1] * Line[2 * Taps[1]] +
+                                        Weights[2] * Line[2 * Taps[2]] + Weights[3] * Line[2 * Taps[3]];
+            Mesh->Row[2 * Column + 1] = Weights[0] * Line[2 * Taps[0] + 1] + Weights[1] * Line[2 * Taps[1] + 1] +
+                                        Weights[2] * Line[2 * Taps[2] + 1] + Weights[3] * Line[2 * Taps[3] + 1];
+        }
+
+        StoreRow(Mesh->Row, WarpColumns * 2, &Table[Row * WarpColumns * 2]);
+    }
+}
+
+uint32_t DLPC654X_WARP_MESH_Init(DLPC654X_WarpMesh_s* Mesh, const DLPC654X_WarpMeshConfig_s* Config)
+{
+    if ((Config->WarpColumns < 2) || (Config->WarpRows < 2) ||
+        ((uint32_t)Config->WarpColumns * Config->WarpRows * 2 > DLPC654X_WARP_MAX_TABLE_ENTRIES))
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    memset(Mesh, 0, sizeof(*Mesh));
+    Mesh->Config = *Config;
+    DLPC654X_WARP_InitUploader(&Mesh->Uploader, Config->WarpColumns * Config->WarpRows * 2);
+
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_WARP_MESH_ComputeFromControlPoints(DLPC654X_WarpMesh_s* Mesh,
+                                                     uint16_t             Columns,
+                                                     uint16_t             Rows,
+                                                     const float*         Points,
+                                                     const uint16_t**     Table)
+{
+    DLPC654X_WarpMeshCacheEntry_s* Entry;
+    bool                           Hit;
+
+    if ((Columns < 2) || (Rows < 2) || ((uint32_t)Columns * Rows > DLPC654X_WARP_MESH_MAX_CONTROL_POINTS))
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    Entry = LookupCache(Mesh, SOURCE_CONTROL_POINTS, Columns, Rows, Points, &Hit);
+    if (Hit)
+    {
+        Mesh->Statistics.CacheHits++;
+    }
+    else
+    {
+        InterpolateMesh(Mesh, Columns, Rows, Points, Entry->Table);
+        Mesh->Statistics.Computed++;
+    }
+
+    *Table = Entry->Table;
+    return SUCCESS;
+}
+
+uint32_t DLPC654X_WARP_MESH_ComputeFromCorners(DLPC654X_WarpMesh_s*              Mesh,
+                                               const DLPC654X_KeystoneCorners_s* Corners,
+                                               const uint16_t**                  Table)
+{
+    DLPC654X_WarpMeshCacheEntry_s* Entry;
+    bool                           Hit;
+    float                          Points[8];
+    float                          X0, Y0, X1, Y1, X2, Y2, X3, Y3;
+    float                          SumX, SumY, Denominator;
+    float                          A, B, C, D, E, F, G, H;
+    float                          U, V, W;
+    uint32_t                       Row;
+    uint32_t                       Column;
+
+    /* Unit square (0,0) (1,0) (1,1) (0,1) to the corners, see Heckbert 1989 */
+    X0 = Points[0] = Corners->TopLeftX;
+    Y0 = Points[1] = Corners->TopLeftY;
+    X1 = Points[2] = Corners->TopRightX;
+    Y1 = Points[3] = Corners->TopRightY;
+    X2 = Points[4] = Corners->BottomRightX;
+    Y2 = Points[5] = Corners->BottomRightY;
+    X3 = Points[6] = Corners->BottomLeftX;
+    Y3 = Points[7] = Corners->BottomLeftY;
+
+    SumX = X0 - X1 + X2 - X3;
+    SumY = Y0 - Y1 + Y2 - Y3;
+
+    if ((SumX == 0.0f) && (SumY == 0.0f))
+    {
+        G = H = 0.0f;
+    }
+    else
+    {
+        Denominator = (X1 - X2) * (Y3 - Y2) - (X3 - X2) * (Y1 - Y2);
+        if (Denominator == 0.0f)
+        {
+            return ERR_WARP_INVALID_PARAMETER;
+        }
+        G = (SumX * (Y3 - Y2) - (X3 - X2) * SumY) / Denominator;
+        H = ((X1 - X2) * SumY - SumX * (Y1 - Y2)) / Denominator;
+    }
+
+    A = X1 - X0 + G * X1;
+    B = X3 - X0 + H * X3;
+    C = X0;
+    D = Y1 - Y0 + G * Y1;
+    E = Y3 - Y0 + H * Y3;
+    F = Y0;
+
+    if (A * E - B * D == 0.0f)
+    {
+        return ERR_WARP_INVALID_PARAMETER;
+    }
+
+    Entry = LookupCache(Mesh, SOURCE_CORNERS, 2, 2, Points, &Hit);
+    if (Hit)
+    {
+        Mesh->Statistics.CacheHits++;
+        *Table = Entry->Table;
+        return SUCCESS;
+    }
+
+    for (Row = 0; Row < Mesh->Config.WarpRows; Row++)
+    {
+        V = (float)Row / (Mesh->Config.WarpRows - 1);
+
+        for (Column = 0; Column < Mesh->Config.WarpColumns; Column++)
+        {
+            U = (float)Column / (Mesh->Config.WarpColumns - 1);
+            W = 1.0f / (G * U + H * V + 1.0f);
+
+            Mesh->Row[2 * Column]     = (A * U + B * V + C) * W;
+            Mesh->Row[2 * Column + 1] = (D * U + E * V + F) * W;
+        }
+
+        StoreRow(Mesh->Row, Mesh->Config.WarpColumns * 2, &Entry->Table[Row * Mesh->Config.WarpColumns * 2]);
+    }
+    Mesh->Statistics.Computed++;
+
+    *Table = Entry->Table;
+    return SUCCESS;
+}
+
+void DLPC654X_WARP_MESH_GetControlPoints(const DLPC654X_WarpMesh_s* Mesh, DLPC654X_ManualWarpControlPoints_s* ControlPoints)
+{
+    ControlPoints->ControlPointsDefinedByArray = 0;
+    ControlPoints->InputWidth                  = Mesh->Config.InputWidth;
+    ControlPoints->InputHeight                 = Mesh->Config.InputHeight;
+    ControlPoints->WarpColumns                 = Mesh->Config.WarpColumns;
+    ControlPoints->WarpRows                    = Mesh->Config.WarpRows;
+}
+
+uint32_t DLPC654X_WARP_MESH_Upload(DLPC654X_WarpMesh_s* Mesh, const uint16_t* Table)
+{
+    return DLPC654X_WARP_UpdateTable(&Mesh->Uploader, Table);
+}
@@ -0,0 +1,194 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Computes the manual warp table of the 654x controllers from a
+ *         calibration mesh or from keystone corners, caching the results
+ *         and uploading only the entries that changed.
+ *
+ * The table is a grid of WarpColumns x WarpRows points, evenly spaced over
+ * the input image and stored row by row as X, Y pairs of 13.3 fixed point
+ * display coordinates. Coordinates passed to this module are in display
+ * pixels.
+ */
+
+#ifndef DLPC654X_WARP_MESH_H
+#define DLPC654X_WARP_MESH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "dlpc654x.h"
+#include "dlpc654x_warp.h"
+
+/** Most control points of a calibration mesh */
+#define DLPC654X_WARP_MESH_MAX_CONTROL_POINTS   1024
+
+/** Most columns of the table grid, the table holds at least two rows */
+#define DLPC654X_WARP_MESH_MAX_COLUMNS          (DLPC654X_WARP_MAX_TABLE_ENTRIES / 4)
+
+/** Number of computed tables kept, the least recently used is replaced */
+#define DLPC654X_WARP_MESH_CACHE_SIZE           4
+
+typedef enum
+{
+    DLPC654X_WARP_MESH_BILINEAR = 0,        /**< Linear between the two nearest control points */
+    DLPC654X_WARP_MESH_BICUBIC  = 1,        /**< Catmull-Rom spline through the four nearest control points */
+} DLPC654X_WarpMeshInterpolation_e;
+
+typedef struct
+{
+    DLPC654X_WarpMeshInterpolation_e Interpolation;
+
+    /** Size of the input image the table grid is spread over */
+    uint16_t InputWidth;
+    uint16_t InputHeight;
+
+    /** Size of the table grid, WarpColumns * WarpRows * 2 entries */
+    uint16_t WarpColumns;
+    uint16_t WarpRows;
+} DLPC654X_WarpMeshConfig_s;
+
+typedef struct
+{
+    /** Key: the input the table was computed from */
+    uint32_t Hash;
+    uint8_t  Source;
+    uint16_t Columns;
+    uint16_t Rows;
+    float    Points[DLPC654X_WARP_MESH_MAX_CONTROL_POINTS * 2];
+
+    uint16_t Table[DLPC654X_WARP_MAX_TABLE_ENTRIES];
+    uint32_t LastUsed;                      /* 0 if the entry is unused */
+} DLPC654X_WarpMeshCacheEntry_s;
+
+typedef struct
+{
+    uint32_t Computed;
+    uint32_t CacheHits;
+} DLPC654X_WarpMeshStatistics_s;
+
+/**
+ * Generator state. The structure is large; allocate it statically or on
+ * the heap.
+ */
+typedef struct
+{
+    DLPC654X_WarpMeshConfig_s     Config;
+    DLPC654X_WarpMeshCacheEntry_s Cache[DLPC654X_WARP_MESH_CACHE_SIZE];
+    uint32_t                      UseCount;
+    DLPC654X_WarpMeshStatistics_s Statistics;
+
+    /** Tracks the table on the controller for DLPC654X_WARP_MESH_Upload */
+    DLPC654X_WarpUploader_s       Uploader;
+
+    /* Interpolation taps of each table column and a row of the computation */
+    uint16_t                      ColumnTaps[DLPC654X_WARP_MESH_MAX_COLUMNS][4];
+    float                         ColumnWeights[DLPC654X_WARP_MESH_MAX_COLUMNS][4];
+    float                         Line[DLPC654X_WARP_MESH_MAX_CONTROL_POINTS];
+    float                         Row[DLPC654X_WARP_MESH_MAX_COLUMNS * 2];
+} DLPC654X_WarpMesh_s;
+
+/**
+ * Initializes a generator and empties its cache
+ *
+ * \param[out] Mesh    The generator
+ * \param[in]  Config  Table grid and interpolation
+ *
+ * \return 0 if successful, ERR_WARP_INVALID_PARAMETER if the grid is smaller
+ *         than 2 x 2 or does not fit the table
+ */
+uint32_t DLPC654X_WARP_MESH_Init(DLPC654X_WarpMesh_s* Mesh, const DLPC654X_WarpMeshConfig_s* Config);
+
+/**
+ * Computes the table from a calibration mesh. The control points are evenly
+ * spaced over the input image and give where each lands on the display.
+ *
+ * \param[in,out] Mesh     The generator
+ * \param[in]     Columns  Control points per row, at least 2
+ * \param[in]     Rows     Rows of control points, at least 2
+ * \param[in]     Points   Display X, Y pairs of the control points, row by row
+ * \param[out]    Table    The table, valid until a later compute call replaces
+ *                         the cache entry
+ *
+ * \return 0 if successful, ERR_WARP_INVALID_PARAMETER otherwise
+ */
+uint32_t DLPC654X_WARP_MESH_ComputeFromControlPoints(DLPC654X_WarpMesh_s* Mesh,
+                                                     uint16_t             Columns,
+                                                     uint16_t             Rows,
+                                                     const float*         Points,
+                                                     const uint16_t**     Table);
+
+/**
+ * Computes the table that maps the input image onto the quadrilateral given
+ * by its corners. The mapping is projective, so straight lines of the input
+ * stay straight, as with the keystone correction of the controller.
+ *
+ * \param[in,out] Mesh     The generator
+ * \param[in]     Corners  Display positions of the input image corners
+ * \param[out]    Table    The table, see DLPC654X_WARP_MESH_ComputeFromControlPoints
+ *
+ * \return 0 if successful, ERR_WARP_INVALID_PARAMETER if the corners do not
+ *         form a quadrilateral
+ */
+uint32_t DLPC654X_WARP_MESH_ComputeFromCorners(DLPC654X_WarpMesh_s*              Mesh,
+                                               const DLPC654X_KeystoneCorners_s* Corners,
+                                               const uint16_t**                  Table);
+
+/**
+ * Fills the control points command for the table grid of the generator
+ *
+ * \param[in]  Mesh           The generator
+ * \param[out] ControlPoints  Evenly spaced WarpColumns x WarpRows grid
+ */
+void DLPC654X_WARP_MESH_GetControlPoints(const DLPC654X_WarpMesh_s* Mesh, DLPC654X_ManualWarpControlPoints_s* ControlPoints);
+
+/**
+ * Uploads a computed table, sending only the entries that changed since the
+ * previous upload. See DLPC654X_WARP_UpdateTable.
+ *
+ * \param[in,out] Mesh   The generator
+ * \param[in]     Table  Table computed by the generator
+ *
+ * \return 0 if successful, error code of the commands otherwise
+ */
+uint32_t DLPC654X_WARP_MESH_Upload(DLPC654X_WarpMesh_s* Mesh, const uint16_t* Table);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC654X_WARP_MESH_H */
@@ -37,18 +37,19 @@
   */
 
 #include "dlpc_common.h"
+#include "dlpc_common_platform.h"
 #include "stdbool.h"
+#include "stddef.h"
 #include "string.h"
 
-static uint8_t*                          s_WriteBuffer;
-static uint16_t                          s_WriteBufferSize;
-static uint16_t                          s_WriteBufferIndex;
-static uint8_t*                          s_ReadBuffer;
-static uint16_t                          s_ReadBufferSize;
-static uint16_t                          s_ReadBufferIndex;
-static DLPC_COMMON_WriteCommandCallback  s_WriteCommandCallback;
-static DLPC_COMMON_ReadCommandCallback   s_ReadCommandCallback;
-static DLPC_COMMON_CommandProtocolData_s s_ProtocolData;
+/* Used by InitCommandLibrary and by threads without their own context */
+static DLPC_COMMON_CommandContext_s                           s_DefaultContext;
+static DLPC_COMMON_THREAD_LOCAL DLPC_COMMON_CommandContext_s* s_Context;
+
+static DLPC_COMMON_CommandContext_s* GetContext()
+{
+    return s_Context != NULL ? s_Context : &s_DefaultContext;
+}
 
 void DLPC_COMMON_InitCommandLibrary(
     uint8_t*                         WriteBuffer,
@@ -58,38 +59,124 @@ void DLPC_COMMON_InitCommandLibrary(
     DLPC_COMMON_WriteCommandCallback WriteCommandCallback,
     DLPC_COMMON_ReadCommandCallback  ReadCommandCallback)
 {
-    s_WriteBuffer          = WriteBuffer;
-    s_WriteBufferSize      = WriteBufferSize;
-    s_ReadBuffer           = ReadBuffer;
-    s_ReadBufferSize       = ReadBufferSize;
-    s_WriteCommandCallback = WriteCommandCallback;
-    s_ReadCommandCallback  = ReadCommandCallback;
+    DLPC_COMMON_InitCommandContext(&s_DefaultContext,
+                                   WriteBuffer,
+                                   WriteBufferSize,
+                                   ReadBuffer,
+                                   ReadBufferSize,
+                                   WriteCommandCallback,
+                                   ReadCommandCallback,
+                                   NULL);
+}
+
+void DLPC_COMMON_InitCommandContext(
+    DLPC_COMMON_CommandContext_s*    Context,
+    uint8_t*                         WriteBuffer,
+    uint16_t                         WriteBufferSize,
+    uint8_t*                         ReadBuffer,
+    uint16_t                         ReadBufferSize,
+    DLPC_COMMON_WriteCommandCallback WriteCommandCallback,
+    DLPC_COMMON_ReadCommandCallback  ReadCommandCallback,
+    void*                            UserData)
+{
+    memset(Context, 0, sizeof(*Context));
+
+    Context->WriteBuffer          = WriteBuffer;
+    Context->WriteBufferSize      = WriteBufferSize;
+    Context->ReadBuffer           = ReadBuffer;
+    Context->ReadBufferSize       = ReadBufferSize;
+    Context->WriteCommandCallback = WriteCommandCallback;
+    Context->ReadCommandCallback  = ReadCommandCallback;
+    Context->UserData             = UserData;
+}
+
+void DLPC_COMMON_SetCommandContext(DLPC_COMMON_CommandContext_s* Context)
+{
+    s_Context = Context;
+}
+
+DLPC_COMMON_CommandContext_s* DLPC_COMMON_GetCommandContext()
+{
+    return GetContext();
+}
+
+void DLPC_COMMON_SetBusCallbacks(
+    DLPC_COMMON_CommandContext_s*  Context,
+    DLPC_COMMON_AcquireBusCallback AcquireBusCallback,
+    DLPC_COMMON_ReleaseBusCallback ReleaseBusCallback)
+{
+    Context->AcquireBusCallback = AcquireBusCallback;
+    Context->ReleaseBusCallback = ReleaseBusCallback;
+}
+
+uint32_t DLPC_COMMON_AcquireBus()
+{
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+    uint32_t                      Status  = 0;
+
+    if ((Context->BusLeaseCount == 0) && (Context->AcquireBusCallback != NULL))
+    {
+        Status = Context->AcquireBusCallback(Context->UserData);
+    }
+
+    if (Status == 0)
+    {
+        Context->BusLeaseCount++;
+    }
+
+    return Status;
+}
+
+void DLPC_COMMON_ReleaseBus()
+{
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    if (Context->BusLeaseCount == 0)
+    {
+        return;
+    }
+
+    Context->BusLeaseCount--;
+    if ((Context->BusLeaseCount == 0) && (Context->ReleaseBusCallback != NULL))
+    {
+        Context->ReleaseBusCallback(Context->UserData);
+    }
 }
 
 uint32_t DLPC_COMMON_SendWrite()
 {
-    return s_WriteCommandCallback(s_WriteBufferIndex, s_WriteBuffer, &s_ProtocolData);
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    return Context->WriteCommandCallback(Context->WriteBufferIndex,
+                                         Context->WriteBuffer,
+                                         &Context->ProtocolData);
 }
 
 uint32_t DLPC_COMMON_SendRead(uint16_t ReadLength)
 {
-    return s_ReadCommandCallback(s_WriteBufferIndex,
-                                 s_WriteBuffer,
-                                 ReadLength,
-                                 s_ReadBuffer,
-                                 &s_ProtocolData);
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    return Context->ReadCommandCallback(Context->WriteBufferIndex,
+                                        Context->WriteBuffer,
+                                        ReadLength,
+                                        Context->ReadBuffer,
+                                        &Context->ProtocolData);
 }
 
 void DLPC_COMMON_ClearWriteBuffer()
 {
-    memset(s_WriteBuffer, 0, s_WriteBufferSize);
-    s_WriteBufferIndex = 0;
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    memset(Context->WriteBuffer, 0, Context->WriteBufferSize);
+    Context->WriteBufferIndex = 0;
 }
 
 void DLPC_COMMON_ClearReadBuffer()
 {
-    memset(s_ReadBuffer, 0, s_ReadBufferSize);
-    s_ReadBufferIndex = 0;
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    memset(Context->ReadBuffer, 0, Context->ReadBufferSize);
+    Context->ReadBufferIndex = 0;
 }
 
 int64_t ConvertFloatToFixed(double Value, uint32_t Scale)
@@ -114,25 +201,31 @@ bool IsSignedBitSet(int64_t Value, int32_t NumBits)
 
 void DLPC_COMMON_PackOpcode(int32_t Length, uint16_t Opcode)
 {
-    memcpy(&s_WriteBuffer[s_WriteBufferIndex], &Opcode, Length);
-    s_WriteBufferIndex += Length;
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    memcpy(&Context->WriteBuffer[Context->WriteBufferIndex], &Opcode, Length);
+    Context->WriteBufferIndex += Length;
 }
 
 void DLPC_COMMON_MoveWriteBufferPointer(int32_t Offset)
 {
-    s_WriteBufferIndex += Offset;
+    GetContext()->WriteBufferIndex += Offset;
 }
 
 void DLPC_COMMON_PackByte(uint8_t Data)
 {
-    s_WriteBuffer[s_WriteBufferIndex] = Data;
-    s_WriteBufferIndex++;
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    Context->WriteBuffer[Context->WriteBufferIndex] = Data;
+    Context->WriteBufferIndex++;
 }
 
 void DLPC_COMMON_PackBytes(uint8_t* Data, int32_t Length)
 {
-    memcpy(&s_WriteBuffer[s_WriteBufferIndex], Data, Length);
-    s_WriteBufferIndex += Length;
+    DLPC_COMMON_CommandContext_s* Context = GetContext();
+
+    memcpy(&Context->WriteBuffer[Context->WriteBufferIndex], Data, Length);
+    Context->WriteBufferIndex += Length;
 }
 
 void DLPC_COMMON_PackFloat(double Value, int32_t Length, uint32_t Scale)
@@ -143,8 +236,9 @@ void DLPC_COMMON_PackFloat(double Value, int32_t Length, uint32_t Scale)
 
 void DLPC_COMMON_SetBits(int32_t Value, int32_t NumBits, int32_t BitOffset)
 {
-    uint32_t StartBit  = BitOffset % 8;
-    uint32_t StartByte = s_WriteBufferIndex + (BitOffset / 8);
+    uint8_t* WriteBuffer = GetContext()->WriteBuffer;
+    uint32_t StartBit    = BitOffset % 8;
+    uint32_t StartByte   = GetContext()->WriteBufferIndex + (BitOffset / 8);
     uint32_t EndByte   = StartByte + ((NumBits + 7) / 8);
     uint32_t Index;
     uint64_t BitMask;
@@ -153,8 +247,8 @@ void DLPC_COMMON_SetBits(int32_t Value, int32_t NumBits, int32_t BitOffset)
     {
         BitMask = GetBitMask(NumBits > 8 ? 8 : NumBits);
         
-        s_WriteBuffer[Index] &= (uint8_t)(~(BitMask << StartBit));
-        s_WriteBuffer[Index] |= (uint8_t)((Value & BitMask) << StartBit);
+        WriteBuffer[Index] &= (uint8_t)(~(BitMask << StartBit));
+        WriteBuffer[Index] |= (uint8_t)((Value & BitMask) << StartBit);
         
         Value    = Value >> (8 - StartBit);
         NumBits  = NumBits - (8 - StartBit);
@@ -164,15 +258,16 @@ void DLPC_COMMON_SetBits(int32_t Value, int32_t NumBits, int32_t BitOffset)
 
 void DLPC_COMMON_MoveReadBufferPointer(int32_t Length)
 {
-    s_ReadBufferIndex += Length;
+    GetContext()->ReadBufferIndex += Length;
 }
 
 uint8_t* DLPC_COMMON_UnpackBytes(int32_t Length)
 {
-    uint16_t CurReadBufferIndex = s_ReadBufferIndex;
-    s_ReadBufferIndex += Length;
+    DLPC_COMMON_CommandContext_s* Context            = GetContext();
+    uint16_t                      CurReadBufferIndex = Context->ReadBufferIndex;
+    Context->ReadBufferIndex += Length;
 
-    return &s_ReadBuffer[CurReadBufferIndex];
+    return &Context->ReadBuffer[CurReadBufferIndex];
 }
 
 double DLPC_COMMON_UnpackFloat(int32_t Length, uint32_t Scale, bool Signed)
@@ -191,8 +286,9 @@ double DLPC_COMMON_UnpackFloat(int32_t Length, uint32_t Scale, bool Signed)
 
 uint64_t DLPC_COMMON_GetBits(uint8_t NumBits, uint8_t BitOffset, bool Signed)
 {
-    uint32_t StartBit  = BitOffset % 8;
-    uint32_t StartByte = s_ReadBufferIndex + (BitOffset / 8);
+    uint8_t* ReadBuffer = GetContext()->ReadBuffer;
+    uint32_t StartBit   = BitOffset % 8;
+    uint32_t StartByte  = GetContext()->ReadBufferIndex + (BitOffset / 8);
     uint32_t EndByte   = StartByte + ((NumBits + 7) / 8);
     uint64_t Value     = 0;
     uint32_t Index;
@@ -204,7 +300,7 @@ uint64_t DLPC_COMMON_GetBits(uint8_t NumBits, uint8_t BitOffset, bool Signed)
         BitMask = GetBitMask(NumBits > 8 ? 8 : NumBits);
 
         Shift = 8 * (Index - StartByte);
-        Value |= (((s_ReadBuffer[Index] >> StartBit) & BitMask) << Shift);
+        Value |= (((ReadBuffer[Index] >> StartBit) & BitMask) << Shift);
 
         NumBits  = NumBits - (8 - StartBit);
         StartBit = 0;
@@ -215,10 +311,20 @@ uint64_t DLPC_COMMON_GetBits(uint8_t NumBits, uint8_t BitOffset, bool Signed)
 
 void DLPC_COMMON_SetCommandDestination(uint16_t CommandDestination)
 {
-    s_ProtocolData.CommandDestination = CommandDestination;
+    GetContext()->ProtocolData.CommandDestination = CommandDestination;
 }
 
 uint16_t DLPC_COMMON_GetBytesRead()
 {
-    return s_ProtocolData.BytesRead;
+    return GetContext()->ProtocolData.BytesRead;
+}
+
+uint16_t DLPC_COMMON_GetWriteBufferSize()
+{
+    return GetContext()->WriteBufferSize;
+}
+
+uint16_t DLPC_COMMON_GetReadBufferSize()
+{
+    return GetContext()->ReadBufferSize;
 }
\ No newline at end of file
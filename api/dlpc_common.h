@@ -50,6 +50,9 @@ extern "C" {
 #define SUCCESS                           0
 #define FAIL                              1
 
+/** A command does not fit into the write buffer of the command context */
+#define ERR_COMMAND_BUFFER_OVERFLOW       340
+
 #define DLP2010_WIDTH  854
 #define DLP2010_HEIGHT 480
 #define DLP230GP_WIDTH 960
@@ -117,6 +120,56 @@ typedef uint32_t(*DLPC_COMMON_ReadCommandCallback) (
     DLPC_COMMON_CommandProtocolData_s* ProtocolData
 );
 
+/**
+* The callback method that gives the caller exclusive access to the bus of
+* the controller, e.g. through a bus arbitration handshake
+*
+* \param[in] UserData  The UserData of the command context
+*
+* \return 0 if access was granted,
+*         error code otherwise
+*/
+typedef uint32_t(*DLPC_COMMON_AcquireBusCallback) (void* UserData);
+
+/**
+* The callback method that gives up the bus access obtained by the
+* DLPC_COMMON_AcquireBusCallback
+*
+* \param[in] UserData  The UserData of the command context
+*/
+typedef void(*DLPC_COMMON_ReleaseBusCallback) (void* UserData);
+
+/**
+* The buffers, callbacks and protocol state used by the command APIs for one
+* controller. Each thread issues commands through its own current context, so
+* several controllers can be commanded concurrently, one per thread.
+*/
+typedef struct
+{
+    uint8_t*                          WriteBuffer;
+    uint16_t                          WriteBufferSize;
+    uint16_t                          WriteBufferIndex;
+    uint8_t*                          ReadBuffer;
+    uint16_t                          ReadBufferSize;
+    uint16_t                          ReadBufferIndex;
+    DLPC_COMMON_WriteCommandCallback  WriteCommandCallback;
+    DLPC_COMMON_ReadCommandCallback   ReadCommandCallback;
+    DLPC_COMMON_CommandProtocolData_s ProtocolData;
+
+    /** 
+    * Caller data for the callbacks, typically the handle of the transport 
+    * connected to the controller
+    */
+    void*                             UserData;
+
+    /** Optional bus arbitration callbacks, see DLPC_COMMON_SetBusCallbacks */
+    DLPC_COMMON_AcquireBusCallback    AcquireBusCallback;
+    DLPC_COMMON_ReleaseBusCallback    ReleaseBusCallback;
+
+    /** Number of DLPC_COMMON_AcquireBus calls not yet released */
+    uint32_t                          BusLeaseCount;
+} DLPC_COMMON_CommandContext_s;
+
 /**
 * Initializes the read/write buffers and callbacks for the command APIs
 * 
@@ -152,6 +205,78 @@ void DLPC_COMMON_InitCommandLibrary(
     DLPC_COMMON_ReadCommandCallback  ReadCommandCallback
 );
 
+/**
+* Initializes a command context with its own read/write buffers and callbacks.
+* See DLPC_COMMON_InitCommandLibrary for the use of the buffers and callbacks.
+*
+* \param[out] Context              The command context
+* \param[in]  WriteBuffer          The write buffer
+* \param[in]  WriteBufferSize      The write buffer size in bytes
+* \param[in]  ReadBuffer           The read buffer
+* \param[in]  ReadBufferSize       The read buffer size in bytes
+* \param[in]  WriteCommandCallback The write command callback
+* \param[in]  ReadCommandCallback  The read command callback
+* \param[in]  UserData             Caller data for the callbacks, available
+*                                  through DLPC_COMMON_GetCommandContext
+*/
+void DLPC_COMMON_InitCommandContext(
+    DLPC_COMMON_CommandContext_s*    Context,
+    uint8_t*                         WriteBuffer,
+    uint16_t                         WriteBufferSize,
+    uint8_t*                         ReadBuffer,
+    uint16_t                         ReadBufferSize,
+    DLPC_COMMON_WriteCommandCallback WriteCommandCallback,
+    DLPC_COMMON_ReadCommandCallback  ReadCommandCallback,
+    void*                            UserData
+);
+
+/**
+* Selects the command context used by the command APIs called from the 
+* calling thread. Threads that never select a context use the one set up by
+* DLPC_COMMON_InitCommandLibrary.
+*
+* \param[in] Context  The command context, NULL to use the default context
+*/
+void DLPC_COMMON_SetCommandContext(DLPC_COMMON_CommandContext_s* Context);
+
+/**
+* Gets the command context used by the calling thread
+*
+* \return The current command context
+*/
+DLPC_COMMON_CommandContext_s* DLPC_COMMON_GetCommandContext();
+
+/**
+* Sets the bus arbitration callbacks of a command context. Without callbacks
+* DLPC_COMMON_AcquireBus and DLPC_COMMON_ReleaseBus do nothing.
+*
+* \param[in,out] Context             The command context
+* \param[in]     AcquireBusCallback  The callback that obtains bus access
+* \param[in]     ReleaseBusCallback  The callback that gives up bus access
+*/
+void DLPC_COMMON_SetBusCallbacks(
+    DLPC_COMMON_CommandContext_s*  Context,
+    DLPC_COMMON_AcquireBusCallback AcquireBusCallback,
+    DLPC_COMMON_ReleaseBusCallback ReleaseBusCallback
+);
+
+/**
+* Starts a bus session for the current command context. Only the outermost
+* call of nested sessions runs the AcquireBusCallback, so a batch of commands
+* or a flash job wrapped in a session holds the bus for its whole duration.
+* Every successful call must be matched by DLPC_COMMON_ReleaseBus.
+*
+* \return 0 if the bus is held,
+*         error code returned by the AcquireBusCallback otherwise
+*/
+uint32_t DLPC_COMMON_AcquireBus();
+
+/**
+* Ends a bus session started by DLPC_COMMON_AcquireBus. The bus is released
+* when the outermost session ends.
+*/
+void DLPC_COMMON_ReleaseBus();
+
 
 #ifdef __cplusplus    /* matches __cplusplus construct above */
 }
@@ -0,0 +1,417 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the capture and replay of command traffic.
+ */
+
+#include "dlpc_common_capture.h"
+#include "stddef.h"
+#include "string.h"
+
+#define RECORD_ALIGNMENT                  8
+#define CAPTURE_FILE_BUFFER_SIZE          65536
+
+static const uint8_t s_Padding[RECORD_ALIGNMENT];
+
+static uint32_t GetPaddedLength(uint32_t Length)
+{
+    return (Length + RECORD_ALIGNMENT - 1) & ~(uint32_t)(RECORD_ALIGNMENT - 1);
+}
+
+static void WriteRecord(DLPC_COMMON_Capture_s* Capture,
+                        uint8_t                Type,
+                        uint64_t               StartTime,
+                        uint32_t               Status,
+                        uint16_t               Destination,
+                        uint16_t               WriteLength,
+                        const uint8_t*         WriteData,
+                        uint16_t               RequestedReadLength,
+                        uint16_t               ReadLength,
+                        const uint8_t*         ReadData)
+{
+    DLPC_COMMON_CaptureRecord_s Record;
+    uint32_t                    DataLength = (uint32_t)WriteLength + ReadLength;
+    uint32_t                    PadLength  = GetPaddedLength(DataLength) - DataLength;
+
+    if (Capture->FileStatus != 0)
+    {
+        return;
+    }
+
+    memset(&Record, 0, sizeof(Record));
+    Record.TimeMicroseconds     = StartTime - Capture->StartTime;
+    Record.DurationMicroseconds = (uint32_t)(DLPC_COMMON_GetTimeInMicroseconds() - StartTime);
+    Record.Status               = Status;
+    Record.Destination          = Destination;
+    Record.WriteLength          = WriteLength;
+    Record.RequestedReadLength  = RequestedReadLength;
+    Record.ReadLength           = ReadLength;
+    Record.Type                 = Type;
+
+    if ((fwrite(&Record, sizeof(Record), 1, Capture->File) != 1) ||
+        (fwrite(WriteData, 1, WriteLength, Capture->File) != WriteLength) ||
+        (fwrite(ReadData, 1, ReadLength, Capture->File) != ReadLength) ||
+        (fwrite(s_Padding, 1, PadLength, Capture->File) != PadLength))
+    {
+        Capture->FileStatus = ERR_CAPTURE_FILE;
+        return;
+    }
+
+    Capture->NumRecords++;
+}
+
+/* The capture is the UserData of the context while capturing */
+static DLPC_COMMON_Capture_s* GetCapture()
+{
+    return (DLPC_COMMON_Capture_s*)DLPC_COMMON_GetCommandContext()->UserData;
+}
+
+static uint32_t CaptureWriteCommand(uint16_t                           WriteLength,
+                                    uint8_t*                           WriteBuffer,
+                                    DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_Capture_s* Capture   = GetCapture();
+    uint64_t               StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+    uint32_t               Status;
+
+    Capture->Context->UserData = Capture->UserData;
+    Status = Capture->WriteCommandCallback(WriteLength, WriteBuffer, ProtocolData);
+    Capture->Context->UserData = Capture;
+
+    WriteRecord(Capture,
+                DLPC_COMMON_CAPTURE_WRITE,
+                StartTime,
+                Status,
+                ProtocolData->CommandDestination,
+                WriteLength,
+                WriteBuffer,
+                0,
+                0,
+                NULL);
+
+    return Status;
+}
+
+static uint32_t CaptureReadCommand(uint16_t                           WriteLength,
+                                   uint8_t*                           WriteBuffer,
+                                   uint16_t                           ReadLength,
+                                   uint8_t*                           ReadBuffer,
+                                   DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_Capture_s* Capture   = GetCapture();
+    uint64_t               StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+    uint16_t               BytesRead = 0;
+    uint32_t               Status;
+
+    Capture->Context->UserData = Capture->UserData;
+    Status = Capture->ReadCommandCallback(WriteLength, WriteBuffer, ReadLength, ReadBuffer, ProtocolData);
+    Capture->Context->UserData = Capture;
+
+    if (Status == 0)
+    {
+        BytesRead = (ReadLength == 0xFFFF) ? ProtocolData->BytesRead : ReadLength;
+    }
+
+    WriteRecord(Capture,
+                DLPC_COMMON_CAPTURE_READ,
+                StartTime,
+                Status,
+                ProtocolData->CommandDestination,
+                WriteLength,
+                WriteBuffer,
+                ReadLength,
+                BytesRead,
+                ReadBuffer);
+
+    return Status;
+}
+
+static uint32_t CaptureAcquireBus(void* UserData)
+{
+    DLPC_COMMON_Capture_s* Capture = (DLPC_COMMON_Capture_s*)UserData;
+
+    return Capture->AcquireBusCallback(Capture->UserData);
+}
+
+static void CaptureReleaseBus(void* UserData)
+{
+    DLPC_COMMON_Capture_s* Capture = (DLPC_COMMON_Capture_s*)UserData;
+
+    Capture->ReleaseBusCallback(Capture->UserData);
+}
+
+uint32_t DLPC_COMMON_StartCapture(DLPC_COMMON_Capture_s*        Capture,
+                                  DLPC_COMMON_CommandContext_s* Context,
+                                  const char*                   FilePath)
+{
+    DLPC_COMMON_CaptureFileHeader_s Header;
+
+    memset(Capture, 0, sizeof(*Capture));
+
+    Capture->File = fopen(FilePath, "wb");
+    if (Capture->File == NULL)
+    {
+        return ERR_CAPTURE_FILE;
+    }
+    setvbuf(Capture->File, NULL, _IOFBF, CAPTURE_FILE_BUFFER_SIZE);
+
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.Magic, DLPC_COMMON_CAPTURE_MAGIC, sizeof(Header.Magic));
+    Header.Version         = DLPC_COMMON_CAPTURE_VERSION;
+    Header.RecordAlignment = RECORD_ALIGNMENT;
+
+    if (fwrite(&Header, sizeof(Header), 1, Capture->File) != 1)
+    {
+        fclose(Capture->File);
+        Capture->File = NULL;
+        return ERR_CAPTURE_FILE;
+    }
+
+    Capture->StartTime            = DLPC_COMMON_GetTimeInMicroseconds();
+    Capture->Context              = Context;
+    Capture->WriteCommandCallback = Context->WriteCommandCallback;
+    Capture->ReadCommandCallback  = Context->ReadCommandCallback;
+    Capture->AcquireBusCallback   = Context->AcquireBusCallback;
+    Capture->ReleaseBusCallback   = Context->ReleaseBusCallback;
+    Capture->UserData             = Context->UserData;
+
+    Context->WriteCommandCallback = CaptureWriteCommand;
+    Context->ReadCommandCallback  = CaptureReadCommand;
+    Context->AcquireBusCallback   = (Capture->AcquireBusCallback != NULL) ? CaptureAcquireBus : NULL;
+    Context->ReleaseBusCallback   = (Capture->ReleaseBusCallback != NULL) ? CaptureReleaseBus : NULL;
+    Context->UserData             = Capture;
+
+    return 0;
+}
+
+uint32_t DLPC_COMMON_StopCapture(DLPC_COMMON_Capture_s* Capture)
+{
+    DLPC_COMMON_CommandContext_s* Context = Capture->Context;
+
+    if (Context == NULL)
+    {
+        return ERR_CAPTURE_FILE;
+    }
+
+    Context->WriteCommandCallback = Capture->WriteCommandCallback;
+    Context->ReadCommandCallback  = Capture->ReadCommandCallback;
+    Context->AcquireBusCallback   = Capture->AcquireBusCallback;
+    Context->ReleaseBusCallback   = Capture->ReleaseBusCallback;
+    Context->UserData             = Capture->UserData;
+    Capture->Context              = NULL;
+
+    if ((fclose(Capture->File) != 0) && (Capture->FileStatus == 0))
+    {
+        Capture->FileStatus = ERR_CAPTURE_FILE;
+    }
+    Capture->File = NULL;
+
+    return Capture->FileStatus;
+}
+
+uint32_t DLPC_COMMON_OpenReplay(DLPC_COMMON_Replay_s* Replay, const char* FilePath)
+{
+    DLPC_COMMON_CaptureFileHeader_s Header;
+    uint32_t                        Status;
+
+    memset(Replay, 0, sizeof(*Replay));
+
+    Status = DLPC_COMMON_MapFile(FilePath, &Replay->File);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    if (Replay->File.Size >= sizeof(Header))
+    {
+        memcpy(&Header, Replay->File.Data, sizeof(Header));
+    }
+
+    if ((Replay->File.Size < sizeof(Header)) ||
+        (memcmp(Header.Magic, DLPC_COMMON_CAPTURE_MAGIC, sizeof(Header.Magic)) != 0) ||
+        (Header.Version != DLPC_COMMON_CAPTURE_VERSION) ||
+        (Header.RecordAlignment != RECORD_ALIGNMENT))
+    {
+        DLPC_COMMON_UnmapFile(&Replay->File);
+        return ERR_CAPTURE_FORMAT;
+    }
+
+    Replay->Offset = sizeof(Header);
+    return 0;
+}
+
+void DLPC_COMMON_CloseReplay(DLPC_COMMON_Replay_s* Replay)
+{
+    DLPC_COMMON_UnmapFile(&Replay->File);
+    memset(Replay, 0, sizeof(*Replay));
+}
+
+bool DLPC_COMMON_NextCaptureRecord(DLPC_COMMON_Replay_s*               Replay,
+                                   const DLPC_COMMON_CaptureRecord_s** Record,
+                                   const uint8_t**                     WriteData,
+                                   const uint8_t**                     ReadData)
+{
+    const DLPC_COMMON_CaptureRecord_s* Next;
+    uint32_t                           Length;
+
+    if (Replay->File.Size - Replay->Offset < sizeof(*Next))
+    {
+        return false;
+    }
+
+    /* Records are aligned to 8 bytes in the mapping */
+    Next   = (const DLPC_COMMON_CaptureRecord_s*)(Replay->File.Data + Replay->Offset);
+    Length = sizeof(*Next) + GetPaddedLength((uint32_t)Next->WriteLength + Next->ReadLength);
+    if (Replay->File.Size - Replay->Offset < Length)
+    {
+        return false;
+    }
+
+    *Record    = Next;
+    *WriteData = (const uint8_t*)(Next + 1);
+    *ReadData  = *WriteData + Next->WriteLength;
+
+    Replay->Offset += Length;
+    Replay->RecordIndex++;
+    return true;
+}
+
+/* Counts a mismatch of the record just read */
+static uint32_t CountMismatch(DLPC_COMMON_Replay_s* Replay)
+{
+    if (Replay->Mismatches == 0)
+    {
+        Replay->FirstMismatchRecord = Replay->RecordIndex - 1;
+    }
+    Replay->Mismatches++;
+
+    return ERR_REPLAY_MISMATCH;
+}
+
+/*
+ * Gets the next record and checks that it is the command being sent.
+ * Returns 0 with the record, or the error to return for the command.
+ */
+static uint32_t MatchRecord(DLPC_COMMON_Replay_s*                    Replay,
+                            uint8_t                                  Type,
+                            uint16_t                                 WriteLength,
+                            const uint8_t*                           WriteBuffer,
+                            uint16_t                                 ReadLength,
+                            const DLPC_COMMON_CommandProtocolData_s* ProtocolData,
+                            const DLPC_COMMON_CaptureRecord_s**      Record,
+                            const uint8_t**                          ReadData)
+{
+    const uint8_t* WriteData;
+
+    if (!DLPC_COMMON_NextCaptureRecord(Replay, Record, &WriteData, ReadData))
+    {
+        return ERR_REPLAY_END;
+    }
+
+    if (((*Record)->Type == Type) &&
+        ((*Record)->Destination == ProtocolData->CommandDestination) &&
+        ((*Record)->WriteLength == WriteLength) &&
+        ((*Record)->RequestedReadLength == ReadLength) &&
+        (memcmp(WriteData, WriteBuffer, WriteLength) == 0))
+    {
+        return 0;
+    }
+
+    return CountMismatch(Replay);
+}
+
+static uint32_t ReplayWriteCommand(uint16_t                           WriteLength,
+                                   uint8_t*                           WriteBuffer,
+                                   DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_Replay_s*              Replay = (DLPC_COMMON_Replay_s*)DLPC_COMMON_GetCommandContext()->UserData;
+    const DLPC_COMMON_CaptureRecord_s* Record;
+    const uint8_t*                     ReadData;
+    uint32_t                           Status;
+
+    Status = MatchRecord(Replay, DLPC_COMMON_CAPTURE_WRITE, WriteLength, WriteBuffer, 0, ProtocolData, &Record, &ReadData);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    return Record->Status;
+}
+
+static uint32_t ReplayReadCommand(uint16_t                           WriteLength,
+                                  uint8_t*                           WriteBuffer,
+                                  uint16_t                           ReadLength,
+                                  uint8_t*                           ReadBuffer,
+                                  DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_CommandContext_s*      Context = DLPC_COMMON_GetCommandContext();
+    DLPC_COMMON_Replay_s*              Replay  = (DLPC_COMMON_Replay_s*)Context->UserData;
+    const DLPC_COMMON_CaptureRecord_s* Record;
+    const uint8_t*                     ReadData;
+    uint32_t                           Status;
+
+    Status = MatchRecord(Replay, DLPC_COMMON_CAPTURE_READ, WriteLength, WriteBuffer, ReadLength, ProtocolData, &Record, &ReadData);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    if (Record->ReadLength > ((ReadLength == 0xFFFF) ? Context->ReadBufferSize : ReadLength))
+    {
+        return CountMismatch(Replay);
+    }
+
+    memcpy(ReadBuffer, ReadData, Record->ReadLength);
+    ProtocolData->BytesRead = Record->ReadLength;
+
+    return Record->Status;
+}
+
+void DLPC_COMMON_InitReplayContext(DLPC_COMMON_CommandContext_s* Context,
+                                   DLPC_COMMON_Replay_s*         Replay,
+                                   uint8_t*                      WriteBuffer,
+                                   uint16_t                      WriteBufferSize,
+                                   uint8_t*                      ReadBuffer,
+                                   uint16_t                      ReadBufferSize)
+{
+    DLPC_COMMON_InitCommandContext(Context,
+                                   WriteBuffer,
+                                   WriteBufferSize,
+                                   ReadBuffer,
+                                   ReadBufferSize,
+                                   ReplayWriteCommand,
+                                   ReplayReadCommand,
+                                   Replay);
+}
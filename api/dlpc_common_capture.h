@@ -0,0 +1,209 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Capture and replay of command traffic. A capture wraps the command
+ *         callbacks of a command context and logs every transaction to a
+ *         file. A replay serves the responses of a capture without a
+ *         controller and checks that the commands sent match the capture.
+ *
+ * Capture file format, little endian, mapped as is when read:
+ *
+ *     DLPC_COMMON_CaptureFileHeader_s
+ *     For each transaction:
+ *         DLPC_COMMON_CaptureRecord_s
+ *         WriteLength bytes of command data
+ *         ReadLength bytes of response data
+ *         Zero padding to a multiple of 8 bytes
+ */
+
+#ifndef DLPC_COMMON_CAPTURE_H
+#define DLPC_COMMON_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "dlpc_common.h"
+#include "dlpc_common_platform.h"
+
+#define ERR_CAPTURE_FILE                  330
+#define ERR_CAPTURE_FORMAT                331
+#define ERR_REPLAY_MISMATCH               332
+#define ERR_REPLAY_END                    333
+
+#define DLPC_COMMON_CAPTURE_MAGIC         "DLPCCAP1"
+#define DLPC_COMMON_CAPTURE_VERSION       1
+
+/** Record types */
+#define DLPC_COMMON_CAPTURE_WRITE         1
+#define DLPC_COMMON_CAPTURE_READ          2
+
+typedef struct
+{
+    char     Magic[8];
+    uint32_t Version;
+    uint32_t RecordAlignment;
+} DLPC_COMMON_CaptureFileHeader_s;
+
+typedef struct
+{
+    /** Start of the transaction, relative to the start of the capture */
+    uint64_t TimeMicroseconds;
+    uint32_t DurationMicroseconds;
+
+    /** Status returned by the command callback */
+    uint32_t Status;
+
+    /** CommandDestination of the protocol data */
+    uint16_t Destination;
+    uint16_t WriteLength;
+
+    /** ReadLength passed to the read callback, 0xFFFF for variable length */
+    uint16_t RequestedReadLength;
+
+    /** Number of response bytes recorded */
+    uint16_t ReadLength;
+    uint8_t  Type;
+    uint8_t  Reserved[7];
+} DLPC_COMMON_CaptureRecord_s;
+
+/**
+ * A capture in progress. It takes the place of the callbacks and the
+ * UserData of the command context, and calls the original callbacks with
+ * the original UserData in place.
+ */
+typedef struct
+{
+    FILE*                            File;
+    uint64_t                         StartTime;
+    uint32_t                         NumRecords;
+
+    /** First error writing the file, later records are dropped */
+    uint32_t                         FileStatus;
+
+    DLPC_COMMON_CommandContext_s*    Context;
+    DLPC_COMMON_WriteCommandCallback WriteCommandCallback;
+    DLPC_COMMON_ReadCommandCallback  ReadCommandCallback;
+    DLPC_COMMON_AcquireBusCallback   AcquireBusCallback;
+    DLPC_COMMON_ReleaseBusCallback   ReleaseBusCallback;
+    void*                            UserData;
+} DLPC_COMMON_Capture_s;
+
+/**
+ * A capture file read for replay or analysis
+ */
+typedef struct
+{
+    DLPC_COMMON_MappedFile_s File;
+
+    /** Offset of the next record */
+    uint32_t                 Offset;
+    uint32_t                 RecordIndex;
+
+    /** Commands that did not match the capture, and the first record of them */
+    uint32_t                 Mismatches;
+    uint32_t                 FirstMismatchRecord;
+} DLPC_COMMON_Replay_s;
+
+/**
+ * Starts capturing the commands of a command context. Until the capture is
+ * stopped, the callbacks and UserData of the context are those of the
+ * capture.
+ *
+ * \param[out]    Capture   The capture
+ * \param[in,out] Context   The command context, with its callbacks set up
+ * \param[in]     FilePath  The capture file to create
+ *
+ * \return 0 if successful, ERR_CAPTURE_FILE otherwise
+ */
+uint32_t DLPC_COMMON_StartCapture(DLPC_COMMON_Capture_s*        Capture,
+                                  DLPC_COMMON_CommandContext_s* Context,
+                                  const char*                   FilePath);
+
+/**
+ * Restores the callbacks of the command context and closes the capture file
+ *
+ * \return 0 if all records were written, ERR_CAPTURE_FILE otherwise
+ */
+uint32_t DLPC_COMMON_StopCapture(DLPC_COMMON_Capture_s* Capture);
+
+/**
+ * Maps a capture file and checks its header
+ *
+ * \return 0 if successful, ERR_FILE_ACCESS or ERR_CAPTURE_FORMAT otherwise
+ */
+uint32_t DLPC_COMMON_OpenReplay(DLPC_COMMON_Replay_s* Replay, const char* FilePath);
+
+void DLPC_COMMON_CloseReplay(DLPC_COMMON_Replay_s* Replay);
+
+/**
+ * Gets the next record of a capture file. The data points into the mapped
+ * file and stays valid until the replay is closed.
+ *
+ * \param[in]  Replay     The replay
+ * \param[out] Record     The record
+ * \param[out] WriteData  The command data of the record
+ * \param[out] ReadData   The response data of the record
+ *
+ * \return false at the end of the file or at a truncated record
+ */
+bool DLPC_COMMON_NextCaptureRecord(DLPC_COMMON_Replay_s*               Replay,
+                                   const DLPC_COMMON_CaptureRecord_s** Record,
+                                   const uint8_t**                     WriteData,
+                                   const uint8_t**                     ReadData);
+
+/**
+ * Initializes a command context that is served by a replay instead of a
+ * controller. Each command must match the next record of the capture in
+ * type, destination and command data; the read commands get the recorded
+ * responses. The replay runs as fast as the commands are issued.
+ *
+ * A command that does not match fails with ERR_REPLAY_MISMATCH, a command
+ * past the end of the capture with ERR_REPLAY_END.
+ */
+void DLPC_COMMON_InitReplayContext(DLPC_COMMON_CommandContext_s* Context,
+                                   DLPC_COMMON_Replay_s*         Replay,
+                                   uint8_t*                      WriteBuffer,
+                                   uint16_t                      WriteBufferSize,
+                                   uint8_t*                      ReadBuffer,
+                                   uint16_t                      ReadBufferSize);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC_COMMON_CAPTURE_H */
@@ -0,0 +1,330 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the platform helpers shared by the command library
+ *         helpers.
+ */
+
+#include "dlpc_common_platform.h"
+#include "stddef.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+uint32_t DLPC_COMMON_MapFile(const char* FilePath, DLPC_COMMON_MappedFile_s* File)
+{
+    HANDLE        FileHandle;
+    HANDLE        MappingHandle;
+    LARGE_INTEGER FileSize;
+    const void*   Data = NULL;
+
+    File->Data          = NULL;
+    File->Size          = 0;
+    File->FileHandle    = NULL;
+    File->MappingHandle = NULL;
+
+    FileHandle = CreateFileA(FilePath, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        return ERR_FILE_ACCESS;
+    }
+
+    if (!GetFileSizeEx(FileHandle, &FileSize) || (FileSize.QuadPart > UINT32_MAX))
+    {
+        CloseHandle(FileHandle);
+        return ERR_FILE_ACCESS;
+    }
+
+    MappingHandle = NULL;
+    if (FileSize.QuadPart > 0)
+    {
+        MappingHandle = CreateFileMappingA(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (MappingHandle != NULL)
+        {
+            Data = MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+        }
+
+        if (Data == NULL)
+        {
+            if (MappingHandle != NULL)
+            {
+                CloseHandle(MappingHandle);
+            }
+            CloseHandle(FileHandle);
+            return ERR_FILE_ACCESS;
+        }
+    }
+
+    File->Data          = (const uint8_t*)Data;
+    File->Size          = (uint32_t)FileSize.QuadPart;
+    File->FileHandle    = FileHandle;
+    File->MappingHandle = MappingHandle;
+
+    return 0;
+}
+
+void DLPC_COMMON_UnmapFile(DLPC_COMMON_MappedFile_s* File)
+{
+    if (File->Data != NULL)
+    {
+        UnmapViewOfFile(File->Data);
+    }
+    if (File->MappingHandle != NULL)
+    {
+        CloseHandle((HANDLE)File->MappingHandle);
+    }
+    if (File->FileHandle != NULL)
+    {
+        CloseHandle((HANDLE)File->FileHandle);
+    }
+
+    File->Data          = NULL;
+    File->Size          = 0;
+    File->FileHandle    = NULL;
+    File->MappingHandle = NULL;
+}
+
+uint64_t DLPC_COMMON_GetTimeInMicroseconds()
+{
+    static LARGE_INTEGER Frequency;
+    LARGE_INTEGER        Counter;
+
+    if (Frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&Frequency);
+    }
+    QueryPerformanceCounter(&Counter);
+
+    return (uint64_t)((Counter.QuadPart / Frequency.QuadPart) * 1000000 +
+                      ((Counter.QuadPart % Frequency.QuadPart) * 1000000) / Frequency.QuadPart);
+}
+
+void DLPC_COMMON_SleepMilliseconds(uint32_t Milliseconds)
+{
+    Sleep(Milliseconds);
+}
+
+static DWORD WINAPI RunThread(LPVOID Argument)
+{
+    DLPC_COMMON_Thread_s* Thread = (DLPC_COMMON_Thread_s*)Argument;
+
+    Thread->Status = Thread->Function(Thread->Argument);
+    return 0;
+}
+
+uint32_t DLPC_COMMON_CreateThread(DLPC_COMMON_ThreadFunction Function,
+                                  void*                      Argument,
+                                  DLPC_COMMON_Thread_s*      Thread)
+{
+    HANDLE Handle;
+
+    Thread->Function = Function;
+    Thread->Argument = Argument;
+    Thread->Status   = 0;
+
+    Handle = CreateThread(NULL, 0, RunThread, Thread, 0, NULL);
+    if (Handle == NULL)
+    {
+        return ERR_THREAD_CREATE;
+    }
+
+    Thread->Handle = (uintptr_t)Handle;
+    return 0;
+}
+
+uint32_t DLPC_COMMON_JoinThread(DLPC_COMMON_Thread_s* Thread)
+{
+    WaitForSingleObject((HANDLE)Thread->Handle, INFINITE);
+    CloseHandle((HANDLE)Thread->Handle);
+
+    return Thread->Status;
+}
+
+uint32_t DLPC_COMMON_AtomicLoad(const volatile uint32_t* Value)
+{
+    uint32_t Result = *Value;
+
+    MemoryBarrier();
+    return Result;
+}
+
+void DLPC_COMMON_AtomicStore(volatile uint32_t* Value, uint32_t NewValue)
+{
+    MemoryBarrier();
+    *Value = NewValue;
+}
+
+void DLPC_COMMON_MemoryFence()
+{
+    MemoryBarrier();
+}
+
+#else
+
+uint32_t DLPC_COMMON_MapFile(const char* FilePath, DLPC_COMMON_MappedFile_s* File)
+{
+    struct stat FileInfo;
+    void*       Data = NULL;
+    int         Fd;
+
+    File->Data          = NULL;
+    File->Size          = 0;
+    File->FileHandle    = NULL;
+    File->MappingHandle = NULL;
+
+    Fd = open(FilePath, O_RDONLY);
+    if (Fd < 0)
+    {
+        return ERR_FILE_ACCESS;
+    }
+
+    if ((fstat(Fd, &FileInfo) != 0) || (FileInfo.st_size > UINT32_MAX))
+    {
+        close(Fd);
+        return ERR_FILE_ACCESS;
+    }
+
+    if (FileInfo.st_size > 0)
+    {
+        Data = mmap(NULL, (size_t)FileInfo.st_size, PROT_READ, MAP_SHARED, Fd, 0);
+        if (Data == MAP_FAILED)
+        {
+            close(Fd);
+            return ERR_FILE_ACCESS;
+        }
+
+        /* The image is always streamed front to back */
+        madvise(Data, (size_t)FileInfo.st_size, MADV_SEQUENTIAL);
+    }
+
+    /* The mapping stays valid after the descriptor is closed */
+    close(Fd);
+
+    File->Data = (const uint8_t*)Data;
+    File->Size = (uint32_t)FileInfo.st_size;
+
+    return 0;
+}
+
+void DLPC_COMMON_UnmapFile(DLPC_COMMON_MappedFile_s* File)
+{
+    if (File->Data != NULL)
+    {
+        munmap((void*)File->Data, File->Size);
+    }
+
+    File->Data = NULL;
+    File->Size = 0;
+}
+
+uint64_t DLPC_COMMON_GetTimeInMicroseconds()
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+
+    return ((uint64_t)Now.tv_sec * 1000000) + ((uint64_t)Now.tv_nsec / 1000);
+}
+
+void DLPC_COMMON_SleepMilliseconds(uint32_t Milliseconds)
+{
+    struct timespec Delay;
+
+    Delay.tv_sec  = Milliseconds / 1000;
+    Delay.tv_nsec = (long)(Milliseconds % 1000) * 1000000;
+    nanosleep(&Delay, NULL);
+}
+
+static void* RunThread(void* Argument)
+{
+    DLPC_COMMON_Thread_s* Thread = (DLPC_COMMON_Thread_s*)Argument;
+
+    Thread->Status = Thread->Function(Thread->Argument);
+    return NULL;
+}
+
+uint32_t DLPC_COMMON_CreateThread(DLPC_COMMON_ThreadFunction Function,
+                                  void*                      Argument,
+                                  DLPC_COMMON_Thread_s*      Thread)
+{
+    pthread_t Handle;
+
+    Thread->Function = Function;
+    Thread->Argument = Argument;
+    Thread->Status   = 0;
+
+    if (pthread_create(&Handle, NULL, RunThread, Thread) != 0)
+    {
+        return ERR_THREAD_CREATE;
+    }
+
+    Thread->Handle = (uintptr_t)Handle;
+    return 0;
+}
+
+uint32_t DLPC_COMMON_JoinThread(DLPC_COMMON_Thread_s* Thread)
+{
+    pthread_join((pthread_t)Thread->Handle, NULL);
+
+    return Thread->Status;
+}
+
+uint32_t DLPC_COMMON_AtomicLoad(const volatile uint32_t* Value)
+{
+    return __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+}
+
+void DLPC_COMMON_AtomicStore(volatile uint32_t* Value, uint32_t NewValue)
+{
+    __atomic_store_n(Value, NewValue, __ATOMIC_RELEASE);
+}
+
+void DLPC_COMMON_MemoryFence()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
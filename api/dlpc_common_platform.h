@@ -0,0 +1,186 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Platform helpers shared by the command library helpers: read-only
+ *         file mapping, a monotonic clock and threads.
+ */
+
+#ifndef DLPC_COMMON_PLATFORM_H
+#define DLPC_COMMON_PLATFORM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdint.h"
+
+#define ERR_FILE_ACCESS                   300
+#define ERR_THREAD_CREATE                 301
+
+/**
+ * Storage class for variables that have one instance per thread
+ */
+#ifdef _MSC_VER
+#define DLPC_COMMON_THREAD_LOCAL          __declspec(thread)
+#else
+#define DLPC_COMMON_THREAD_LOCAL          __thread
+#endif
+
+/**
+ * The function run by a thread created with DLPC_COMMON_CreateThread
+ *
+ * \param[in] Argument  The argument given to DLPC_COMMON_CreateThread
+ *
+ * \return The thread status returned by DLPC_COMMON_JoinThread
+ */
+typedef uint32_t (*DLPC_COMMON_ThreadFunction)(void* Argument);
+
+/**
+ * A thread created with DLPC_COMMON_CreateThread
+ */
+typedef struct
+{
+    DLPC_COMMON_ThreadFunction Function;
+    void*                      Argument;
+
+    /** The value returned by Function, valid after DLPC_COMMON_JoinThread */
+    uint32_t                   Status;
+
+    /** Platform specific handle, do not modify */
+    uintptr_t                  Handle;
+} DLPC_COMMON_Thread_s;
+
+/**
+ * A file mapped read-only into memory
+ */
+typedef struct
+{
+    /** Start of the file content */
+    const uint8_t* Data;
+
+    /** Number of bytes in the file */
+    uint32_t       Size;
+
+    /** Platform specific handles, do not modify */
+    void*          FileHandle;
+    void*          MappingHandle;
+} DLPC_COMMON_MappedFile_s;
+
+/**
+ * Maps a file read-only into memory. The pages are loaded on demand by the
+ * operating system, so the file is never copied into an intermediate buffer.
+ * A mapping can be shared by any number of threads.
+ *
+ * \param[in]  FilePath  Path to the file
+ * \param[out] File      The mapped file
+ *
+ * \return 0 if successful, ERR_FILE_ACCESS otherwise
+ */
+uint32_t DLPC_COMMON_MapFile(const char* FilePath, DLPC_COMMON_MappedFile_s* File);
+
+/**
+ * Releases a mapping created by DLPC_COMMON_MapFile
+ *
+ * \param[in] File  The mapped file
+ */
+void DLPC_COMMON_UnmapFile(DLPC_COMMON_MappedFile_s* File);
+
+/**
+ * Gets the time of a monotonic clock. Only the difference between two values
+ * is meaningful.
+ *
+ * \return The time in microseconds
+ */
+uint64_t DLPC_COMMON_GetTimeInMicroseconds();
+
+/**
+ * Suspends the calling thread
+ *
+ * \param[in] Milliseconds  The time to sleep
+ */
+void DLPC_COMMON_SleepMilliseconds(uint32_t Milliseconds);
+
+/**
+ * Starts a thread running Function(Argument). The Thread structure must stay
+ * valid until DLPC_COMMON_JoinThread returns.
+ *
+ * \param[in]  Function  The thread function
+ * \param[in]  Argument  The argument passed to Function
+ * \param[out] Thread    The created thread
+ *
+ * \return 0 if successful, ERR_THREAD_CREATE otherwise
+ */
+uint32_t DLPC_COMMON_CreateThread(DLPC_COMMON_ThreadFunction Function,
+                                  void*                      Argument,
+                                  DLPC_COMMON_Thread_s*      Thread);
+
+/**
+ * Waits for a thread to finish and releases it
+ *
+ * \param[in] Thread  The thread
+ *
+ * \return The value returned by the thread function
+ */
+uint32_t DLPC_COMMON_JoinThread(DLPC_COMMON_Thread_s* Thread);
+
+/**
+ * Reads a value shared between threads. Memory accesses after the call are
+ * not moved before it.
+ *
+ * \param[in] Value  The shared value
+ *
+ * \return The value
+ */
+uint32_t DLPC_COMMON_AtomicLoad(const volatile uint32_t* Value);
+
+/**
+ * Writes a value shared between threads. Memory accesses before the call are
+ * not moved after it.
+ *
+ * \param[out] Value     The shared value
+ * \param[in]  NewValue  The value to write
+ */
+void DLPC_COMMON_AtomicStore(volatile uint32_t* Value, uint32_t NewValue);
+
+/**
+ * Keeps the memory accesses before the call from being moved after it, and
+ * those after it from being moved before it
+ */
+void DLPC_COMMON_MemoryFence();
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC_COMMON_PLATFORM_H */
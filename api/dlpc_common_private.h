@@ -202,6 +202,22 @@ void DLPC_COMMON_SetCommandDestination(uint16_t CommandDestination);
 */
 uint16_t DLPC_COMMON_GetBytesRead();
 
+/**
+* Gets the size of the write buffer given to DLPC_COMMON_InitCommandLibrary.
+* Helpers that stream bulk data use it to size their command payloads.
+*
+* \return The write buffer size in bytes
+*/
+uint16_t DLPC_COMMON_GetWriteBufferSize();
+
+/**
+* Gets the size of the read buffer given to DLPC_COMMON_InitCommandLibrary.
+* Helpers that stream bulk data use it to size their read requests.
+*
+* \return The read buffer size in bytes
+*/
+uint16_t DLPC_COMMON_GetReadBufferSize();
+
 #ifdef __cplusplus    /* matches __cplusplus construct above */
 }
 #endif
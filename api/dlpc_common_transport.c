@@ -0,0 +1,347 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the transport interface.
+ */
+
+#include "dlpc_common_transport.h"
+#include "dlpc_common_platform.h"
+#include "stddef.h"
+#include "string.h"
+
+/* Used by command contexts without a transport in their UserData */
+static DLPC_COMMON_Transport_s* s_DefaultTransport;
+
+static DLPC_COMMON_Transport_s* GetContextTransport(DLPC_COMMON_CommandContext_s* Context)
+{
+    return (Context->UserData != NULL) ? (DLPC_COMMON_Transport_s*)Context->UserData : s_DefaultTransport;
+}
+
+void DLPC_COMMON_InitTransport(DLPC_COMMON_Transport_s*          Transport,
+                               const DLPC_COMMON_TransportOps_s* Ops,
+                               void*                             Data)
+{
+    memset(Transport, 0, sizeof(*Transport));
+
+    Transport->Ops  = Ops;
+    Transport->Data = Data;
+}
+
+uint32_t DLPC_COMMON_OpenTransport(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+    uint32_t Status;
+
+    if (Transport->IsOpen)
+    {
+        DLPC_COMMON_CloseTransport(Transport);
+    }
+
+    Transport->MaxTransferSize = 0;
+    Transport->Capabilities    = 0;
+
+    Status = Transport->Ops->Open(Transport, Address);
+    Transport->IsOpen = (Status == 0);
+
+    return Status;
+}
+
+void DLPC_COMMON_CloseTransport(DLPC_COMMON_Transport_s* Transport)
+{
+    if (!Transport->IsOpen)
+    {
+        return;
+    }
+
+    DLPC_COMMON_FlushTransport(Transport);
+    Transport->Ops->Close(Transport);
+    Transport->IsOpen = false;
+}
+
+bool DLPC_COMMON_HasTransportCapability(const DLPC_COMMON_Transport_s* Transport, uint32_t Capabilities)
+{
+    return (Transport->Capabilities & Capabilities) == Capabilities;
+}
+
+uint32_t DLPC_COMMON_SubmitTransportWrite(DLPC_COMMON_Transport_s*        Transport,
+                                          uint16_t                        WriteLength,
+                                          const uint8_t*                  WriteData,
+                                          DLPC_COMMON_TransportCompletion Completion,
+                                          void*                           CallbackData)
+{
+    uint32_t Status;
+
+    if (!Transport->IsOpen)
+    {
+        return ERR_TRANSPORT_NOT_OPEN;
+    }
+
+    if ((Transport->MaxTransferSize > 0) && (WriteLength > Transport->MaxTransferSize))
+    {
+        return ERR_TRANSPORT_TOO_LONG;
+    }
+
+    if (DLPC_COMMON_HasTransportCapability(Transport, DLPC_COMMON_TRANSPORT_CAP_ASYNC))
+    {
+        return Transport->Ops->SubmitWrite(Transport, WriteLength, WriteData, Completion, CallbackData);
+    }
+
+    Status = Transport->Ops->Write(Transport, WriteLength, WriteData);
+    if (Completion != NULL)
+    {
+        Completion(Status, CallbackData);
+    }
+
+    return Status;
+}
+
+uint32_t DLPC_COMMON_FlushTransport(DLPC_COMMON_Transport_s* Transport)
+{
+    if (!Transport->IsOpen || !DLPC_COMMON_HasTransportCapability(Transport, DLPC_COMMON_TRANSPORT_CAP_ASYNC))
+    {
+        return 0;
+    }
+
+    return Transport->Ops->Flush(Transport);
+}
+
+void DLPC_COMMON_InitRetryPolicy(DLPC_COMMON_RetryPolicy_s* Policy,
+                                 uint32_t                   MaxAttempts,
+                                 uint32_t                   BaseDelayMilliseconds,
+                                 uint32_t                   MaxDelayMilliseconds)
+{
+    memset(Policy, 0, sizeof(*Policy));
+
+    Policy->MaxAttempts           = MaxAttempts;
+    Policy->BaseDelayMilliseconds = BaseDelayMilliseconds;
+    Policy->MaxDelayMilliseconds  = MaxDelayMilliseconds;
+}
+
+void DLPC_COMMON_SetRetrySafe(DLPC_COMMON_RetryPolicy_s* Policy, uint8_t Opcode, uint8_t Flags)
+{
+    Policy->OpcodeFlags[Opcode] = Flags;
+}
+
+void DLPC_COMMON_SetTransportRetryPolicy(DLPC_COMMON_Transport_s*         Transport,
+                                         const DLPC_COMMON_RetryPolicy_s* Policy)
+{
+    Transport->RetryPolicy = Policy;
+}
+
+static uint32_t GetJitter(DLPC_COMMON_Transport_s* Transport)
+{
+    /* xorshift32, seeded from the clock on first use */
+    uint32_t X = Transport->JitterState;
+
+    if (X == 0)
+    {
+        X = (uint32_t)DLPC_COMMON_GetTimeInMicroseconds() | 1;
+    }
+
+    X ^= X << 13;
+    X ^= X >> 17;
+    X ^= X << 5;
+
+    Transport->JitterState = X;
+    return X;
+}
+
+/*
+ * Counts the result of an attempt to send a command and decides whether to
+ * send it again. Waits for the backoff delay before returning true.
+ */
+static bool RetryCommand(DLPC_COMMON_Transport_s* Transport,
+                         uint32_t                 Status,
+                         const uint8_t*           WriteBuffer,
+                         uint8_t                  SafeFlag,
+                         uint32_t                 Attempt)
+{
+    const DLPC_COMMON_RetryPolicy_s*   Policy     = Transport->RetryPolicy;
+    DLPC_COMMON_TransportStatistics_s* Statistics = &Transport->Statistics;
+    uint32_t                           Delay;
+
+    if (Status == 0)
+    {
+        if (Attempt > 1)
+        {
+            Statistics->RecoveredCommands++;
+        }
+        return false;
+    }
+
+    if (Status != ERR_TRANSPORT_IO)
+    {
+        Statistics->FatalErrors++;
+        return false;
+    }
+
+    Statistics->TransientErrors++;
+
+    if ((Policy == NULL) || (Attempt >= Policy->MaxAttempts))
+    {
+        return false;
+    }
+
+    if ((Policy->OpcodeFlags[WriteBuffer[0]] & SafeFlag) == 0)
+    {
+        Statistics->UnsafeFailures++;
+        return false;
+    }
+
+    Delay = Policy->MaxDelayMilliseconds;
+    if ((Attempt < 16) && ((Policy->BaseDelayMilliseconds << (Attempt - 1)) < Delay))
+    {
+        Delay = Policy->BaseDelayMilliseconds << (Attempt - 1);
+    }
+
+    if (Delay > 0)
+    {
+        DLPC_COMMON_SleepMilliseconds(Delay / 2 + GetJitter(Transport) % (Delay / 2 + 1));
+    }
+
+    Statistics->Retries++;
+    return true;
+}
+
+void DLPC_COMMON_SetDefaultTransport(DLPC_COMMON_Transport_s* Transport)
+{
+    s_DefaultTransport = Transport;
+}
+
+DLPC_COMMON_Transport_s* DLPC_COMMON_GetCommandTransport()
+{
+    return GetContextTransport(DLPC_COMMON_GetCommandContext());
+}
+
+void DLPC_COMMON_InitTransportContext(DLPC_COMMON_CommandContext_s* Context,
+                                      DLPC_COMMON_Transport_s*      Transport,
+                                      uint8_t*                      WriteBuffer,
+                                      uint16_t                      WriteBufferSize,
+                                      uint8_t*                      ReadBuffer,
+                                      uint16_t                      ReadBufferSize)
+{
+    DLPC_COMMON_InitCommandContext(Context,
+                                   WriteBuffer,
+                                   WriteBufferSize,
+                                   ReadBuffer,
+                                   ReadBufferSize,
+                                   DLPC_COMMON_TransportWriteCommand,
+                                   DLPC_COMMON_TransportReadCommand,
+                                   Transport);
+}
+
+uint32_t DLPC_COMMON_TransportWriteCommand(uint16_t                           WriteLength,
+                                           uint8_t*                           WriteBuffer,
+                                           DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_Transport_s* Transport = GetContextTransport(DLPC_COMMON_GetCommandContext());
+    uint32_t                 Attempt;
+    uint32_t                 Status;
+
+    if ((Transport == NULL) || !Transport->IsOpen)
+    {
+        return ERR_TRANSPORT_NOT_OPEN;
+    }
+
+    if ((Transport->MaxTransferSize > 0) && (WriteLength > Transport->MaxTransferSize))
+    {
+        return ERR_TRANSPORT_TOO_LONG;
+    }
+
+    /* Commands must reach the controller in order */
+    Status = DLPC_COMMON_FlushTransport(Transport);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    Transport->Statistics.Commands++;
+    Attempt = 1;
+    do
+    {
+        Status = Transport->Ops->Write(Transport, WriteLength, WriteBuffer);
+    } while (RetryCommand(Transport, Status, WriteBuffer, DLPC_COMMON_RETRY_SAFE_WRITE, Attempt++));
+
+    return Status;
+}
+
+uint32_t DLPC_COMMON_TransportReadCommand(uint16_t                           WriteLength,
+                                          uint8_t*                           WriteBuffer,
+                                          uint16_t                           ReadLength,
+                                          uint8_t*                           ReadBuffer,
+                                          DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+    DLPC_COMMON_CommandContext_s* Context   = DLPC_COMMON_GetCommandContext();
+    DLPC_COMMON_Transport_s*      Transport = GetContextTransport(Context);
+    uint16_t                      BytesRead;
+    uint32_t                      Attempt;
+    uint32_t                      Status;
+
+    if ((Transport == NULL) || !Transport->IsOpen)
+    {
+        return ERR_TRANSPORT_NOT_OPEN;
+    }
+
+    if ((Transport->MaxTransferSize > 0) && (WriteLength > Transport->MaxTransferSize))
+    {
+        return ERR_TRANSPORT_TOO_LONG;
+    }
+
+    Status = DLPC_COMMON_FlushTransport(Transport);
+    if (Status != 0)
+    {
+        return Status;
+    }
+
+    /* A variable length response is read up to the size of the read buffer */
+    if (ReadLength == 0xFFFF)
+    {
+        ReadLength = Context->ReadBufferSize;
+    }
+
+    Transport->Statistics.Commands++;
+    Attempt = 1;
+    do
+    {
+        BytesRead = ReadLength;
+        Status    = Transport->Ops->WriteRead(Transport, WriteLength, WriteBuffer, ReadLength, ReadBuffer, &BytesRead);
+    } while (RetryCommand(Transport, Status, WriteBuffer, DLPC_COMMON_RETRY_SAFE_READ, Attempt++));
+
+    if (Status == 0)
+    {
+        ProtocolData->BytesRead = BytesRead;
+    }
+
+    return Status;
+}
@@ -0,0 +1,328 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Transport interface. A transport moves command bytes between the
+ *         command library and a controller, e.g. over a USB-I2C bridge or a
+ *         native I2C bus. Any transport can drive a command context through
+ *         DLPC_COMMON_InitTransportContext.
+ */
+
+#ifndef DLPC_COMMON_TRANSPORT_H
+#define DLPC_COMMON_TRANSPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "dlpc_common.h"
+
+#define ERR_TRANSPORT_OPEN                320
+#define ERR_TRANSPORT_IO                  321
+#define ERR_TRANSPORT_TOO_LONG            322
+#define ERR_TRANSPORT_NOT_OPEN            323
+#define ERR_TRANSPORT_FATAL               324
+
+/*
+ * ERR_TRANSPORT_IO is a transient error, the command may succeed when sent
+ * again. ERR_TRANSPORT_FATAL means the device is gone or unusable.
+ */
+
+/** WriteRead is a single transaction with a repeated start */
+#define DLPC_COMMON_TRANSPORT_CAP_COMBINED_WRITE_READ  0x01
+
+/** SubmitWrite queues writes and returns before they complete */
+#define DLPC_COMMON_TRANSPORT_CAP_ASYNC                0x02
+
+/** The controller bus must be acquired before use, see DLPC_COMMON_SetBusCallbacks */
+#define DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION      0x04
+
+/** The command may be written again after a transient error */
+#define DLPC_COMMON_RETRY_SAFE_WRITE                   0x01
+
+/** The command may be read again after a transient error */
+#define DLPC_COMMON_RETRY_SAFE_READ                    0x02
+
+/**
+ * How the command callbacks retry commands after transient errors. A command
+ * is only retried when the flag for its opcode (the first command byte)
+ * allows it, so commands with side effects, such as a flash write that
+ * advances the flash address, are never repeated by accident.
+ */
+typedef struct
+{
+    /** Attempts per command including the first, 1 disables retries */
+    uint32_t MaxAttempts;
+
+    /**
+     * The delay before the n-th retry is BaseDelayMilliseconds << (n - 1),
+     * at most MaxDelayMilliseconds. A random half of it is skipped to spread
+     * out retries of devices sharing a bus.
+     */
+    uint32_t BaseDelayMilliseconds;
+    uint32_t MaxDelayMilliseconds;
+
+    /** DLPC_COMMON_RETRY_SAFE_* flags of each opcode */
+    uint8_t  OpcodeFlags[256];
+} DLPC_COMMON_RetryPolicy_s;
+
+/** Counts of the commands sent through a transport */
+typedef struct
+{
+    uint32_t Commands;
+    uint32_t TransientErrors;
+    uint32_t FatalErrors;
+    uint32_t Retries;
+
+    /** Commands that succeeded after a retry */
+    uint32_t RecoveredCommands;
+
+    /** Transient errors not retried because the opcode is not retry safe */
+    uint32_t UnsafeFailures;
+} DLPC_COMMON_TransportStatistics_s;
+
+struct DLPC_COMMON_Transport;
+
+/**
+ * Called when a write submitted with SubmitWrite completes
+ *
+ * \param[in] Status        0 if the write succeeded, error code otherwise
+ * \param[in] CallbackData  The CallbackData passed to SubmitWrite
+ */
+typedef void (*DLPC_COMMON_TransportCompletion)(uint32_t Status, void* CallbackData);
+
+/**
+ * The operations of a transport backend. Write and WriteRead are required,
+ * SubmitWrite and Flush are only used when the transport has the
+ * DLPC_COMMON_TRANSPORT_CAP_ASYNC capability.
+ */
+typedef struct
+{
+    const char* Name;
+
+    /**
+     * Opens the transport. The backend sets MaxTransferSize and Capabilities.
+     * The format of Address is defined by the backend; NULL selects the
+     * first device found.
+     */
+    uint32_t (*Open)(struct DLPC_COMMON_Transport* Transport, const char* Address);
+    void     (*Close)(struct DLPC_COMMON_Transport* Transport);
+
+    uint32_t (*Write)(struct DLPC_COMMON_Transport* Transport,
+                      uint16_t                      WriteLength,
+                      const uint8_t*                WriteData);
+
+    /**
+     * Writes a request and reads the response. BytesRead returns the
+     * number of bytes read. For a variable length response it may be less
+     * than ReadLength, which is then the size of the read buffer.
+     */
+    uint32_t (*WriteRead)(struct DLPC_COMMON_Transport* Transport,
+                          uint16_t                      WriteLength,
+                          const uint8_t*                WriteData,
+                          uint16_t                      ReadLength,
+                          uint8_t*                      ReadData,
+                          uint16_t*                     BytesRead);
+
+    uint32_t (*SubmitWrite)(struct DLPC_COMMON_Transport*   Transport,
+                            uint16_t                        WriteLength,
+                            const uint8_t*                  WriteData,
+                            DLPC_COMMON_TransportCompletion Completion,
+                            void*                           CallbackData);
+
+    /** Waits for all submitted writes, returns the first error */
+    uint32_t (*Flush)(struct DLPC_COMMON_Transport* Transport);
+} DLPC_COMMON_TransportOps_s;
+
+typedef struct DLPC_COMMON_Transport
+{
+    const DLPC_COMMON_TransportOps_s* Ops;
+
+    /** Backend state, owned by the caller */
+    void*                             Data;
+
+    /** Largest write the transport carries in one transaction, 0 if unlimited */
+    uint32_t                          MaxTransferSize;
+
+    /** DLPC_COMMON_TRANSPORT_CAP_* flags */
+    uint32_t                          Capabilities;
+
+    bool                              IsOpen;
+
+    /** Retry policy of the command callbacks, NULL to never retry */
+    const DLPC_COMMON_RetryPolicy_s*  RetryPolicy;
+    uint32_t                          JitterState;
+
+    DLPC_COMMON_TransportStatistics_s Statistics;
+} DLPC_COMMON_Transport_s;
+
+/**
+ * Initializes a transport with a backend
+ *
+ * \param[out] Transport  The transport
+ * \param[in]  Ops        The backend operations, e.g. LINUX_I2C_TransportOps
+ * \param[in]  Data       The backend state, see the backend for its type.
+ *                        Some backends accept NULL.
+ */
+void DLPC_COMMON_InitTransport(DLPC_COMMON_Transport_s*          Transport,
+                               const DLPC_COMMON_TransportOps_s* Ops,
+                               void*                             Data);
+
+/**
+ * Opens a transport
+ *
+ * \param[in] Transport  The transport
+ * \param[in] Address    The device to open, see the backend for its format
+ *
+ * \return 0 if successful, error code of the backend otherwise
+ */
+uint32_t DLPC_COMMON_OpenTransport(DLPC_COMMON_Transport_s* Transport, const char* Address);
+
+void DLPC_COMMON_CloseTransport(DLPC_COMMON_Transport_s* Transport);
+
+/**
+ * Checks if a transport has all the given capabilities
+ */
+bool DLPC_COMMON_HasTransportCapability(const DLPC_COMMON_Transport_s* Transport, uint32_t Capabilities);
+
+/**
+ * Submits a write without waiting for it when the transport is asynchronous,
+ * otherwise writes it and calls Completion before returning
+ *
+ * \param[in] Transport     The transport
+ * \param[in] WriteLength   Number of bytes to write
+ * \param[in] WriteData     The bytes to write. Must stay valid until the write
+ *                          completes.
+ * \param[in] Completion    Called when the write completes. May be NULL.
+ * \param[in] CallbackData  Passed to Completion
+ *
+ * \return 0 if the write was submitted, error code otherwise
+ */
+uint32_t DLPC_COMMON_SubmitTransportWrite(DLPC_COMMON_Transport_s*        Transport,
+                                          uint16_t                        WriteLength,
+                                          const uint8_t*                  WriteData,
+                                          DLPC_COMMON_TransportCompletion Completion,
+                                          void*                           CallbackData);
+
+/**
+ * Waits for all writes submitted to a transport
+ *
+ * \return 0 if all writes succeeded, the first error otherwise
+ */
+uint32_t DLPC_COMMON_FlushTransport(DLPC_COMMON_Transport_s* Transport);
+
+/**
+ * Initializes a retry policy that allows MaxAttempts attempts but has no
+ * retry safe opcodes
+ */
+void DLPC_COMMON_InitRetryPolicy(DLPC_COMMON_RetryPolicy_s* Policy,
+                                 uint32_t                   MaxAttempts,
+                                 uint32_t                   BaseDelayMilliseconds,
+                                 uint32_t                   MaxDelayMilliseconds);
+
+/**
+ * Sets the DLPC_COMMON_RETRY_SAFE_* flags of a command opcode
+ */
+void DLPC_COMMON_SetRetrySafe(DLPC_COMMON_RetryPolicy_s* Policy, uint8_t Opcode, uint8_t Flags);
+
+/**
+ * Sets the retry policy of a transport. The policy is not copied and must
+ * stay valid while the transport is used.
+ */
+void DLPC_COMMON_SetTransportRetryPolicy(DLPC_COMMON_Transport_s*         Transport,
+                                         const DLPC_COMMON_RetryPolicy_s* Policy);
+
+/**
+ * Initializes a command context that sends its commands through a transport.
+ * The UserData of the context is the transport.
+ *
+ * \param[out] Context          The command context
+ * \param[in]  Transport        The transport, opened or to be opened before
+ *                              the first command
+ * \param[in]  WriteBuffer      The write buffer
+ * \param[in]  WriteBufferSize  The write buffer size in bytes
+ * \param[in]  ReadBuffer       The read buffer
+ * \param[in]  ReadBufferSize   The read buffer size in bytes
+ */
+void DLPC_COMMON_InitTransportContext(DLPC_COMMON_CommandContext_s* Context,
+                                      DLPC_COMMON_Transport_s*      Transport,
+                                      uint8_t*                      WriteBuffer,
+                                      uint16_t                      WriteBufferSize,
+                                      uint8_t*                      ReadBuffer,
+                                      uint16_t                      ReadBufferSize);
+
+/**
+ * Sets the transport used by the command callbacks when the UserData of the
+ * current command context is NULL, such as the default context set up by
+ * DLPC_COMMON_InitCommandLibrary:
+ *
+ *     DLPC_COMMON_SetDefaultTransport(&Transport);
+ *     DLPC_COMMON_InitCommandLibrary(WriteBuffer, sizeof(WriteBuffer),
+ *                                    ReadBuffer, sizeof(ReadBuffer),
+ *                                    DLPC_COMMON_TransportWriteCommand,
+ *                                    DLPC_COMMON_TransportReadCommand);
+ *
+ * \param[in] Transport  The transport, NULL to clear
+ */
+void DLPC_COMMON_SetDefaultTransport(DLPC_COMMON_Transport_s* Transport);
+
+/**
+ * Gets the transport used by the command callbacks for the current command
+ * context
+ *
+ * \return The transport, NULL if there is none
+ */
+DLPC_COMMON_Transport_s* DLPC_COMMON_GetCommandTransport();
+
+/**
+ * Command callbacks that use the transport in the UserData of the current
+ * command context, or the default transport. Commands failing with ERR_TRANSPORT_IO are retried
+ * according to the retry policy of the transport.
+ */
+uint32_t DLPC_COMMON_TransportWriteCommand(uint16_t                           WriteLength,
+                                           uint8_t*                           WriteBuffer,
+                                           DLPC_COMMON_CommandProtocolData_s* ProtocolData);
+
+uint32_t DLPC_COMMON_TransportReadCommand(uint16_t                           WriteLength,
+                                          uint8_t*                           WriteBuffer,
+                                          uint16_t                           ReadLength,
+                                          uint8_t*                           ReadBuffer,
+                                          DLPC_COMMON_CommandProtocolData_s* ProtocolData);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC_COMMON_TRANSPORT_H */
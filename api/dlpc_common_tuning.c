@@ -0,0 +1,208 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the run-time tuning of transfer parameters.
+ */
+
+#include "dlpc_common_tuning.h"
+#include "dlpc_common_platform.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define MAX_TUNING_FILE_LINES             64
+#define MAX_TUNING_KEY_LENGTH             128
+
+void DLPC_COMMON_InitBlockSizeTuner(DLPC_COMMON_BlockSizeTuner_s* Tuner,
+                                    uint16_t                      MinBlockSize,
+                                    uint16_t                      MaxBlockSize,
+                                    uint16_t                      Alignment)
+{
+    uint32_t BlockSize;
+
+    memset(Tuner, 0, sizeof(*Tuner));
+
+    if (Alignment == 0)
+    {
+        Alignment = 1;
+    }
+    MaxBlockSize = (uint16_t)(MaxBlockSize - (MaxBlockSize % Alignment));
+    if (MinBlockSize < Alignment)
+    {
+        MinBlockSize = Alignment;
+    }
+
+    for (BlockSize = 1;
+         (BlockSize < MaxBlockSize) && (Tuner->CandidateCount < (DLPC_COMMON_TUNER_MAX_CANDIDATES - 1));
+         BlockSize *= 2)
+    {
+        if ((BlockSize >= MinBlockSize) && ((BlockSize % Alignment) == 0))
+        {
+            Tuner->Candidates[Tuner->CandidateCount++] = (uint16_t)BlockSize;
+        }
+    }
+
+    if (MaxBlockSize > 0)
+    {
+        Tuner->Candidates[Tuner->CandidateCount++] = MaxBlockSize;
+    }
+
+    /* Fall back to the largest block until a measurement says otherwise */
+    Tuner->BestBlockSize = MaxBlockSize;
+}
+
+bool DLPC_COMMON_IsTunerDone(DLPC_COMMON_BlockSizeTuner_s* Tuner)
+{
+    return Tuner->CandidateIndex >= Tuner->CandidateCount;
+}
+
+uint16_t DLPC_COMMON_GetTunerBlockSize(DLPC_COMMON_BlockSizeTuner_s* Tuner)
+{
+    if (DLPC_COMMON_IsTunerDone(Tuner))
+    {
+        return Tuner->BestBlockSize;
+    }
+
+    if (Tuner->BytesInTrial == 0)
+    {
+        Tuner->TrialStartTime = DLPC_COMMON_GetTimeInMicroseconds();
+    }
+
+    return Tuner->Candidates[Tuner->CandidateIndex];
+}
+
+void DLPC_COMMON_UpdateBlockSizeTuner(DLPC_COMMON_BlockSizeTuner_s* Tuner, uint16_t BytesSent)
+{
+    uint64_t ElapsedTime;
+    double   BytesPerSecond;
+
+    if (DLPC_COMMON_IsTunerDone(Tuner))
+    {
+        return;
+    }
+
+    Tuner->BytesInTrial += BytesSent;
+    if (Tuner->BytesInTrial < DLPC_COMMON_TUNER_TRIAL_BYTES)
+    {
+        return;
+    }
+
+    ElapsedTime    = DLPC_COMMON_GetTimeInMicroseconds() - Tuner->TrialStartTime;
+    BytesPerSecond = (Tuner->BytesInTrial * 1000000.0) / (ElapsedTime > 0 ? ElapsedTime : 1);
+
+    if (BytesPerSecond > Tuner->BestBytesPerSecond)
+    {
+        Tuner->BestBytesPerSecond = BytesPerSecond;
+        Tuner->BestBlockSize      = Tuner->Candidates[Tuner->CandidateIndex];
+    }
+
+    Tuner->CandidateIndex++;
+    Tuner->BytesInTrial = 0;
+}
+
+uint32_t DLPC_COMMON_LoadTunedValue(const char* FilePath, const char* Key, uint32_t* Value)
+{
+    char          LineKey[MAX_TUNING_KEY_LENGTH];
+    unsigned long LineValue;
+    uint32_t      Status = ERR_TUNING_VALUE_NOT_FOUND;
+    FILE*         File   = fopen(FilePath, "r");
+
+    if (File == NULL)
+    {
+        return ERR_TUNING_VALUE_NOT_FOUND;
+    }
+
+    while (fscanf(File, "%127s %lu", LineKey, &LineValue) == 2)
+    {
+        if (strcmp(LineKey, Key) == 0)
+        {
+            *Value = (uint32_t)LineValue;
+            Status = 0;
+        }
+    }
+
+    fclose(File);
+    return Status;
+}
+
+uint32_t DLPC_COMMON_SaveTunedValue(const char* FilePath, const char* Key, uint32_t Value)
+{
+    char          Keys[MAX_TUNING_FILE_LINES][MAX_TUNING_KEY_LENGTH];
+    unsigned long Values[MAX_TUNING_FILE_LINES];
+    char          LineKey[MAX_TUNING_KEY_LENGTH];
+    unsigned long LineValue;
+    uint32_t      Count = 0;
+    uint32_t      Index;
+    FILE*         File;
+
+    /* Keep the values of the other keys, the new key takes one more line */
+    File = fopen(FilePath, "r");
+    if (File != NULL)
+    {
+        while (fscanf(File, "%127s %lu", LineKey, &LineValue) == 2)
+        {
+            if (strcmp(LineKey, Key) == 0)
+            {
+                continue;
+            }
+
+            if (Count >= (MAX_TUNING_FILE_LINES - 1))
+            {
+                fclose(File);
+                return ERR_TUNING_FILE_FULL;
+            }
+
+            strcpy(Keys[Count], LineKey);
+            Values[Count] = LineValue;
+            Count++;
+        }
+        fclose(File);
+    }
+
+    File = fopen(FilePath, "w");
+    if (File == NULL)
+    {
+        return ERR_FILE_ACCESS;
+    }
+
+    for (Index = 0; Index < Count; Index++)
+    {
+        fprintf(File, "%s %lu\n", Keys[Index], Values[Index]);
+    }
+    fprintf(File, "%s %lu\n", Key, (unsigned long)Value);
+
+    fclose(File);
+    return 0;
+}
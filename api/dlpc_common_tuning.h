@@ -0,0 +1,148 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Run-time tuning of transfer parameters. Provides a block size tuner
+ *         for bulk flash transfers and a small store that persists tuned
+ *         values per adapter/controller pair.
+ */
+
+#ifndef DLPC_COMMON_TUNING_H
+#define DLPC_COMMON_TUNING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+
+#define ERR_TUNING_VALUE_NOT_FOUND        310
+#define ERR_TUNING_FILE_FULL              311
+
+#define DLPC_COMMON_TUNER_MAX_CANDIDATES  12
+
+/** Minimum number of bytes timed for each candidate block size */
+#define DLPC_COMMON_TUNER_TRIAL_BYTES     4096
+
+/**
+ * Times a sequence of block transfers with different block sizes and picks
+ * the size with the highest throughput. The trials are run on the data that
+ * is being transferred anyway, so tuning costs no extra transfers.
+ */
+typedef struct
+{
+    uint16_t Candidates[DLPC_COMMON_TUNER_MAX_CANDIDATES];
+    uint8_t  CandidateCount;
+    uint8_t  CandidateIndex;
+    uint32_t BytesInTrial;
+    uint64_t TrialStartTime;
+    uint16_t BestBlockSize;
+    double   BestBytesPerSecond;
+} DLPC_COMMON_BlockSizeTuner_s;
+
+/**
+ * Initializes the tuner with the candidate block sizes: the powers of two
+ * between MinBlockSize and MaxBlockSize, and MaxBlockSize itself.
+ *
+ * \param[in] Tuner         The tuner
+ * \param[in] MinBlockSize  The smallest block size to try
+ * \param[in] MaxBlockSize  The largest block size the transport and the
+ *                          controller accept
+ * \param[in] Alignment     All candidates are multiples of this value
+ */
+void DLPC_COMMON_InitBlockSizeTuner(DLPC_COMMON_BlockSizeTuner_s* Tuner,
+                                    uint16_t                      MinBlockSize,
+                                    uint16_t                      MaxBlockSize,
+                                    uint16_t                      Alignment);
+
+/**
+ * Gets the block size to use for the next transfer. Once all candidates have
+ * been timed, the best block size is returned.
+ *
+ * \param[in] Tuner  The tuner
+ *
+ * \return The block size in bytes
+ */
+uint16_t DLPC_COMMON_GetTunerBlockSize(DLPC_COMMON_BlockSizeTuner_s* Tuner);
+
+/**
+ * Records a completed block transfer
+ *
+ * \param[in] Tuner      The tuner
+ * \param[in] BytesSent  Number of bytes in the block
+ */
+void DLPC_COMMON_UpdateBlockSizeTuner(DLPC_COMMON_BlockSizeTuner_s* Tuner, uint16_t BytesSent);
+
+/**
+ * Checks if all candidate block sizes have been timed
+ *
+ * \param[in] Tuner  The tuner
+ *
+ * \return true if tuning is complete
+ */
+bool DLPC_COMMON_IsTunerDone(DLPC_COMMON_BlockSizeTuner_s* Tuner);
+
+/**
+ * Loads a tuned value from a tuning file. Each line of the file holds a key
+ * and a value separated by a space. Keys are chosen by the caller, typically
+ * "<adapter>/<controller>/<parameter>".
+ *
+ * \param[in]  FilePath  Path to the tuning file
+ * \param[in]  Key       The key of the value. Must not contain spaces.
+ * \param[out] Value     The stored value
+ *
+ * \return 0 if successful, ERR_TUNING_VALUE_NOT_FOUND otherwise
+ */
+uint32_t DLPC_COMMON_LoadTunedValue(const char* FilePath, const char* Key, uint32_t* Value);
+
+/**
+ * Stores a tuned value in a tuning file, replacing any previous value of the
+ * same key. A tuning file holds up to 64 keys; the file is left unchanged
+ * when a new key does not fit.
+ *
+ * \param[in] FilePath  Path to the tuning file
+ * \param[in] Key       The key of the value. Must not contain spaces.
+ * \param[in] Value     The value to store
+ *
+ * \return 0                    if successful
+ *         ERR_TUNING_FILE_FULL if the file already holds 64 other keys
+ *         ERR_FILE_ACCESS      if the file could not be written
+ */
+uint32_t DLPC_COMMON_SaveTunedValue(const char* FilePath, const char* Key, uint32_t Value);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* DLPC_COMMON_TUNING_H */
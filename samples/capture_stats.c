@@ -0,0 +1,198 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Prints per-opcode timing summaries of a capture file recorded with
+ *         DLPC_COMMON_StartCapture.
+ *
+ * Usage: capture_stats <capture file>
+ *
+ * Transactions are grouped by type, command destination and opcode (the
+ * first command byte), and listed by total time.
+ */
+
+#include "dlpc_common_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_OPCODE_SUMMARIES 1024
+
+typedef struct
+{
+    uint8_t  Type;
+    uint16_t Destination;
+    uint8_t  Opcode;
+
+    uint32_t Count;
+    uint32_t Errors;
+    uint64_t TotalMicroseconds;
+    uint32_t MinMicroseconds;
+    uint32_t MaxMicroseconds;
+    uint64_t BytesWritten;
+    uint64_t BytesRead;
+} OpcodeSummary_s;
+
+static OpcodeSummary_s s_Summaries[MAX_OPCODE_SUMMARIES];
+static uint32_t        s_NumSummaries;
+
+static OpcodeSummary_s* GetSummary(const DLPC_COMMON_CaptureRecord_s* Record, uint8_t Opcode)
+{
+    OpcodeSummary_s* Summary;
+    uint32_t         Index;
+
+    for (Index = 0; Index < s_NumSummaries; Index++)
+    {
+        Summary = &s_Summaries[Index];
+        if ((Summary->Type == Record->Type) && (Summary->Destination == Record->Destination) && (Summary->Opcode == Opcode))
+        {
+            return Summary;
+        }
+    }
+
+    if (s_NumSummaries == MAX_OPCODE_SUMMARIES)
+    {
+        return NULL;
+    }
+
+    Summary = &s_Summaries[s_NumSummaries++];
+    memset(Summary, 0, sizeof(*Summary));
+    Summary->Type            = Record->Type;
+    Summary->Destination     = Record->Destination;
+    Summary->Opcode          = Opcode;
+    Summary->MinMicroseconds = UINT32_MAX;
+
+    return Summary;
+}
+
+static int CompareTotalTime(const void* A, const void* B)
+{
+    const OpcodeSummary_s* SummaryA = (const OpcodeSummary_s*)A;
+    const OpcodeSummary_s* SummaryB = (const OpcodeSummary_s*)B;
+
+    if (SummaryA->TotalMicroseconds != SummaryB->TotalMicroseconds)
+    {
+        return (SummaryA->TotalMicroseconds > SummaryB->TotalMicroseconds) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    DLPC_COMMON_Replay_s               Replay;
+    const DLPC_COMMON_CaptureRecord_s* Record;
+    const uint8_t*                     WriteData;
+    const uint8_t*                     ReadData;
+    OpcodeSummary_s*                   Summary;
+    uint64_t                           BusMicroseconds = 0;
+    uint64_t                           EndMicroseconds = 0;
+    uint32_t                           NumRecords      = 0;
+    uint32_t                           Status;
+    uint32_t                           Index;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <capture file>\n", argv[0]);
+        return 1;
+    }
+
+    Status = DLPC_COMMON_OpenReplay(&Replay, argv[1]);
+    if (Status != 0)
+    {
+        printf("Could not read %s, error %u\n", argv[1], Status);
+        return 1;
+    }
+
+    while (DLPC_COMMON_NextCaptureRecord(&Replay, &Record, &WriteData, &ReadData))
+    {
+        NumRecords++;
+        BusMicroseconds += Record->DurationMicroseconds;
+        EndMicroseconds  = Record->TimeMicroseconds + Record->DurationMicroseconds;
+
+        Summary = GetSummary(Record, (Record->WriteLength > 0) ? WriteData[0] : 0);
+        if (Summary == NULL)
+        {
+            continue;
+        }
+
+        Summary->Count++;
+        Summary->Errors            += (Record->Status != 0) ? 1 : 0;
+        Summary->TotalMicroseconds += Record->DurationMicroseconds;
+        Summary->BytesWritten      += Record->WriteLength;
+        Summary->BytesRead         += Record->ReadLength;
+
+        if (Record->DurationMicroseconds < Summary->MinMicroseconds)
+        {
+            Summary->MinMicroseconds = Record->DurationMicroseconds;
+        }
+        if (Record->DurationMicroseconds > Summary->MaxMicroseconds)
+        {
+            Summary->MaxMicroseconds = Record->DurationMicroseconds;
+        }
+    }
+
+    if (Replay.Offset != Replay.File.Size)
+    {
+        printf("Warning: %s ends with a truncated record\n", argv[1]);
+    }
+
+    qsort(s_Summaries, s_NumSummaries, sizeof(s_Summaries[0]), CompareTotalTime);
+
+    printf("%u transactions over %.3f s, %.3f s in command callbacks\n\n",
+           NumRecords, EndMicroseconds / 1e6, BusMicroseconds / 1e6);
+    printf("Type  Dest  Opcode     Count  Errors   Total ms  Share    Mean us   Min us   Max us    Written       Read\n");
+
+    for (Index = 0; Index < s_NumSummaries; Index++)
+    {
+        Summary = &s_Summaries[Index];
+
+        printf("%-5s %4u  0x%02X  %10u  %6u  %9.1f  %4.1f%%  %9.1f  %7u  %7u  %9llu  %9llu\n",
+               (Summary->Type == DLPC_COMMON_CAPTURE_READ) ? "read" : "write",
+               Summary->Destination,
+               Summary->Opcode,
+               Summary->Count,
+               Summary->Errors,
+               Summary->TotalMicroseconds / 1000.0,
+               (BusMicroseconds > 0) ? 100.0 * Summary->TotalMicroseconds / BusMicroseconds : 0.0,
+               (double)Summary->TotalMicroseconds / Summary->Count,
+               Summary->MinMicroseconds,
+               Summary->MaxMicroseconds,
+               (unsigned long long)Summary->BytesWritten,
+               (unsigned long long)Summary->BytesRead);
+    }
+
+    DLPC_COMMON_CloseReplay(&Replay);
+    return 0;
+}
@@ -40,38 +40,96 @@
 
 #include "cypress_i2c.h"
 #include "CyUSBSerial.h"
-#include "time.h"
+#include "dlpc_common_platform.h"
 #include <stdio.h>
+#include <string.h>
 
 #define REQUEST_I2C_ACCESS_GPIO    5
 #define I2C_ACCESS_GRANTED_GPIO    6
 #define START_I2C_TRANSACTION_GPIO 9
-#define I2C_CLOCK_FREQUENCY_HZ     100000
 #define DLP_I2C_SLAVE_ADDRESS      (0X36 >> 1)
 #define I2C_TIMEOUT_MILLISECONDS   500   
+#define BUS_POLL_MAX_INTERVAL_MS   16
 
-static CY_HANDLE          s_Handle;
-static CY_I2C_DATA_CONFIG s_DataConfig;
+/* The device used by the single device functions */
+static CYPRESS_I2C_Device_s s_Device;
+static bool                 s_LibraryInitialized;
 
-/* Gets the handle of the connected Cypress USB-Serial bridge controller */
-bool GetCyI2CHandle(CY_HANDLE* Handle)
+static bool InitCyLibrary()
+{
+    CY_RETURN_STATUS Status;
+
+    if (s_LibraryInitialized)
+    {
+        return true;
+    }
+
+    // Initialize the Cypress USB Serial library
+    Status = CyLibraryInit();
+    if (Status != CY_SUCCESS)
+    {
+        DEBUG_PRINT_VARS("Failed to initialize Cypress USB Serial Library, Status: %d\n", Status);
+        return false;
+    }
+
+    s_LibraryInitialized = true;
+    return true;
+}
+
+static void ResetI2C(CYPRESS_I2C_Device_s* Device)
+{
+    CyI2cReset(Device->Handle, false);
+    CyI2cReset(Device->Handle, true);
+}
+
+static uint32_t GetClockFrequency(const CYPRESS_I2C_Device_s* Device)
+{
+    return (Device->ClockFrequency != 0) ? Device->ClockFrequency : CYPRESS_I2C_DEFAULT_CLOCK_FREQUENCY_HZ;
+}
+
+static CY_RETURN_STATUS ConfigureI2C(CY_HANDLE Handle, uint32_t FrequencyHz)
+{
+    CY_I2C_CONFIG I2CConfig;
+
+    I2CConfig.frequency      = FrequencyHz;
+    I2CConfig.slaveAddress   = 0x30;
+    I2CConfig.isMaster       = true;
+    I2CConfig.isClockStretch = false;
+
+    return CySetI2cConfig(Handle, &I2CConfig);
+}
+
+static void GetDataConfig(CY_I2C_DATA_CONFIG* DataConfig, bool StopBit)
+{
+    DataConfig->isNakBit     = true;
+    DataConfig->isStopBit    = StopBit;
+    DataConfig->slaveAddress = DLP_I2C_SLAVE_ADDRESS;
+}
+
+uint8_t CYPRESS_I2C_EnumerateDevices(CYPRESS_I2C_Device_s* Devices, uint8_t MaxDevices)
 {
     CY_RETURN_STATUS Status;
     CY_DEVICE_INFO   DeviceInfo;
     uint8_t          NumDevices = 0;
+    uint8_t          NumI2CDevices = 0;
     uint8_t          DeviceIdx;
     uint8_t          InterfaceIdx;
 
+    if (!InitCyLibrary())
+    {
+        return 0;
+    }
+
     Status = CyGetListofDevices(&NumDevices);
     DEBUG_PRINT_VARS("Number of devices found: %d\n", NumDevices);
 
     if ((Status != CY_SUCCESS) || (NumDevices == 0))
     {
         DEBUG_PRINT_VARS("Failed to get list of devices, Status: %d\n", Status);
-        return false;
+        return 0;
     }
 
-    for (DeviceIdx = 0; DeviceIdx < NumDevices; DeviceIdx++)
+    for (DeviceIdx = 0; (DeviceIdx < NumDevices) && (NumI2CDevices < MaxDevices); DeviceIdx++)
     {
         Status = CyGetDeviceInfo(DeviceIdx, &DeviceInfo);
         if (Status != CY_SUCCESS)
@@ -80,177 +138,585 @@ bool GetCyI2CHandle(CY_HANDLE* Handle)
             continue;
         }
 
+        /* Bridges are listed by their first I2C interface, CYPRESS_I2C_OpenDevice tries the others */
         for (InterfaceIdx = 0; InterfaceIdx < DeviceInfo.numInterfaces; InterfaceIdx++)
         {
             if (DeviceInfo.deviceType[InterfaceIdx] == CY_TYPE_I2C)
             {
-                Status = CyOpen(DeviceIdx, InterfaceIdx, Handle);
+                CYPRESS_I2C_Device_s* Device = &Devices[NumI2CDevices++];
+
+                memset(Device, 0, sizeof(*Device));
+                Device->DeviceIndex    = DeviceIdx;
+                Device->InterfaceIndex = InterfaceIdx;
+                strncpy(Device->SerialNumber, (const char*)DeviceInfo.serialNum, sizeof(Device->SerialNumber) - 1);
+                break;
+            }
+        }
+    }
+
+    return NumI2CDevices;
+}
+
+bool CYPRESS_I2C_OpenDevice(CYPRESS_I2C_Device_s* Device)
+{
+    CY_RETURN_STATUS Status;
+    CY_HANDLE        Handle;
+    CY_DEVICE_INFO   DeviceInfo;
+    uint8_t          InterfaceIdx;
+
+    if (!InitCyLibrary())
+    {
+        return false;
+    }
+
+    Status = CyOpen(Device->DeviceIndex, Device->InterfaceIndex, &Handle);
+
+    /* Fall through to the other I2C interfaces of the bridge */
+    if ((Status != CY_SUCCESS) && (CyGetDeviceInfo(Device->DeviceIndex, &DeviceInfo) == CY_SUCCESS))
+    {
+        for (InterfaceIdx = Device->InterfaceIndex + 1;
+             (InterfaceIdx < DeviceInfo.numInterfaces) && (Status != CY_SUCCESS);
+             InterfaceIdx++)
+        {
+            if (DeviceInfo.deviceType[InterfaceIdx] == CY_TYPE_I2C)
+            {
+                DEBUG_PRINT_VARS("Failed to open I2C handle, Status: %d\n", Status);
+                Status = CyOpen(Device->DeviceIndex, InterfaceIdx, &Handle);
                 if (Status == CY_SUCCESS)
                 {
-                    DEBUG_PRINT_VARS("I2C handle obtained successfully for DeviceIdx %d, InterfaceIdx %d\n", DeviceIdx, InterfaceIdx);
-                    return true;
-                }
-                else
-                {
-                    DEBUG_PRINT_VARS("Failed to open I2C handle, Status: %d\n", Status);
+                    Device->InterfaceIndex = InterfaceIdx;
                 }
             }
         }
     }
 
-    DEBUG_PRINT_VARS("Failed to obtain I2C handle\n");
-    return false;
-}
+    if (Status != CY_SUCCESS)
+    {
+        DEBUG_PRINT_VARS("Failed to open I2C handle, Status: %d\n", Status);
+        return false;
+    }
 
-bool CYPRESS_I2C_GetCyGpio(uint8_t GpioNum, uint8_t* Value) 
-{
-    DEBUG_PRINT_VARS("Getting GPIO Value for GpioNum %d\n", GpioNum);
-    return CyGetGpioValue(s_Handle, GpioNum, Value) == CY_SUCCESS;
+    DEBUG_PRINT_VARS("I2C handle obtained successfully for DeviceIdx %d, InterfaceIdx %d\n", 
+                     Device->DeviceIndex, Device->InterfaceIndex);
+
+    Status = ConfigureI2C(Handle, GetClockFrequency(Device));
+    if (Status != CY_SUCCESS)
+    {
+        DEBUG_PRINT_VARS("Connect to I2C Error, Status: %d\n", Status);
+        CyClose(Handle);
+        return false;
+    }
+
+    Device->Handle = Handle;
+    return true;
 }
 
-bool CYPRESS_I2C_SetCyGpio(uint8_t GpioNum, uint8_t Value)
+void CYPRESS_I2C_CloseDevice(CYPRESS_I2C_Device_s* Device)
 {
-    DEBUG_PRINT_VARS("Setting GPIO Value for GpioNum %d to %d\n", GpioNum, Value);
-    return CySetGpioValue(s_Handle, GpioNum, Value) == CY_SUCCESS;
+    if (Device->Handle != NULL)
+    {
+        CyClose(Device->Handle);
+        Device->Handle = NULL;
+    }
 }
 
-bool CYPRESS_I2C_RequestI2CBusAccess()
+bool CYPRESS_I2C_DeviceSetClockFrequency(CYPRESS_I2C_Device_s* Device, uint32_t FrequencyHz)
 {
-    uint8_t Value     = 0;
-    time_t  StartTime = time(NULL);
-
-    DEBUG_PRINT_VARS("Requesting I2C Bus Access\n");
+    CY_RETURN_STATUS Status;
 
-    if (!CYPRESS_I2C_SetCyGpio(REQUEST_I2C_ACCESS_GPIO, 1))
+    if ((FrequencyHz < CYPRESS_I2C_MIN_CLOCK_FREQUENCY_HZ) || (FrequencyHz > CYPRESS_I2C_MAX_CLOCK_FREQUENCY_HZ))
     {
-        DEBUG_PRINT_VARS("Failed to set GPIO for I2C access request\n");
+        DEBUG_PRINT_VARS("Unsupported I2C clock frequency: %u Hz\n", FrequencyHz);
         return false;
     }
 
-    while ((time(NULL) - StartTime) < I2C_TIMEOUT_MILLISECONDS)
+    if (Device->Handle != NULL)
+    {
+        Status = ConfigureI2C(Device->Handle, FrequencyHz);
+        if (Status != CY_SUCCESS)
+        {
+            DEBUG_PRINT_VARS("Failed to set I2C clock to %u Hz, Status: %d\n", FrequencyHz, Status);
+            return false;
+        }
+    }
+
+    DEBUG_PRINT_VARS("I2C clock set to %u Hz\n", FrequencyHz);
+    Device->ClockFrequency = FrequencyHz;
+    return true;
+}
+
+bool CYPRESS_I2C_DeviceGetCyGpio(CYPRESS_I2C_Device_s* Device, uint8_t GpioNum, uint8_t* Value)
+{
+    DEBUG_PRINT_VARS("Getting GPIO Value for GpioNum %d\n", GpioNum);
+    return CyGetGpioValue(Device->Handle, GpioNum, Value) == CY_SUCCESS;
+}
+
+bool CYPRESS_I2C_DeviceSetCyGpio(CYPRESS_I2C_Device_s* Device, uint8_t GpioNum, uint8_t Value)
+{
+    DEBUG_PRINT_VARS("Setting GPIO Value for GpioNum %d to %d\n", GpioNum, Value);
+    return CySetGpioValue(Device->Handle, GpioNum, Value) == CY_SUCCESS;
+}
+
+/* Polls the grant GPIO, backing off from an immediate retry up to BUS_POLL_MAX_INTERVAL_MS */
+static bool WaitForBusGrant(CYPRESS_I2C_Device_s* Device, uint32_t TimeoutMilliseconds)
+{
+    uint64_t Deadline = DLPC_COMMON_GetTimeInMicroseconds() + (uint64_t)TimeoutMilliseconds * 1000;
+    uint64_t Now;
+    uint32_t Interval = 0;
+    uint8_t  Value    = 0;
+
+    for (;;)
     {
-        if (!CYPRESS_I2C_GetCyGpio(I2C_ACCESS_GRANTED_GPIO, &Value))
+        Device->LeaseStatistics.GrantPolls++;
+        if (!CYPRESS_I2C_DeviceGetCyGpio(Device, I2C_ACCESS_GRANTED_GPIO, &Value))
         {
             DEBUG_PRINT_VARS("Failed to get GPIO value for I2C access granted\n");
-            break;
+            return false;
         }
 
         if (Value == 1)
         {
-            if (!CYPRESS_I2C_SetCyGpio(START_I2C_TRANSACTION_GPIO, 1))
+            return true;
+        }
+
+        Now = DLPC_COMMON_GetTimeInMicroseconds();
+        if (Now >= Deadline)
+        {
+            return false;
+        }
+
+        if (Interval > 0)
+        {
+            if ((uint64_t)Interval * 1000 > (Deadline - Now))
             {
-                DEBUG_PRINT_VARS("Failed to set GPIO for starting I2C transaction\n");
-                break;
+                Interval = (uint32_t)((Deadline - Now + 999) / 1000);
             }
+            DLPC_COMMON_SleepMilliseconds(Interval);
+        }
+        if (Interval < BUS_POLL_MAX_INTERVAL_MS)
+        {
+            Interval = (Interval == 0) ? 1 : Interval * 2;
+        }
+    }
+}
 
-            CyI2cReset(s_Handle, false);
-            CyI2cReset(s_Handle, true);
+bool CYPRESS_I2C_DeviceAcquireBus(CYPRESS_I2C_Device_s* Device, uint32_t TimeoutMilliseconds)
+{
+    CYPRESS_I2C_LeaseStatistics_s* Statistics = &Device->LeaseStatistics;
+    uint64_t                       StartTime;
+    uint64_t                       WaitTime;
 
-            DEBUG_PRINT_VARS("I2C Bus Access granted successfully\n");
-            return true;
-        }
+    if (Device->LeaseCount > 0)
+    {
+        Device->LeaseCount++;
+        Statistics->NestedAcquisitions++;
+        return true;
     }
 
-    DEBUG_PRINT_VARS("Request I2C Bus Access timed out or failed\n");
-    return false;
+    DEBUG_PRINT_VARS("Requesting I2C Bus Access\n");
+    StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+
+    if (!CYPRESS_I2C_DeviceSetCyGpio(Device, REQUEST_I2C_ACCESS_GPIO, 1))
+    {
+        DEBUG_PRINT_VARS("Failed to set GPIO for I2C access request\n");
+        Statistics->FailedAcquisitions++;
+        return false;
+    }
+
+    if (!WaitForBusGrant(Device, TimeoutMilliseconds))
+    {
+        DEBUG_PRINT_VARS("Request I2C Bus Access timed out or failed\n");
+        CYPRESS_I2C_DeviceSetCyGpio(Device, REQUEST_I2C_ACCESS_GPIO, 0);
+        Statistics->FailedAcquisitions++;
+        return false;
+    }
+
+    if (!CYPRESS_I2C_DeviceSetCyGpio(Device, START_I2C_TRANSACTION_GPIO, 1))
+    {
+        DEBUG_PRINT_VARS("Failed to set GPIO for starting I2C transaction\n");
+        CYPRESS_I2C_DeviceSetCyGpio(Device, REQUEST_I2C_ACCESS_GPIO, 0);
+        Statistics->FailedAcquisitions++;
+        return false;
+    }
+
+    ResetI2C(Device);
+
+    Device->LeaseStartTime = DLPC_COMMON_GetTimeInMicroseconds();
+    Device->LeaseCount     = 1;
+
+    WaitTime = Device->LeaseStartTime - StartTime;
+    Statistics->Leases++;
+    Statistics->TotalWaitMicroseconds += WaitTime;
+    if (WaitTime > Statistics->MaxWaitMicroseconds)
+    {
+        Statistics->MaxWaitMicroseconds = WaitTime;
+    }
+
+    DEBUG_PRINT_VARS("I2C Bus Access granted successfully\n");
+    return true;
 }
 
-bool CYPRESS_I2C_RelinquishI2CBusAccess()
+bool CYPRESS_I2C_DeviceReleaseBus(CYPRESS_I2C_Device_s* Device)
 {
+    CYPRESS_I2C_LeaseStatistics_s* Statistics = &Device->LeaseStatistics;
+    uint64_t                       HeldTime;
+
+    if (Device->LeaseCount == 0)
+    {
+        return true;
+    }
+
+    if (--Device->LeaseCount > 0)
+    {
+        return true;
+    }
+
+    HeldTime = DLPC_COMMON_GetTimeInMicroseconds() - Device->LeaseStartTime;
+    Statistics->TotalHeldMicroseconds += HeldTime;
+    if (HeldTime > Statistics->MaxHeldMicroseconds)
+    {
+        Statistics->MaxHeldMicroseconds = HeldTime;
+    }
+
     DEBUG_PRINT_VARS("Relinquishing I2C Bus Access\n");
-    return CYPRESS_I2C_SetCyGpio(REQUEST_I2C_ACCESS_GPIO, 0) 
-        && CYPRESS_I2C_SetCyGpio(START_I2C_TRANSACTION_GPIO, 0);
+    return CYPRESS_I2C_DeviceSetCyGpio(Device, REQUEST_I2C_ACCESS_GPIO, 0) 
+        && CYPRESS_I2C_DeviceSetCyGpio(Device, START_I2C_TRANSACTION_GPIO, 0);
 }
 
-bool CYPRESS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData)
+void CYPRESS_I2C_DeviceGetLeaseStatistics(const CYPRESS_I2C_Device_s* Device,
+                                          CYPRESS_I2C_LeaseStatistics_s* Statistics)
 {
-    CY_DATA_BUFFER   WriteBuffer;
-    CY_RETURN_STATUS Status;
+    *Statistics = Device->LeaseStatistics;
+}
+
+bool CYPRESS_I2C_DeviceRequestI2CBusAccess(CYPRESS_I2C_Device_s* Device)
+{
+    return CYPRESS_I2C_DeviceAcquireBus(Device, CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS);
+}
+
+bool CYPRESS_I2C_DeviceRelinquishI2CBusAccess(CYPRESS_I2C_Device_s* Device)
+{
+    return CYPRESS_I2C_DeviceReleaseBus(Device);
+}
+
+/*
+ * Records a failed transfer and resets the I2C block when the error may have
+ * left the bus held. A NAK or a busy slave ended the transaction normally, so
+ * the block is left alone; a timeout, arbitration or bus error did not.
+ */
+static void HandleTransferError(CYPRESS_I2C_Device_s* Device, CY_RETURN_STATUS Status, bool ForceReset)
+{
+    CYPRESS_I2C_ErrorStatistics_s* Statistics = &Device->ErrorStatistics;
+    bool                           Reset      = ForceReset;
+
+    switch (Status)
+    {
+        case CY_ERROR_I2C_NAK_ERROR:
+            Statistics->Naks++;
+            Device->LastError = CYPRESS_I2C_ERROR_TRANSIENT;
+            break;
+
+        case CY_ERROR_I2C_DEVICE_BUSY:
+        case CY_ERROR_I2C_BUS_BUSY:
+            Statistics->BusErrors++;
+            Device->LastError = CYPRESS_I2C_ERROR_TRANSIENT;
+            break;
+
+        /* A timeout is also reported for a short transfer */
+        case CY_SUCCESS:
+        case CY_ERROR_IO_TIMEOUT:
+            Statistics->Timeouts++;
+            Device->LastError = CYPRESS_I2C_ERROR_TRANSIENT;
+            Reset = true;
+            break;
+
+        case CY_ERROR_I2C_ARBITRATION_ERROR:
+        case CY_ERROR_I2C_BUS_ERROR:
+        case CY_ERROR_I2C_STOP_BIT_SET:
+        case CY_ERROR_PIPE_HALTED:
+        case CY_ERROR_REQUEST_FAILED:
+            Statistics->BusErrors++;
+            Device->LastError = CYPRESS_I2C_ERROR_TRANSIENT;
+            Reset = true;
+            break;
+
+        default:
+            Statistics->FatalErrors++;
+            Device->LastError = CYPRESS_I2C_ERROR_FATAL;
+            return;
+    }
+
+    if (Reset)
+    {
+        Statistics->Resets++;
+        ResetI2C(Device);
+    }
+}
+
+/* Without the stop bit the bus is kept for a repeated start by the next transfer */
+static bool WriteI2C(CYPRESS_I2C_Device_s* Device, uint32_t WriteDataLength, uint8_t* WriteData, bool StopBit)
+{
+    CY_DATA_BUFFER     WriteBuffer;
+    CY_I2C_DATA_CONFIG DataConfig;
+    CY_RETURN_STATUS   Status;
 
     DEBUG_PRINT_VARS("Writing to I2C, Data Length: %d\n", WriteDataLength);
 
     WriteBuffer.buffer        = WriteData;
     WriteBuffer.length        = WriteDataLength;
     WriteBuffer.transferCount = 0;
+    GetDataConfig(&DataConfig, StopBit);
     
-    Status = CyI2cWrite(s_Handle, 
-                        &s_DataConfig,
+    Status = CyI2cWrite(Device->Handle, 
+                        &DataConfig,
                         &WriteBuffer,
                         I2C_TIMEOUT_MILLISECONDS);
-    if (Status != CY_SUCCESS)
+    if ((Status != CY_SUCCESS) || (WriteBuffer.transferCount != WriteDataLength))
     {
-        DEBUG_PRINT_VARS("Write I2C Error, Status: %d\n", Status);
-        CyI2cReset(s_Handle, false);
-        CyI2cReset(s_Handle, true);
+        DEBUG_PRINT_VARS("Write I2C Error, Status: %d, Written: %d\n", Status, WriteBuffer.transferCount);
+        /* A write ending without a stop bit leaves the bus held */
+        HandleTransferError(Device, Status, !StopBit);
         return false;
     }
     
+    Device->LastError = CYPRESS_I2C_ERROR_NONE;
     DEBUG_PRINT_VARS("I2C Write completed successfully\n");
     return true;
 }
 
-bool CYPRESS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData)
+bool CYPRESS_I2C_DeviceReadI2C(CYPRESS_I2C_Device_s* Device, uint32_t ReadDataLength, uint8_t* ReadData)
 {
-    CY_DATA_BUFFER   ReadBuffer;
-    CY_RETURN_STATUS Status;
+    CY_DATA_BUFFER     ReadBuffer;
+    CY_I2C_DATA_CONFIG DataConfig;
+    CY_RETURN_STATUS   Status;
 
     DEBUG_PRINT_VARS("Reading from I2C, Data Length: %d\n", ReadDataLength);
 
     ReadBuffer.buffer        = ReadData;
     ReadBuffer.length        = ReadDataLength;
     ReadBuffer.transferCount = 0;
+    GetDataConfig(&DataConfig, true);
 
-    Status = CyI2cRead(s_Handle,
-                       &s_DataConfig,
+    Status = CyI2cRead(Device->Handle,
+                       &DataConfig,
                        &ReadBuffer,
                        I2C_TIMEOUT_MILLISECONDS);
-    if ((Status != CY_SUCCESS) && (Status != CY_ERROR_IO_TIMEOUT))
+    if ((Status != CY_SUCCESS) || (ReadBuffer.transferCount != ReadDataLength))
     {
-        DEBUG_PRINT_VARS("Read I2C Error, Status: %d\n", Status);
-        CyI2cReset(s_Handle, false);
-        CyI2cReset(s_Handle, true);
+        DEBUG_PRINT_VARS("Read I2C Error, Status: %d, Read: %d\n", Status, ReadBuffer.transferCount);
+        HandleTransferError(Device, Status, false);
         return false;
     }
 
+    Device->LastError = CYPRESS_I2C_ERROR_NONE;
     DEBUG_PRINT_VARS("I2C Read completed successfully\n");
     return true;
 }
 
+bool CYPRESS_I2C_DeviceWriteI2C(CYPRESS_I2C_Device_s* Device, uint32_t WriteDataLength, uint8_t* WriteData)
+{
+    return WriteI2C(Device, WriteDataLength, WriteData, true);
+}
+
+void CYPRESS_I2C_DeviceGetErrorStatistics(const CYPRESS_I2C_Device_s* Device,
+                                          CYPRESS_I2C_ErrorStatistics_s* Statistics)
+{
+    *Statistics = Device->ErrorStatistics;
+}
+
+bool CYPRESS_I2C_DeviceWriteReadI2C(CYPRESS_I2C_Device_s* Device,
+                                    uint32_t              WriteDataLength,
+                                    uint8_t*              WriteData,
+                                    uint32_t              ReadDataLength,
+                                    uint8_t*              ReadData)
+{
+    return WriteI2C(Device, WriteDataLength, WriteData, false)
+        && CYPRESS_I2C_DeviceReadI2C(Device, ReadDataLength, ReadData);
+}
+
+bool CYPRESS_I2C_GetCyGpio(uint8_t GpioNum, uint8_t* Value) 
+{
+    return CYPRESS_I2C_DeviceGetCyGpio(&s_Device, GpioNum, Value);
+}
+
+bool CYPRESS_I2C_SetCyGpio(uint8_t GpioNum, uint8_t Value)
+{
+    return CYPRESS_I2C_DeviceSetCyGpio(&s_Device, GpioNum, Value);
+}
+
+bool CYPRESS_I2C_RequestI2CBusAccess()
+{
+    return CYPRESS_I2C_DeviceRequestI2CBusAccess(&s_Device);
+}
+
+bool CYPRESS_I2C_RelinquishI2CBusAccess()
+{
+    return CYPRESS_I2C_DeviceRelinquishI2CBusAccess(&s_Device);
+}
+
+bool CYPRESS_I2C_AcquireBus(uint32_t TimeoutMilliseconds)
+{
+    return CYPRESS_I2C_DeviceAcquireBus(&s_Device, TimeoutMilliseconds);
+}
+
+bool CYPRESS_I2C_ReleaseBus()
+{
+    return CYPRESS_I2C_DeviceReleaseBus(&s_Device);
+}
+
+void CYPRESS_I2C_GetLeaseStatistics(CYPRESS_I2C_LeaseStatistics_s* Statistics)
+{
+    CYPRESS_I2C_DeviceGetLeaseStatistics(&s_Device, Statistics);
+}
+
+void CYPRESS_I2C_GetErrorStatistics(CYPRESS_I2C_ErrorStatistics_s* Statistics)
+{
+    CYPRESS_I2C_DeviceGetErrorStatistics(&s_Device, Statistics);
+}
+
+bool CYPRESS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData)
+{
+    return CYPRESS_I2C_DeviceWriteI2C(&s_Device, WriteDataLength, WriteData);
+}
+
+bool CYPRESS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData)
+{
+    return CYPRESS_I2C_DeviceReadI2C(&s_Device, ReadDataLength, ReadData);
+}
+
+bool CYPRESS_I2C_WriteReadI2C(uint32_t WriteDataLength, uint8_t* WriteData, uint32_t ReadDataLength, uint8_t* ReadData)
+{
+    return CYPRESS_I2C_DeviceWriteReadI2C(&s_Device, WriteDataLength, WriteData, ReadDataLength, ReadData);
+}
+
 bool CYPRESS_I2C_ConnectToCyI2C()
 {
-    CY_RETURN_STATUS Status;	
-    CY_I2C_CONFIG I2CConfig;
+    CYPRESS_I2C_Device_s Devices[CYPRESS_I2C_MAX_DEVICES];
+    uint8_t              NumDevices;
+    uint8_t              Index;
 
-    // Initialize the Cypress USB Serial library
-    Status = CyLibraryInit();
-    if (Status != CY_SUCCESS)
+    /* The first bridge that opens is used */
+    NumDevices = CYPRESS_I2C_EnumerateDevices(Devices, CYPRESS_I2C_MAX_DEVICES);
+    for (Index = 0; Index < NumDevices; Index++)
     {
-        DEBUG_PRINT_VARS("Failed to initialize Cypress USB Serial Library, Status: %d\n", Status);
-        return false;
+        /* Keep the clock selected before connecting */
+        Devices[Index].ClockFrequency = s_Device.ClockFrequency;
+        if (CYPRESS_I2C_OpenDevice(&Devices[Index]))
+        {
+            s_Device = Devices[Index];
+            return true;
+        }
     }
-        
-    if (!GetCyI2CHandle(&s_Handle))
+
+    DEBUG_PRINT_VARS("Failed to get I2C handle\n");
+    return false;
+}
+
+bool CYPRESS_I2C_SetClockFrequency(uint32_t FrequencyHz)
+{
+    return CYPRESS_I2C_DeviceSetClockFrequency(&s_Device, FrequencyHz);
+}
+
+uint32_t CYPRESS_I2C_GetClockFrequency()
+{
+    return GetClockFrequency(&s_Device);
+}
+
+const char* CYPRESS_I2C_GetSerialNumber()
+{
+    return s_Device.SerialNumber;
+}
+
+static CYPRESS_I2C_Device_s* GetTransportDevice(DLPC_COMMON_Transport_s* Transport)
+{
+    return (Transport->Data != NULL) ? (CYPRESS_I2C_Device_s*)Transport->Data : &s_Device;
+}
+
+static uint32_t GetTransportError(const CYPRESS_I2C_Device_s* Device)
+{
+    return (Device->LastError == CYPRESS_I2C_ERROR_FATAL) ? ERR_TRANSPORT_FATAL : ERR_TRANSPORT_IO;
+}
+
+static uint32_t TransportOpen(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+    CYPRESS_I2C_Device_s* Device = GetTransportDevice(Transport);
+    CYPRESS_I2C_Device_s  Devices[CYPRESS_I2C_MAX_DEVICES];
+    uint8_t               NumDevices;
+    uint8_t               Index;
+
+    /* The first matching bridge that opens is used */
+    NumDevices = CYPRESS_I2C_EnumerateDevices(Devices, CYPRESS_I2C_MAX_DEVICES);
+    for (Index = 0; Index < NumDevices; Index++)
     {
-        DEBUG_PRINT_VARS("Failed to get I2C handle\n");
-        return false;
+        if ((Address != NULL) && (strcmp(Address, Devices[Index].SerialNumber) != 0))
+        {
+            continue;
+        }
+
+        /* Keep the clock selected before opening */
+        Devices[Index].ClockFrequency = Device->ClockFrequency;
+        if (CYPRESS_I2C_OpenDevice(&Devices[Index]))
+        {
+            break;
+        }
     }
 
-    I2CConfig.frequency      = I2C_CLOCK_FREQUENCY_HZ;
-    I2CConfig.slaveAddress   = 0x30;
-    I2CConfig.isMaster       = true;
-    I2CConfig.isClockStretch = false;
-    
-    Status = CySetI2cConfig(s_Handle, &I2CConfig);
-    if (Status != CY_SUCCESS)
+    if (Index == NumDevices)
     {
-		// printf("Connect to I2C Error %d!!! \n", Status);
-        DEBUG_PRINT_VARS("Connect to I2C Error, Status: %d\n", Status);
-        return false;
+        DEBUG_PRINT_VARS("No I2C bridge %s could be opened\n", (Address != NULL) ? Address : "");
+        return ERR_TRANSPORT_OPEN;
     }
 
-    s_DataConfig.isNakBit     = true;
-    s_DataConfig.isStopBit    = true;
-    s_DataConfig.slaveAddress = DLP_I2C_SLAVE_ADDRESS;
+    *Device = Devices[Index];
 
-    return true;
+    Transport->Capabilities = DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION | DLPC_COMMON_TRANSPORT_CAP_COMBINED_WRITE_READ;
+    return 0;
 }
+
+static void TransportClose(DLPC_COMMON_Transport_s* Transport)
+{
+    CYPRESS_I2C_CloseDevice(GetTransportDevice(Transport));
+}
+
+static uint32_t TransportWrite(DLPC_COMMON_Transport_s* Transport,
+                               uint16_t                 WriteLength,
+                               const uint8_t*           WriteData)
+{
+    CYPRESS_I2C_Device_s* Device = GetTransportDevice(Transport);
+
+    if (!CYPRESS_I2C_DeviceWriteI2C(Device, WriteLength, (uint8_t*)WriteData))
+    {
+        return GetTransportError(Device);
+    }
+
+    return 0;
+}
+
+static uint32_t TransportWriteRead(DLPC_COMMON_Transport_s* Transport,
+                                   uint16_t                 WriteLength,
+                                   const uint8_t*           WriteData,
+                                   uint16_t                 ReadLength,
+                                   uint8_t*                 ReadData,
+                                   uint16_t*                BytesRead)
+{
+    CYPRESS_I2C_Device_s* Device = GetTransportDevice(Transport);
+
+    if (!CYPRESS_I2C_DeviceWriteReadI2C(Device, WriteLength, (uint8_t*)WriteData, ReadLength, ReadData))
+    {
+        return GetTransportError(Device);
+    }
+
+    *BytesRead = ReadLength;
+    return 0;
+}
+
+const DLPC_COMMON_TransportOps_s CYPRESS_I2C_TransportOps =
+{
+    "cypress-i2c",
+    TransportOpen,
+    TransportClose,
+    TransportWrite,
+    TransportWriteRead,
+    NULL,
+    NULL
+};
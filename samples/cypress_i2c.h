@@ -47,15 +47,217 @@ extern "C" {
 
 #include "stdbool.h"
 #include "stdint.h"
+#include "dlpc_common_transport.h"
 
+#define CYPRESS_I2C_MAX_DEVICES 16
+
+/* I2C clock range supported by the bridge */
+#define CYPRESS_I2C_DEFAULT_CLOCK_FREQUENCY_HZ 100000
+#define CYPRESS_I2C_MIN_CLOCK_FREQUENCY_HZ     1000
+#define CYPRESS_I2C_MAX_CLOCK_FREQUENCY_HZ     400000
+
+/** Time CYPRESS_I2C_RequestI2CBusAccess waits for the bus to be granted */
+#define CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS      500
+
+/**
+ * Statistics of the bus leases of a device. A lease lasts from the grant of
+ * the outermost CYPRESS_I2C_DeviceAcquireBus to the matching release.
+ */
+typedef struct
+{
+    /** Leases granted by the controller */
+    uint32_t Leases;
+
+    /** Acquisitions served by a lease already held, without a handshake */
+    uint32_t NestedAcquisitions;
+
+    /** Acquisitions that timed out or failed */
+    uint32_t FailedAcquisitions;
+
+    /** GPIO reads made while waiting for grants */
+    uint32_t GrantPolls;
+
+    uint64_t TotalWaitMicroseconds;
+    uint64_t MaxWaitMicroseconds;
+    uint64_t TotalHeldMicroseconds;
+    uint64_t MaxHeldMicroseconds;
+} CYPRESS_I2C_LeaseStatistics_s;
+
+/** Classification of the last failed transfer of a device */
+typedef enum
+{
+    CYPRESS_I2C_ERROR_NONE      = 0,
+    /** The transfer may succeed when repeated (NAK, busy, timeout, bus error) */
+    CYPRESS_I2C_ERROR_TRANSIENT = 1,
+    /** The bridge is gone or the request was invalid, repeating will not help */
+    CYPRESS_I2C_ERROR_FATAL     = 2
+} CYPRESS_I2C_ErrorClass_e;
+
+/** Counts of the transfer errors of a device */
+typedef struct
+{
+    uint32_t Naks;
+    uint32_t Timeouts;
+    uint32_t BusErrors;
+    uint32_t FatalErrors;
+
+    /** Resets of the I2C block after an error that left the bus in an unknown state */
+    uint32_t Resets;
+} CYPRESS_I2C_ErrorStatistics_s;
+
+/**
+ * A Cypress USB-Serial bridge I2C interface. Each device has its own handle,
+ * so different devices can be used from different threads.
+ */
+typedef struct
+{
+    /** CY_HANDLE of the opened interface, NULL when closed */
+    void*   Handle;
+
+    /** Index of the bridge in the Cypress device list */
+    uint8_t DeviceIndex;
+    uint8_t InterfaceIndex;
+
+    char    SerialNumber[64];
+
+    /** I2C clock used when the device is opened. 0 selects the default. */
+    uint32_t ClockFrequency;
+
+    /** Bus lease state, see CYPRESS_I2C_DeviceAcquireBus */
+    uint32_t LeaseCount;
+    uint64_t LeaseStartTime;
+    CYPRESS_I2C_LeaseStatistics_s LeaseStatistics;
+
+    /** Classification of the last failed transfer and the error counts */
+    CYPRESS_I2C_ErrorClass_e      LastError;
+    CYPRESS_I2C_ErrorStatistics_s ErrorStatistics;
+} CYPRESS_I2C_Device_s;
+
+/**
+ * Lists the attached bridges that have an I2C interface. The devices are
+ * returned closed.
+ *
+ * \param[out] Devices     The devices found
+ * \param[in]  MaxDevices  Number of entries in Devices
+ *
+ * \return The number of devices found
+ */
+uint8_t CYPRESS_I2C_EnumerateDevices(CYPRESS_I2C_Device_s* Devices, uint8_t MaxDevices);
+
+/**
+ * Opens and configures the I2C interface of an enumerated device. When that
+ * interface can't be opened, the other I2C interfaces of the bridge are
+ * tried and InterfaceIndex is updated to the one opened.
+ */
+bool CYPRESS_I2C_OpenDevice(CYPRESS_I2C_Device_s* Device);
+void CYPRESS_I2C_CloseDevice(CYPRESS_I2C_Device_s* Device);
+
+/**
+ * Sets the I2C clock of a device. An open device is reconfigured right away,
+ * otherwise the clock is used the next time the device is opened.
+ *
+ * \param[in] Device       The device
+ * \param[in] FrequencyHz  I2C clock frequency in Hz, between
+ *                         CYPRESS_I2C_MIN_CLOCK_FREQUENCY_HZ and
+ *                         CYPRESS_I2C_MAX_CLOCK_FREQUENCY_HZ
+ *
+ * \return true if the clock was accepted by the bridge
+ */
+bool CYPRESS_I2C_DeviceSetClockFrequency(CYPRESS_I2C_Device_s* Device, uint32_t FrequencyHz);
+
+/**
+ * Acquires the controller I2C bus through the GPIO handshake of the TI EVMs.
+ * Acquisitions nest: only the outermost one performs the handshake, and the
+ * bus is held until the matching number of releases. The grant is polled
+ * with an increasing interval until the timeout expires.
+ *
+ * \param[in] Device               The device
+ * \param[in] TimeoutMilliseconds  Maximum time to wait for the grant
+ *
+ * \return true if the bus is held
+ */
+bool CYPRESS_I2C_DeviceAcquireBus(CYPRESS_I2C_Device_s* Device, uint32_t TimeoutMilliseconds);
+
+/**
+ * Releases one acquisition of the bus. The handshake lines are released
+ * with the outermost acquisition.
+ */
+bool CYPRESS_I2C_DeviceReleaseBus(CYPRESS_I2C_Device_s* Device);
+
+/**
+ * Gets the lease statistics of a device. A lease still held is not counted
+ * in the held time until it is released.
+ */
+void CYPRESS_I2C_DeviceGetLeaseStatistics(const CYPRESS_I2C_Device_s* Device,
+                                          CYPRESS_I2C_LeaseStatistics_s* Statistics);
+
+/* Same as CYPRESS_I2C_DeviceAcquireBus with CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS,
+ * and CYPRESS_I2C_DeviceReleaseBus */
+bool CYPRESS_I2C_DeviceRequestI2CBusAccess(CYPRESS_I2C_Device_s* Device);
+bool CYPRESS_I2C_DeviceRelinquishI2CBusAccess(CYPRESS_I2C_Device_s* Device);
+/*
+ * A transfer only succeeds when all bytes were transferred. On failure
+ * Device->LastError tells whether repeating the transfer may help. The I2C
+ * block is reset only after errors that can leave the bus held, such as
+ * timeouts, arbitration and bus errors or a failed write before a repeated
+ * start; a NAK or a busy slave leaves it as it is.
+ */
+bool CYPRESS_I2C_DeviceWriteI2C(CYPRESS_I2C_Device_s* Device, uint32_t WriteDataLength, uint8_t* WriteData);
+bool CYPRESS_I2C_DeviceReadI2C(CYPRESS_I2C_Device_s* Device, uint32_t ReadDataLength, uint8_t* ReadData);
+
+/**
+ * Writes a request and reads the response as one I2C transaction. The write
+ * ends without a stop condition and the read follows with a repeated start,
+ * so the controller responds without the bus being released in between.
+ *
+ * \param[in]  Device           The device
+ * \param[in]  WriteDataLength  Number of bytes to write
+ * \param[in]  WriteData        The bytes to write
+ * \param[in]  ReadDataLength   Number of bytes to read
+ * \param[out] ReadData         The bytes read
+ *
+ * \return true if successful
+ */
+bool CYPRESS_I2C_DeviceWriteReadI2C(CYPRESS_I2C_Device_s* Device,
+                                    uint32_t              WriteDataLength,
+                                    uint8_t*              WriteData,
+                                    uint32_t              ReadDataLength,
+                                    uint8_t*              ReadData);
+void CYPRESS_I2C_DeviceGetErrorStatistics(const CYPRESS_I2C_Device_s* Device,
+                                          CYPRESS_I2C_ErrorStatistics_s* Statistics);
+bool CYPRESS_I2C_DeviceGetCyGpio(CYPRESS_I2C_Device_s* Device, uint8_t GpioNum, uint8_t* Value);
+bool CYPRESS_I2C_DeviceSetCyGpio(CYPRESS_I2C_Device_s* Device, uint8_t GpioNum, uint8_t Value);
+
+/* Single device functions, using the first bridge found by CYPRESS_I2C_ConnectToCyI2C.
+ * CYPRESS_I2C_SetClockFrequency may be called before connecting to select the
+ * clock used by CYPRESS_I2C_ConnectToCyI2C. */
 bool CYPRESS_I2C_RequestI2CBusAccess();
 bool CYPRESS_I2C_RelinquishI2CBusAccess();
+bool CYPRESS_I2C_AcquireBus(uint32_t TimeoutMilliseconds);
+bool CYPRESS_I2C_ReleaseBus();
+void CYPRESS_I2C_GetLeaseStatistics(CYPRESS_I2C_LeaseStatistics_s* Statistics);
+void CYPRESS_I2C_GetErrorStatistics(CYPRESS_I2C_ErrorStatistics_s* Statistics);
 bool CYPRESS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData);
 bool CYPRESS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData);
+bool CYPRESS_I2C_WriteReadI2C(uint32_t WriteDataLength, uint8_t* WriteData, uint32_t ReadDataLength, uint8_t* ReadData);
 bool CYPRESS_I2C_ConnectToCyI2C();
+bool CYPRESS_I2C_SetClockFrequency(uint32_t FrequencyHz);
+uint32_t CYPRESS_I2C_GetClockFrequency();
+const char* CYPRESS_I2C_GetSerialNumber();
 bool CYPRESS_I2C_GetCyGpio(uint8_t GpioNum, uint8_t* Value);
 bool CYPRESS_I2C_SetCyGpio(uint8_t GpioNum, uint8_t Value);
 
+/**
+ * Transport backend for the bridge. The transport Data is a
+ * CYPRESS_I2C_Device_s, or NULL to use the device of the single device
+ * functions. The Address is the serial number of the bridge, NULL for the
+ * first bridge found. The transport has the
+ * DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION capability, see
+ * CYPRESS_I2C_DeviceAcquireBus. Write/reads use
+ * CYPRESS_I2C_DeviceWriteReadI2C.
+ */
+extern const DLPC_COMMON_TransportOps_s CYPRESS_I2C_TransportOps;
+
 #ifdef __cplusplus    /* matches __cplusplus construct above */
 }
 #endif
@@ -50,6 +50,16 @@
 // #include "usbi2cio/Usbi2cio.h"
 #include "Usbi2cio.h"
 
+#define MAX_TRANSFER_SIZE           64
+#define MAX_SEGMENT_PAYLOAD         (MAX_TRANSFER_SIZE - 1)
+
+/* DLPC34xx flash commands that are split into segments */
+#define OPCODE_FLASH_DATA_LENGTH    0xDF
+#define OPCODE_WRITE_FLASH_START    0xE1
+#define OPCODE_WRITE_FLASH_CONTINUE 0xE2
+#define OPCODE_READ_FLASH_START     0xE3
+#define OPCODE_READ_FLASH_CONTINUE  0xE4
+
 void *hDLL;
 typedef void* (*OPENDEVICEINSTANCE)(const char*, uint8_t);
 typedef bool (*CLOSEDEVICEINSTANCE)(void*);
@@ -58,8 +68,8 @@ typedef uint8_t (*GETDEVICECOUNT)(const char*);
 typedef uint8_t (*GETDEVICEINFO)(const char*, LPDEVINFO);
 typedef void* (*OPENDEVICEBYSERIALID)(const char*, const char*);
 typedef bool (*GETSERIALID)(void*, char*);
-typedef bool (*READI2C)(void*, PI2C_TRANS);
-typedef bool (*WRITEI2C)(void*, PI2C_TRANS);
+typedef int32_t (*READI2C)(void*, PI2C_TRANS);
+typedef int32_t (*WRITEI2C)(void*, PI2C_TRANS);
 
 OPENDEVICEINSTANCE OpenDeviceInstance;
 CLOSEDEVICEINSTANCE CloseDeviceInstance;
@@ -75,6 +85,9 @@ void* hDevInstance = NULL;	// handle to UsbI2cIo device
 I2C_TRANS TransI2c;			// I2C transaction structure
 DEVINFO DeviceInfo;
 
+static uint16_t s_FlashDataLength;   // Flash Data Length last sent, 0 if unknown
+static uint8_t  s_PendingReadOpcode; // Flash read opcode waiting for its read
+
 bool DEVASYS_I2C_ConnectToDevI2C()
 {
 	int NumDevices = 0;
@@ -109,6 +122,7 @@ bool DEVASYS_I2C_ConnectToDevI2C()
 		hDevInstance = OpenDeviceBySerialId("UsbI2cIo", DeviceInfo.SerialId);
 		Status = DetectDevice(hDevInstance);
 	}
+	s_FlashDataLength = 0;
 
 	if ((NumDevices == 0) || (hDevInstance == NULL) || (!Status))
 	{
@@ -119,69 +133,228 @@ bool DEVASYS_I2C_ConnectToDevI2C()
 	return true;
 }
 
-bool DEVASYS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData)
+/* Runs one I2C transaction. The adapter is only checked when the transaction
+ * fails; if it was detached it is reopened and the transaction retried once.
+ */
+static bool Transfer(bool Write, uint16_t Length, uint8_t* Data)
 {
-	long lBytesWritten = 0;
+	long lBytes = 0;
 
-    if (WriteDataLength > 64)
+	TransI2c.wCount = Length;
+	if (Write)
 	{
-		printf("The maximum number of bytes per transfer is limited to 64!!! \n");
+		memcpy(TransI2c.Data, Data, Length);
 	}
 
-	// Setup for I2C communication
-	TransI2c.wCount = WriteDataLength;
-	for (uint32_t Index = 0; Index < WriteDataLength; Index++)
+	lBytes = Write ? WriteI2c(hDevInstance, &TransI2c) : ReadI2c(hDevInstance, &TransI2c);
+	if ((lBytes != Length) && !DetectDevice(hDevInstance))
 	{
-		TransI2c.Data[Index] = WriteData[Index];
+		/* The stale handle is closed first, each recovery would leak one otherwise */
+		if (hDevInstance != NULL)
+		{
+			CloseDeviceInstance(hDevInstance);
+		}
+		hDevInstance = OpenDeviceBySerialId("UsbI2cIo", DeviceInfo.SerialId);
+		if (hDevInstance != NULL)
+		{
+			TransI2c.wCount = Length;
+			lBytes = Write ? WriteI2c(hDevInstance, &TransI2c) : ReadI2c(hDevInstance, &TransI2c);
+		}
 	}
 
-	// Make sure the I2C device is still attached
-	bool Status = DetectDevice(hDevInstance);
-	if (!Status)
+	if (lBytes != Length)
 	{
-		hDevInstance = OpenDeviceBySerialId("UsbI2cIo", DeviceInfo.SerialId);
+		printf("Number of bytes %s does not match Data Length!!! \n", Write ? "written" : "read");
+		return false;
+	}
+
+	if (!Write)
+	{
+		memcpy(Data, TransI2c.Data, Length);
+	}
+	return true;
+}
+
+/* Sends Flash Data Length unless the controller already uses Length */
+static bool SetFlashDataLength(uint16_t Length)
+{
+	uint8_t Command[3] = { OPCODE_FLASH_DATA_LENGTH, (uint8_t)Length, (uint8_t)(Length >> 8) };
+
+	if (Length == s_FlashDataLength)
+	{
+		return true;
 	}
 
-	lBytesWritten = WriteI2c(hDevInstance, &TransI2c);
-	if (lBytesWritten != TransI2c.wCount)
+	if (!Transfer(true, sizeof(Command), Command))
 	{
-		printf("Number of bytes written does not match Data Length!!! \n");
+		s_FlashDataLength = 0;
 		return false;
 	}
 
+	s_FlashDataLength = Length;
 	return true;
 }
 
-bool DEVASYS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData)
+/* Sends a Write Flash Start/Continue payload as segments that fit one
+ * transfer. Only the first segment keeps the opcode of the caller, the
+ * others continue it.
+ */
+static bool WriteFlashSegments(uint8_t Opcode, uint32_t Length, uint8_t* Data)
+{
+	uint8_t  Segment[MAX_TRANSFER_SIZE];
+	uint32_t Offset = 0;
+	uint16_t SegmentLength;
+
+	while (Offset < Length)
+	{
+		SegmentLength = (uint16_t)(((Length - Offset) < MAX_SEGMENT_PAYLOAD) ? (Length - Offset) : MAX_SEGMENT_PAYLOAD);
+
+		if (!SetFlashDataLength(SegmentLength))
+		{
+			return false;
+		}
+
+		Segment[0] = Opcode;
+		memcpy(&Segment[1], &Data[Offset], SegmentLength);
+		if (!Transfer(true, SegmentLength + 1, Segment))
+		{
+			return false;
+		}
+
+		Offset += SegmentLength;
+		Opcode  = OPCODE_WRITE_FLASH_CONTINUE;
+	}
+
+	return true;
+}
+
+/* Reads a Read Flash Start/Continue response as segments that fit one transfer */
+static bool ReadFlashSegments(uint8_t Opcode, uint32_t Length, uint8_t* Data)
+{
+	uint32_t Offset = 0;
+	uint16_t SegmentLength;
+
+	while (Offset < Length)
+	{
+		SegmentLength = (uint16_t)(((Length - Offset) < MAX_TRANSFER_SIZE) ? (Length - Offset) : MAX_TRANSFER_SIZE);
+
+		if (!SetFlashDataLength(SegmentLength) ||
+			!Transfer(true, 1, &Opcode) ||
+			!Transfer(false, SegmentLength, &Data[Offset]))
+		{
+			return false;
+		}
+
+		Offset += SegmentLength;
+		Opcode  = OPCODE_READ_FLASH_CONTINUE;
+	}
+
+	return true;
+}
+
+bool DEVASYS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData)
 {
-	long lBytesRead = 0;
+	uint8_t Opcode = (WriteDataLength > 0) ? WriteData[0] : 0;
 
-	if (ReadDataLength > 64)
+	s_PendingReadOpcode = 0;
+
+	/* The read length of a flash read is only known once the read is issued */
+	if ((WriteDataLength == 1) &&
+		((Opcode == OPCODE_READ_FLASH_START) || (Opcode == OPCODE_READ_FLASH_CONTINUE)))
 	{
-		printf("The maximum number of bytes per transfer is limited to 64!!! \n");
+		s_PendingReadOpcode = Opcode;
+		return true;
 	}
 
-	// Make sure the I2C device is still attached
-	bool Status = DetectDevice(hDevInstance);
-	if (!Status)
+	if ((WriteDataLength > 0) &&
+		((Opcode == OPCODE_WRITE_FLASH_START) || (Opcode == OPCODE_WRITE_FLASH_CONTINUE)))
 	{
-		// hDevInstance = OpenDeviceInstance("UsbI2cIo", (uint8_t)(DeviceInfo.SerialId));
-		hDevInstance = OpenDeviceInstance("UsbI2cIo", (uintptr_t)(DeviceInfo.SerialId));
+		return WriteFlashSegments(Opcode, WriteDataLength - 1, &WriteData[1]);
+	}
 
+	if (WriteDataLength > MAX_TRANSFER_SIZE)
+	{
+		printf("The maximum number of bytes per transfer is limited to %d!!! \n", MAX_TRANSFER_SIZE);
+		return false;
 	}
 
-	// Setup for I2C communication
-	TransI2c.wCount = ReadDataLength;
-	lBytesRead = ReadI2c(hDevInstance, &TransI2c);
-	if (lBytesRead != TransI2c.wCount)
+	if (!Transfer(true, (uint16_t)WriteDataLength, WriteData))
 	{
-		printf("Number of bytes read does not match Data Length!!! \n");
 		return false;
 	}
 
-	for (uint32_t Index = 0; Index < ReadDataLength; Index++)
+	if ((Opcode == OPCODE_FLASH_DATA_LENGTH) && (WriteDataLength == 3))
 	{
-		ReadData[Index] = TransI2c.Data[Index];
+		s_FlashDataLength = (uint16_t)(WriteData[1] | (WriteData[2] << 8));
 	}
+
 	return true;
 }
+
+bool DEVASYS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData)
+{
+	uint8_t Opcode = s_PendingReadOpcode;
+
+	if (Opcode != 0)
+	{
+		s_PendingReadOpcode = 0;
+		return ReadFlashSegments(Opcode, ReadDataLength, ReadData);
+	}
+
+	if (ReadDataLength > MAX_TRANSFER_SIZE)
+	{
+		printf("The maximum number of bytes per transfer is limited to %d!!! \n", MAX_TRANSFER_SIZE);
+		return false;
+	}
+
+	return Transfer(false, (uint16_t)ReadDataLength, ReadData);
+}
+
+static uint32_t TransportOpen(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+	return DEVASYS_I2C_ConnectToDevI2C() ? 0 : ERR_TRANSPORT_OPEN;
+}
+
+static void TransportClose(DLPC_COMMON_Transport_s* Transport)
+{
+	if (hDevInstance != NULL)
+	{
+		CloseDeviceInstance(hDevInstance);
+		hDevInstance = NULL;
+	}
+}
+
+static uint32_t TransportWrite(DLPC_COMMON_Transport_s* Transport,
+	uint16_t WriteLength,
+	const uint8_t* WriteData)
+{
+	return DEVASYS_I2C_WriteI2C(WriteLength, (uint8_t*)WriteData) ? 0 : ERR_TRANSPORT_IO;
+}
+
+static uint32_t TransportWriteRead(DLPC_COMMON_Transport_s* Transport,
+	uint16_t WriteLength,
+	const uint8_t* WriteData,
+	uint16_t ReadLength,
+	uint8_t* ReadData,
+	uint16_t* BytesRead)
+{
+	if (!DEVASYS_I2C_WriteI2C(WriteLength, (uint8_t*)WriteData) ||
+		!DEVASYS_I2C_ReadI2C(ReadLength, ReadData))
+	{
+		return ERR_TRANSPORT_IO;
+	}
+
+	*BytesRead = ReadLength;
+	return 0;
+}
+
+const DLPC_COMMON_TransportOps_s DEVASYS_I2C_TransportOps =
+{
+	"devasys-i2c",
+	TransportOpen,
+	TransportClose,
+	TransportWrite,
+	TransportWriteRead,
+	NULL,
+	NULL
+};
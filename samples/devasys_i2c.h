@@ -45,11 +45,27 @@ extern "C" {
 
 #include "stdbool.h"
 #include "stdint.h"
+#include "dlpc_common_transport.h"
 
 bool DEVASYS_I2C_ConnectToDevI2C();
+
+/**
+ * The adapter moves at most 64 bytes per I2C transaction. Longer DLPC34xx
+ * Write Flash Start/Continue commands are sent as several Start/Continue
+ * segments, and longer Read Flash Start/Continue responses are read the same
+ * way, with Flash Data Length resent whenever the segment length changes.
+ * Other commands longer than 64 bytes are rejected.
+ */
 bool DEVASYS_I2C_WriteI2C(uint32_t WriteDataLength, uint8_t* WriteData);
 bool DEVASYS_I2C_ReadI2C(uint32_t ReadDataLength, uint8_t* ReadData);
 
+/**
+ * Transport backend for the first DeVaSys adapter. The transport Data and
+ * the Address are ignored. No transfer limit is reported since flash
+ * commands are split as described above.
+ */
+extern const DLPC_COMMON_TransportOps_s DEVASYS_I2C_TransportOps;
+
 #ifdef __cplusplus    /* matches __cplusplus construct above */
 }
 #endif
@@ -108,28 +108,25 @@ uint32_t ReadI2C(uint16_t              WriteDataLength,
 
 	if (CYPRESS_I2C_COMMUNICATION)
 	{
-		Status = CYPRESS_I2C_WriteI2C(WriteDataLength, WriteData);
-	}
-	else
-	{
-		Status = DEVASYS_I2C_WriteI2C(WriteDataLength, WriteData);
+		/* One transaction: the read follows the write with a repeated start */
+		Status = CYPRESS_I2C_WriteReadI2C(WriteDataLength, WriteData, ReadDataLength, ReadData);
+		if (Status != true)
+		{
+			printf("Write/Read I2C Error!!! \n");
+			return FAIL;
+		}
+
+		return SUCCESS;
 	}
 
+	Status = DEVASYS_I2C_WriteI2C(WriteDataLength, WriteData);
 	if (Status != true)
 	{
 		printf("Write I2C Error!!! \n");
 		return FAIL;
 	}
 
-	if (CYPRESS_I2C_COMMUNICATION)
-	{
-		Status = CYPRESS_I2C_ReadI2C(ReadDataLength, ReadData);
-	}
-	else
-	{
-		Status = DEVASYS_I2C_ReadI2C(ReadDataLength, ReadData);
-	}
-
+	Status = DEVASYS_I2C_ReadI2C(ReadDataLength, ReadData);
 	if (Status != true)
 	{
 		printf("Read I2C Error!!! \n");
@@ -119,17 +119,12 @@ uint32_t ReadI2C(uint16_t                           WriteDataLength,
                  DLPC_COMMON_CommandProtocolData_s* ProtocolData)
 {
     bool Status = 0;
-    Status = CYPRESS_I2C_WriteI2C(WriteDataLength, WriteData);
-    if (Status != true)
-    {
-        //printf("Write I2C Error!!! \n");
-        return FAIL;
-    }
 
-    Status = CYPRESS_I2C_ReadI2C(ReadDataLength, ReadData);
+    /* One transaction: the read follows the write with a repeated start */
+    Status = CYPRESS_I2C_WriteReadI2C(WriteDataLength, WriteData, ReadDataLength, ReadData);
     if (Status != true)
     {
-        //printf("Read I2C Error!!! \n");
+        //printf("Write/Read I2C Error!!! \n");
         return FAIL;
     }
 
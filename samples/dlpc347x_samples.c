@@ -40,9 +40,17 @@
 #include "dlpc_common.h"
 #include "dlpc34xx.h"
 #include "dlpc347x_internal_patterns.h"
+#include "dlpc34xx_flash.h"
+#include "dlpc_common_tuning.h"
+#include "dlpc_common_platform.h"
+#include "dlpc_common_transport.h"
+#include "dlpc_common_capture.h"
 #include "cypress_i2c.h"
+#include "linux_i2c.h"
+#include "socket_transport.h"
 #include "math.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "stdint.h"
 #include "stdbool.h"
 #include "string.h"
@@ -71,6 +79,17 @@
 #define MAX_WRITE_CMD_PAYLOAD             (FLASH_WRITE_BLOCK_SIZE + 8)
 #define MAX_READ_CMD_PAYLOAD              (FLASH_READ_BLOCK_SIZE  + 8)
 
+#define TUNING_FILE                       "dlpc347x_tuning.cfg"
+#define MAX_TUNING_KEY_LENGTH             128
+
+#define AUTO_NEGOTIATE_I2C_CLOCK          true
+#define I2C_CLOCK_VERIFY_READS            32
+#define I2C_CLOCK_VERIFY_BYTES            8    /* Bytes on the bus per verify read pair */
+
+#define COMMAND_MAX_ATTEMPTS              3
+#define COMMAND_RETRY_BASE_DELAY_MS       1
+#define COMMAND_RETRY_MAX_DELAY_MS        32
+
 static uint8_t                                   s_HorizontalPatternData[TOTAL_HORIZONTAL_PATTERNS][MAX_HEIGHT];
 static uint8_t                                   s_VerticalPatternData[TOTAL_VERTICAL_PATTERNS][MAX_WIDTH];
 static DLPC34XX_INT_PAT_PatternData_s            s_Patterns[TOTAL_HORIZONTAL_PATTERNS + TOTAL_VERTICAL_PATTERNS];
@@ -86,69 +105,197 @@ static uint16_t                                  s_FlashProgramBufferPtr;
 
 static FILE*                                     s_FilePointer;
 
+static DLPC_COMMON_Transport_s                   s_Transport;
+static const char*                               s_TransportAddress;
+static DLPC_COMMON_CommandContext_s              s_CommandContext;
+static LINUX_I2C_Device_s                        s_LinuxI2CDevice;
+static SOCKET_Client_s                           s_SocketClient;
+static DLPC_COMMON_Capture_s                     s_Capture;
+static DLPC_COMMON_Replay_s                      s_Replay;
+
+static const uint32_t                            s_I2CClockSteps[] = { 100000, 200000, 400000 };
+
+static DLPC_COMMON_RetryPolicy_s                 s_RetryPolicy;
+
+/*
+ * Commands that may be sent again after a transient I2C error. Reads of
+ * status and IDs have no side effects, and the flash start commands restart
+ * at the beginning of the selected data. Write/Read Flash Continue (0xE2,
+ * 0xE4) advance the flash address, so repeating one would skip or duplicate
+ * a block; they are left out and fail on the first error.
+ */
+static const struct
+{
+	uint8_t Opcode;
+	uint8_t Flags;
+} s_RetrySafeCommands[] =
+{
+	{ 0xD0, DLPC_COMMON_RETRY_SAFE_READ  },   /* Short Status */
+	{ 0xD1, DLPC_COMMON_RETRY_SAFE_READ  },   /* System Status */
+	{ 0xD3, DLPC_COMMON_RETRY_SAFE_READ  },   /* Communication Status */
+	{ 0xD4, DLPC_COMMON_RETRY_SAFE_READ  },   /* Controller Device ID */
+	{ 0xD5, DLPC_COMMON_RETRY_SAFE_READ  },   /* DMD Device ID */
+	{ 0x2F, DLPC_COMMON_RETRY_SAFE_READ  },   /* Input Image Size */
+	{ 0xE3, DLPC_COMMON_RETRY_SAFE_READ  },   /* Read Flash Start */
+	{ 0xDE, DLPC_COMMON_RETRY_SAFE_WRITE },   /* Flash Data Type Select */
+	{ 0xDF, DLPC_COMMON_RETRY_SAFE_WRITE },   /* Flash Data Length */
+	{ 0xE1, DLPC_COMMON_RETRY_SAFE_WRITE },   /* Write Flash Start */
+};
+
 /**
- * Implement the I2C write transaction here. The sample code here sends
- * data to the controller via the Cypress USB-Serial adapter.
+ * TI DLP Pico EVMs use a GPIO handshake scheme for the controller I2C bus
+ * arbitration. The command layer runs it once per bus session.
  */
-uint32_t WriteI2C(uint16_t             WriteDataLength,
-	uint8_t*                           WriteData,
-	DLPC_COMMON_CommandProtocolData_s* ProtocolData)
-{
-	bool Status = true;
-	//printf("Write I2C Starts, length %d!!! \n", WriteDataLength);
-	Status = CYPRESS_I2C_WriteI2C(WriteDataLength, WriteData);
-	if (Status != true)
+uint32_t AcquireI2CBus(void* UserData)
+{
+	return CYPRESS_I2C_AcquireBus(CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS) ? SUCCESS : FAIL;
+}
+
+void ReleaseI2CBus(void* UserData)
+{
+	CYPRESS_I2C_ReleaseBus();
+}
+
+void SetupRetryPolicy()
+{
+	uint32_t Index;
+
+	DLPC_COMMON_InitRetryPolicy(&s_RetryPolicy,
+	                            COMMAND_MAX_ATTEMPTS,
+	                            COMMAND_RETRY_BASE_DELAY_MS,
+	                            COMMAND_RETRY_MAX_DELAY_MS);
+
+	for (Index = 0; Index < sizeof(s_RetrySafeCommands) / sizeof(s_RetrySafeCommands[0]); Index++)
 	{
-		//printf("Write I2C Error!!! \n");
-		return FAIL;
+		DLPC_COMMON_SetRetrySafe(&s_RetryPolicy, s_RetrySafeCommands[Index].Opcode, s_RetrySafeCommands[Index].Flags);
 	}
 
-	return SUCCESS;
+	DLPC_COMMON_SetTransportRetryPolicy(&s_Transport, &s_RetryPolicy);
 }
 
 /**
- * Implement the I2C write/read transaction here. The sample code here
- * receives data from the controller via the Cypress USB-Serial adapter.
+ * Initialize the command layer by setting up the read/write buffers and 
+ * the transport. The sample uses the Cypress USB-Serial adapter, the
+ * native I2C bus given by the DLPC_I2C_DEVICE environment variable, e.g.
+ * "/dev/i2c-1@0x1B", or the dlpc_server socket given by DLPC_SERVER_SOCKET.
+ * Other transports plug in the same way.
+ *
+ * DLPC_REPLAY_FILE runs the sample against a capture (see StartCapture)
+ * instead of a controller.
+ *
+ * Returns SUCCESS, or FAIL if the replay or the transport could not be opened.
  */
-uint32_t ReadI2C(uint16_t              WriteDataLength,
-	uint8_t*                           WriteData,
-	uint16_t                           ReadDataLength,
-	uint8_t*                           ReadData,
-	DLPC_COMMON_CommandProtocolData_s* ProtocolData)
-{
-	bool Status = 0;
-	//printf("Write/Read I2C Starts, length %d!!! \n", WriteDataLength);
-	Status = CYPRESS_I2C_WriteI2C(WriteDataLength, WriteData);
-	if (Status != true)
-	{
-		//printf("Write I2C Error!!! \n");
-		return FAIL;
-	}
+uint32_t InitConnectionAndCommandLayer()
+{
+    const char* I2CDevice    = getenv("DLPC_I2C_DEVICE");
+    const char* ServerSocket = getenv("DLPC_SERVER_SOCKET");
+    const char* ReplayFile   = getenv("DLPC_REPLAY_FILE");
+    const char* TransportAddress;
 
-	Status = CYPRESS_I2C_ReadI2C(ReadDataLength, ReadData);
-	if (Status != true)
-	{
-		//printf("Read I2C Error!!! \n");
-		return FAIL;
-	}
+    if (ReplayFile != NULL)
+    {
+        if (DLPC_COMMON_OpenReplay(&s_Replay, ReplayFile) != SUCCESS)
+        {
+            DEBUG_PRINT_VARS("Could not read the capture %s\n", ReplayFile);
+            return FAIL;
+        }
+
+        DLPC_COMMON_InitReplayContext(&s_CommandContext,
+                                      &s_Replay,
+                                      s_WriteBuffer,
+                                      sizeof(s_WriteBuffer),
+                                      s_ReadBuffer,
+                                      sizeof(s_ReadBuffer));
+        DLPC_COMMON_SetCommandContext(&s_CommandContext);
+        return SUCCESS;
+    }
+
+    if (ServerSocket != NULL)
+    {
+        /* Flash programming, ahead of telemetry of other clients */
+        s_SocketClient.Priority = SOCKET_PRIORITY_HIGH;
+        DLPC_COMMON_InitTransport(&s_Transport, &SOCKET_TransportOps, &s_SocketClient);
+        TransportAddress = ServerSocket;
+    }
+    else if (I2CDevice != NULL)
+    {
+        DLPC_COMMON_InitTransport(&s_Transport, &LINUX_I2C_TransportOps, &s_LinuxI2CDevice);
+        TransportAddress = I2CDevice;
+    }
+    else
+    {
+        DLPC_COMMON_InitTransport(&s_Transport, &CYPRESS_I2C_TransportOps, NULL);
+        TransportAddress = NULL;
+    }
+    s_TransportAddress = TransportAddress;
+
+    DLPC_COMMON_InitTransportContext(&s_CommandContext,
+                                     &s_Transport,
+                                     s_WriteBuffer,
+                                     sizeof(s_WriteBuffer),
+                                     s_ReadBuffer,
+                                     sizeof(s_ReadBuffer));
+    DLPC_COMMON_SetCommandContext(&s_CommandContext);
+    SetupRetryPolicy();
+
+    if (DLPC_COMMON_OpenTransport(&s_Transport, TransportAddress) != SUCCESS)
+    {
+        DEBUG_PRINT_VARS("Could not open the %s transport\n", s_Transport.Ops->Name);
+        return FAIL;
+    }
+
+    /* Remove the bus callbacks if not using a TI EVM */
+    if (s_Transport.Ops == &SOCKET_TransportOps)
+    {
+        DLPC_COMMON_SetBusCallbacks(&s_CommandContext, SOCKET_AcquireBus, SOCKET_ReleaseBus);
+    }
+    else if (DLPC_COMMON_HasTransportCapability(&s_Transport, DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION))
+    {
+        DLPC_COMMON_SetBusCallbacks(&s_CommandContext, AcquireI2CBus, ReleaseI2CBus);
+    }
 
-	return SUCCESS;
+    return SUCCESS;
 }
 
 /**
- * Initialize the command layer by setting up the read/write buffers and 
- * callbacks.
+ * DLPC_CAPTURE_FILE records all commands from here on to a capture file.
+ * Starts after the transport setup (e.g. SetupI2CClock), which depends on
+ * the adapter and is not repeated on replay.
  */
-void InitConnectionAndCommandLayer()
+void StartCapture()
 {
-    DLPC_COMMON_InitCommandLibrary(s_WriteBuffer,
-                                   sizeof(s_WriteBuffer),
-                                   s_ReadBuffer,
-                                   sizeof(s_ReadBuffer),
-                                   WriteI2C,
-                                   ReadI2C);
+    const char* CaptureFile = getenv("DLPC_CAPTURE_FILE");
 
-    CYPRESS_I2C_ConnectToCyI2C();
+    if ((CaptureFile == NULL) || (s_Replay.File.Data != NULL))
+    {
+        return;
+    }
+
+    if (DLPC_COMMON_StartCapture(&s_Capture, &s_CommandContext, CaptureFile) != SUCCESS)
+    {
+        DEBUG_PRINT_VARS("Could not create the capture %s\n", CaptureFile);
+    }
+}
+
+void CloseConnection()
+{
+    if (s_Capture.Context != NULL)
+    {
+        printf("Captured %u commands\n", s_Capture.NumRecords);
+        DLPC_COMMON_StopCapture(&s_Capture);
+    }
+
+    if (s_Replay.File.Data != NULL)
+    {
+        printf("Replayed %u commands, %u mismatches\n", s_Replay.RecordIndex, s_Replay.Mismatches);
+        if (s_Replay.Mismatches > 0)
+        {
+            printf("First mismatch at command %u\n", s_Replay.FirstMismatchRecord);
+        }
+        DLPC_COMMON_CloseReplay(&s_Replay);
+    }
+
+    DLPC_COMMON_CloseTransport(&s_Transport);
 }
 
 void WaitForSeconds(uint32_t Seconds)
@@ -620,49 +767,183 @@ void WriteLookSelect(uint8_t LookNumber)
 	WaitForSeconds(5);
 }
 
-void LoadPreBuildPatternData()
+/**
+ * Builds the tuning key of the flash block size. The key names the active
+ * transport, the adapter (the Cypress serial number, or the device or socket
+ * path the transport was opened with) and the controller.
+ */
+void GetFlashBlockSizeTuningKey(char* TuningKey)
 {
-	/* write up to 1024 bytes of data */
-	uint8_t PatternDataArray[1024];
+	DLPC34XX_ControllerDeviceId_e DeviceId = 0;
+	const char*                   TransportName = "replay";
+	const char*                   Adapter = s_TransportAddress;
+	char*                         Space;
 
-	/* Pattern File assumes to be in the \build\vs2017\dlpc347x folder */
-	s_FilePointer = fopen("pattern_data_gui.bin", "rb");
-	if (!s_FilePointer)
+	if (s_Transport.Ops == &CYPRESS_I2C_TransportOps)
 	{
-		//printf("Error opening the binary file!");
-		return;
+		Adapter = CYPRESS_I2C_GetSerialNumber();
+	}
+	if (s_Transport.Ops != NULL)
+	{
+		TransportName = s_Transport.Ops->Name;
 	}
-	fseek(s_FilePointer, 0, SEEK_END);
-	uint32_t PatternDataSize = ftell(s_FilePointer);
-	fseek(s_FilePointer, 0, SEEK_SET);
 
-	/* Select Flash Data Block and Erase the Block */
-	DLPC34XX_WriteFlashDataTypeSelect(DLPC34XX_FDTS_ENTIRE_SENS_PATTERN_DATA);
-	DLPC34XX_WriteFlashErase();
+	DLPC34XX_ReadControllerDeviceId(&DeviceId);
+	snprintf(TuningKey, MAX_TUNING_KEY_LENGTH, "%s/%s/%d/flash_block_size",
+	         TransportName, (Adapter != NULL) ? Adapter : "default", DeviceId);
 
-	/* Read Short Status to make sure Erase is completed */
-	DLPC34XX_ShortStatus_s ShortStatus;
-	do
+	/* Tuning keys can't contain spaces */
+	while ((Space = strchr(TuningKey, ' ')) != NULL)
 	{
-		DLPC34XX_ReadShortStatus(&ShortStatus);
-	} while (ShortStatus.FlashEraseComplete == DLPC34XX_FE_NOT_COMPLETE);
+		*Space = '_';
+	}
+}
+
+/**
+ * Uses the flash block size stored for this adapter and controller, or
+ * enables block size tuning when none has been stored yet.
+ */
+void LoadFlashBlockSize(DLPC34XX_FlashProgramOptions_s* Options, char* TuningKey)
+{
+	uint32_t BlockSize;
 
-	DLPC34XX_WriteFlashDataLength(1024);
-	fread(PatternDataArray, sizeof(PatternDataArray), 1, s_FilePointer);
-	DLPC34XX_WriteFlashStart(1024, PatternDataArray);
+	GetFlashBlockSizeTuningKey(TuningKey);
 
-	int32_t BytesLeft = PatternDataSize - 1024;
-	do
+	if (DLPC_COMMON_LoadTunedValue(TUNING_FILE, TuningKey, &BlockSize) == 0)
+	{
+		Options->BlockSize = (uint16_t)BlockSize;
+	}
+	else
 	{
-		fread(PatternDataArray, sizeof(PatternDataArray), 1, s_FilePointer);
-		DLPC34XX_WriteFlashContinue(1024, PatternDataArray);
+		Options->AutoTuneBlockSize = true;
+	}
+}
 
-		BytesLeft = BytesLeft - 1024;
-	} while (BytesLeft > 0);
+void SaveFlashBlockSize(const DLPC34XX_FlashProgramOptions_s* Options,
+                        const DLPC34XX_FlashProgramResult_s* Result,
+                        const char* TuningKey)
+{
+	if (Options->AutoTuneBlockSize)
+	{
+		printf("Flash block size tuned to %u bytes\n", Result->BlockSize);
+		if (DLPC_COMMON_SaveTunedValue(TUNING_FILE, TuningKey, Result->BlockSize) != SUCCESS)
+		{
+			printf("Could not store the flash block size in %s\n", TUNING_FILE);
+		}
+	}
+}
+
+/**
+ * Reads known registers repeatedly at the current I2C clock and compares them
+ * against the reference values. Fails on the first failed or mismatched read.
+ */
+bool VerifyI2CClock(DLPC34XX_ControllerDeviceId_e ControllerId, uint32_t DmdId, double* BytesPerSecond)
+{
+	DLPC34XX_ControllerDeviceId_e ReadControllerId;
+	uint32_t                      ReadDmdId;
+	uint64_t                      StartTime = DLPC_COMMON_GetTimeInMicroseconds();
+	uint64_t                      ElapsedTime;
+	uint32_t                      Read;
+
+	for (Read = 0; Read < I2C_CLOCK_VERIFY_READS; Read++)
+	{
+		if ((DLPC34XX_ReadControllerDeviceId(&ReadControllerId) != 0) ||
+			(ReadControllerId != ControllerId) ||
+			(DLPC34XX_ReadDmdDeviceId(DLPC34XX_DDS_DMD_DEVICE_ID, &ReadDmdId) != 0) ||
+			(ReadDmdId != DmdId))
+		{
+			return false;
+		}
+	}
+
+	ElapsedTime = DLPC_COMMON_GetTimeInMicroseconds() - StartTime;
+	*BytesPerSecond = (ElapsedTime > 0) ? (I2C_CLOCK_VERIFY_READS * I2C_CLOCK_VERIFY_BYTES * 1e6) / ElapsedTime : 0;
+	return true;
+}
 
-	fclose(s_FilePointer);
+/**
+ * Steps the I2C clock up while the controller keeps reading back correctly
+ * and returns the fastest clock that passed. The bridge is left at that clock.
+ */
+uint32_t NegotiateI2CClock()
+{
+	DLPC34XX_ControllerDeviceId_e ControllerId;
+	uint32_t                      DmdId;
+	uint32_t                      BestFrequency = CYPRESS_I2C_GetClockFrequency();
+	double                        BytesPerSecond;
+	uint32_t                      Step;
+
+	/* The reference values are read at the clock the bridge was opened with */
+	if ((DLPC34XX_ReadControllerDeviceId(&ControllerId) != 0) ||
+		(DLPC34XX_ReadDmdDeviceId(DLPC34XX_DDS_DMD_DEVICE_ID, &DmdId) != 0))
+	{
+		printf("Unable to read the reference registers, keeping the I2C clock at %u Hz\n", BestFrequency);
+		return BestFrequency;
+	}
+
+	for (Step = 0; Step < sizeof(s_I2CClockSteps) / sizeof(s_I2CClockSteps[0]); Step++)
+	{
+		if (!CYPRESS_I2C_SetClockFrequency(s_I2CClockSteps[Step]) ||
+			!VerifyI2CClock(ControllerId, DmdId, &BytesPerSecond))
+		{
+			printf("I2C clock %u Hz: verification failed\n", s_I2CClockSteps[Step]);
+			break;
+		}
+
+		printf("I2C clock %u Hz: %.0f bytes/s\n", s_I2CClockSteps[Step], BytesPerSecond);
+		BestFrequency = s_I2CClockSteps[Step];
+	}
+
+	CYPRESS_I2C_SetClockFrequency(BestFrequency);
+	return BestFrequency;
+}
+
+/**
+ * Uses the I2C clock stored for this adapter, or negotiates and stores one
+ * when none has been stored yet.
+ */
+void SetupI2CClock()
+{
+	char     TuningKey[96];
+	uint32_t FrequencyHz;
+
+	sprintf(TuningKey, "cypress/%s/i2c_clock_hz", CYPRESS_I2C_GetSerialNumber());
+
+	if (DLPC_COMMON_LoadTunedValue(TUNING_FILE, TuningKey, &FrequencyHz) == 0)
+	{
+		CYPRESS_I2C_SetClockFrequency(FrequencyHz);
+	}
+	else if (AUTO_NEGOTIATE_I2C_CLOCK)
+	{
+		FrequencyHz = NegotiateI2CClock();
+		printf("I2C clock negotiated to %u Hz\n", FrequencyHz);
+		DLPC_COMMON_SaveTunedValue(TUNING_FILE, TuningKey, FrequencyHz);
+	}
 }
 
+void LoadPreBuildPatternData()
+{
+	DLPC34XX_FlashProgramOptions_s Options = { 0, true, false, false, 0, NULL };
+	DLPC34XX_FlashProgramResult_s  Result;
+	char                           TuningKey[MAX_TUNING_KEY_LENGTH];
+
+	LoadFlashBlockSize(&Options, TuningKey);
+
+	/* Pattern File assumes to be in the \build\vs2017\dlpc347x folder */
+	uint32_t Status = DLPC34XX_FLASH_ProgramFlashFromFile("pattern_data_gui.bin",
+	                                                      DLPC34XX_FDTS_ENTIRE_SENS_PATTERN_DATA,
+	                                                      &Options,
+	                                                      &Result);
+	if (Status != 0)
+	{
+		printf("Error programming the pattern data (%u)!\n", Status);
+		return;
+	}
+
+	SaveFlashBlockSize(&Options, &Result, TuningKey);
+
+	printf("Programmed %u bytes of pattern data at %.0f bytes/s\n", Result.BytesProgrammed, Result.BytesPerSecond);
+}
 
 void WriteLabbCaic()
 {
@@ -695,66 +976,93 @@ void WriteLabbCaic()
 
 void LoadFirmware()
 {
-	/* write up to 1024 bytes of data */
-	uint8_t FlashDataArray[1024];
+	DLPC34XX_FlashProgramOptions_s Options = { 0, true, true, false, 0, NULL };
+	DLPC34XX_FlashProgramResult_s  Result;
+	char                           TuningKey[MAX_TUNING_KEY_LENGTH];
+
+	LoadFlashBlockSize(&Options, TuningKey);
 
 	/* Pattern File assumes to be in the \build\vs2017\dlpc343x folder */
-	s_FilePointer = fopen("dlpc3470_7.4.0.img", "rb");
-	if (!s_FilePointer)
+	uint32_t Status = DLPC34XX_FLASH_ProgramFlashFromFile("dlpc3470_7.4.0.img",
+	                                                      DLPC34XX_FDTS_ENTIRE_FLASH,
+	                                                      &Options,
+	                                                      &Result);
+	if (Status == ERR_FLASH_VERIFY_MISMATCH)
 	{
-		printf("Error opening the flash image file!");
+		printf("Flash verification failed at offset %u!\n", Result.VerifyResult.FirstMismatchOffset);
+		return;
+	}
+	else if (Status != 0)
+	{
+		printf("Error programming the flash image (%u)!\n", Status);
 		return;
 	}
-	fseek(s_FilePointer, 0, SEEK_END);
-	uint32_t FlashDataSize = ftell(s_FilePointer);
-	fseek(s_FilePointer, 0, SEEK_SET);
 
-	/* Select Flash Data Block and Erase the Block */
-	DLPC34XX_WriteFlashDataTypeSelect(DLPC34XX_FDTS_ENTIRE_FLASH);
-	DLPC34XX_WriteFlashErase();
+	SaveFlashBlockSize(&Options, &Result, TuningKey);
 
-	/* Read Short Status to make sure Erase is completed */
-	DLPC34XX_ShortStatus_s ShortStatus;
-	do
-	{
-		WaitForSeconds(1);
-		DLPC34XX_ReadShortStatus(&ShortStatus);
-	} while (ShortStatus.FlashEraseComplete == DLPC34XX_FE_NOT_COMPLETE);
+	printf("Programmed %u bytes at %.0f bytes/s, CRC32C 0x%08X\n",
+	       Result.BytesProgrammed, Result.BytesPerSecond, Result.VerifyResult.FlashCrc32c);
+}
 
-	DLPC34XX_WriteFlashDataLength(1024);
-	fread(FlashDataArray, sizeof(FlashDataArray), 1, s_FilePointer);
-	DLPC34XX_WriteFlashStart(1024, FlashDataArray);
+void PrintLeaseStatistics()
+{
+	CYPRESS_I2C_LeaseStatistics_s Statistics;
+
+	CYPRESS_I2C_GetLeaseStatistics(&Statistics);
+	printf("I2C bus: %u leases, %u nested, %u failed, %u grant polls\n",
+	       Statistics.Leases, Statistics.NestedAcquisitions, Statistics.FailedAcquisitions, Statistics.GrantPolls);
+	printf("I2C bus: waited %.1f ms (max %.1f ms), held %.1f ms (max %.1f ms)\n",
+	       Statistics.TotalWaitMicroseconds / 1000.0, Statistics.MaxWaitMicroseconds / 1000.0,
+	       Statistics.TotalHeldMicroseconds / 1000.0, Statistics.MaxHeldMicroseconds / 1000.0);
+}
 
-	int32_t BytesLeft = FlashDataSize - 1024;
-	do
-	{
-		fread(FlashDataArray, sizeof(FlashDataArray), 1, s_FilePointer);
-		DLPC34XX_WriteFlashContinue(1024, FlashDataArray);
+void PrintTransportStatistics()
+{
+	const DLPC_COMMON_TransportStatistics_s* Statistics = &s_Transport.Statistics;
+
+	printf("Commands: %u sent, %u transient errors, %u fatal errors\n",
+	       Statistics->Commands, Statistics->TransientErrors, Statistics->FatalErrors);
+	printf("Commands: %u retries, %u recovered, %u not retry safe\n",
+	       Statistics->Retries, Statistics->RecoveredCommands, Statistics->UnsafeFailures);
 
-		BytesLeft = BytesLeft - 1024;
-	} while (BytesLeft > 0);
+	if (s_Transport.Ops == &CYPRESS_I2C_TransportOps)
+	{
+		CYPRESS_I2C_ErrorStatistics_s Errors;
 
-	fclose(s_FilePointer);
+		CYPRESS_I2C_GetErrorStatistics(&Errors);
+		printf("I2C errors: %u NAKs, %u timeouts, %u bus errors, %u fatal, %u resets\n",
+		       Errors.Naks, Errors.Timeouts, Errors.BusErrors, Errors.FatalErrors, Errors.Resets);
+	}
 }
 
 void main()
 {
     DEBUG_PRINT_VARS("Starting the DLPC347x Sample Program...\n");
 
-	InitConnectionAndCommandLayer();
+	if (InitConnectionAndCommandLayer() != SUCCESS)
+	{
+		CloseConnection();
+		exit(FAIL);
+	}
     DEBUG_PRINT_VARS("Init Connection And CommandLayer done..\n");
 
-    /* TI DLP Pico EVMs use a GPIO handshake scheme for the controller I2C bus
-     * arbitration. Call this method if using a TI EVM, remove otherwise
+    /* Hold the I2C bus for the whole sample. The flash jobs below start
+     * nested sessions and reuse this one instead of arbitrating again.
      */
-	bool Status = CYPRESS_I2C_RequestI2CBusAccess();
-	if (Status != true)
+	if (DLPC_COMMON_AcquireBus() != SUCCESS)
 	{
 		//printf("Error Request I2C Bus ACCESS!!!");
         DEBUG_PRINT_VARS("Error requesting I2C Bus Access\n");
 		return;
 	}
-    
+
+	if (s_Transport.Ops == &CYPRESS_I2C_TransportOps)
+	{
+		SetupI2CClock();
+	}
+
+	StartCapture();
+
 	DLPC34XX_ControllerDeviceId_e DeviceId = 0;
 	DLPC34XX_ReadControllerDeviceId(&DeviceId);
     DEBUG_PRINT_VARS("Controller Device Id = %d\n", DeviceId);
@@ -811,5 +1119,12 @@ void main()
 	WaitForSeconds(20);
 	DLPC34XX_WriteInternalPatternControl(DLPC34XX_PC_STOP, 0);
 
-	CYPRESS_I2C_RelinquishI2CBusAccess();
+	DLPC_COMMON_ReleaseBus();
+	if (s_Transport.Ops == &CYPRESS_I2C_TransportOps)
+	{
+		PrintLeaseStatistics();
+	}
+	PrintTransportStatistics();
+
+	CloseConnection();
 }
@@ -0,0 +1,270 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Sample code that programs the same flash image to every DLPC347x
+ *         controller attached through a Cypress USB-Serial bridge. The
+ *         controllers are programmed concurrently, one thread per bridge.
+ */
+
+#include "dlpc_common.h"
+#include "dlpc34xx.h"
+#include "dlpc34xx_flash.h"
+#include "dlpc34xx_fleet.h"
+#include "cypress_i2c.h"
+#include "stdio.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+#define FLASH_WRITE_BLOCK_SIZE            1024
+#define FLASH_READ_BLOCK_SIZE             256
+
+#define MAX_WRITE_CMD_PAYLOAD             (FLASH_WRITE_BLOCK_SIZE + 8)
+#define MAX_READ_CMD_PAYLOAD              (FLASH_READ_BLOCK_SIZE  + 8)
+
+#define PROGRESS_INTERVAL_MILLISECONDS    1000
+
+typedef struct
+{
+    CYPRESS_I2C_Device_s         Bridge;
+    DLPC_COMMON_CommandContext_s Context;
+    uint8_t                      WriteBuffer[MAX_WRITE_CMD_PAYLOAD];
+    uint8_t                      ReadBuffer[MAX_READ_CMD_PAYLOAD];
+} Controller_s;
+
+static Controller_s           s_Controllers[CYPRESS_I2C_MAX_DEVICES];
+static DLPC34XX_FleetDevice_s s_FleetDevices[CYPRESS_I2C_MAX_DEVICES];
+
+static const char* s_PhaseNames[] = { "Erasing", "Programming", "Verifying" };
+
+/**
+ * The command callbacks run on the thread of the controller being programmed
+ * and find its bridge through the command context of that thread.
+ */
+uint32_t WriteI2C(uint16_t             WriteDataLength,
+	uint8_t*                           WriteData,
+	DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+	Controller_s* Controller = (Controller_s*)DLPC_COMMON_GetCommandContext()->UserData;
+
+	if (!CYPRESS_I2C_DeviceWriteI2C(&Controller->Bridge, WriteDataLength, WriteData))
+	{
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+uint32_t ReadI2C(uint16_t              WriteDataLength,
+	uint8_t*                           WriteData,
+	uint16_t                           ReadDataLength,
+	uint8_t*                           ReadData,
+	DLPC_COMMON_CommandProtocolData_s* ProtocolData)
+{
+	Controller_s* Controller = (Controller_s*)DLPC_COMMON_GetCommandContext()->UserData;
+
+	if (!CYPRESS_I2C_DeviceWriteReadI2C(&Controller->Bridge, WriteDataLength, WriteData, ReadDataLength, ReadData))
+	{
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * TI DLP Pico EVMs use a GPIO handshake scheme for the controller I2C bus
+ * arbitration. Each flash job holds the bus of its controller for its whole
+ * duration. Remove the bus callbacks if not using a TI EVM.
+ */
+uint32_t AcquireI2CBus(void* UserData)
+{
+	Controller_s* Controller = (Controller_s*)UserData;
+
+	if (!CYPRESS_I2C_DeviceAcquireBus(&Controller->Bridge, CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS))
+	{
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+void ReleaseI2CBus(void* UserData)
+{
+	Controller_s* Controller = (Controller_s*)UserData;
+
+	CYPRESS_I2C_DeviceReleaseBus(&Controller->Bridge);
+}
+
+/**
+ * Opens every bridge found and sets up a command context for it
+ */
+uint32_t OpenControllers()
+{
+	uint8_t  NumBridges;
+	uint8_t  Index;
+	uint32_t NumControllers = 0;
+
+	CYPRESS_I2C_Device_s Bridges[CYPRESS_I2C_MAX_DEVICES];
+
+	NumBridges = CYPRESS_I2C_EnumerateDevices(Bridges, CYPRESS_I2C_MAX_DEVICES);
+
+	for (Index = 0; Index < NumBridges; Index++)
+	{
+		Controller_s* Controller = &s_Controllers[NumControllers];
+
+		Controller->Bridge = Bridges[Index];
+		if (!CYPRESS_I2C_OpenDevice(&Controller->Bridge))
+		{
+			printf("Could not open bridge %u (%s)\n", Bridges[Index].DeviceIndex, Bridges[Index].SerialNumber);
+			continue;
+		}
+
+		DLPC_COMMON_InitCommandContext(&Controller->Context,
+		                               Controller->WriteBuffer,
+		                               sizeof(Controller->WriteBuffer),
+		                               Controller->ReadBuffer,
+		                               sizeof(Controller->ReadBuffer),
+		                               WriteI2C,
+		                               ReadI2C,
+		                               Controller);
+		DLPC_COMMON_SetBusCallbacks(&Controller->Context, AcquireI2CBus, ReleaseI2CBus);
+
+		s_FleetDevices[NumControllers].Context = &Controller->Context;
+		s_FleetDevices[NumControllers].Name    = Controller->Bridge.SerialNumber;
+		NumControllers++;
+	}
+
+	return NumControllers;
+}
+
+void CloseControllers(uint32_t NumControllers)
+{
+	uint32_t Index;
+
+	for (Index = 0; Index < NumControllers; Index++)
+	{
+		CYPRESS_I2C_CloseDevice(&s_Controllers[Index].Bridge);
+	}
+}
+
+void PrintProgressTable(DLPC34XX_Fleet_s* Fleet)
+{
+	uint64_t Elapsed = DLPC_COMMON_GetTimeInMicroseconds() - Fleet->StartTime;
+	uint32_t Index;
+
+	printf("\n%-4s %-24s %-12s %9s\n", "#", "Bridge", "State", "Progress");
+	for (Index = 0; Index < Fleet->DeviceCount; Index++)
+	{
+		DLPC34XX_FleetDevice_s* Device = &Fleet->Devices[Index];
+		const char*             State  = s_PhaseNames[Device->Phase];
+
+		if (Device->Done)
+		{
+			State = "Done";
+		}
+
+		printf("%-4u %-24s %-12s %8.1f%%\n",
+		       Index,
+		       Device->Name,
+		       State,
+		       (Fleet->Image.Size > 0) ? (100.0 * Device->BytesProgrammed) / Fleet->Image.Size : 0.0);
+	}
+	printf("Elapsed %.1f s\n", Elapsed / 1000000.0);
+}
+
+int main(int argc, char** argv)
+{
+	DLPC34XX_FlashProgramOptions_s Options = { 0, true, true, false, 0, NULL };
+	DLPC34XX_Fleet_s               Fleet;
+	uint32_t                       NumControllers;
+	uint32_t                       Status;
+	uint32_t                       Index;
+
+	if (argc < 2)
+	{
+		printf("Usage: %s /path/to/flash/image\n", argv[0]);
+		return 1;
+	}
+
+	NumControllers = OpenControllers();
+	if (NumControllers == 0)
+	{
+		printf("No controllers found\n");
+		return 1;
+	}
+
+	printf("Programming %s to %u controllers\n", argv[1], NumControllers);
+
+	Status = DLPC34XX_FLEET_Start(&Fleet,
+	                              argv[1],
+	                              DLPC34XX_FDTS_ENTIRE_FLASH,
+	                              &Options,
+	                              s_FleetDevices,
+	                              NumControllers);
+	if (Status == ERR_FILE_ACCESS)
+	{
+		printf("Could not open %s\n", argv[1]);
+		CloseControllers(NumControllers);
+		return 1;
+	}
+
+	while (!DLPC34XX_FLEET_Wait(&Fleet, PROGRESS_INTERVAL_MILLISECONDS))
+	{
+		PrintProgressTable(&Fleet);
+	}
+	PrintProgressTable(&Fleet);
+
+	Status = DLPC34XX_FLEET_Finish(&Fleet);
+
+	printf("\n%-4s %-24s %-8s %12s %12s %12s\n", "#", "Bridge", "Status", "Bytes/s", "CRC32C", "Bus wait ms");
+	for (Index = 0; Index < NumControllers; Index++)
+	{
+		DLPC34XX_FleetDevice_s*       Device = &s_FleetDevices[Index];
+		CYPRESS_I2C_LeaseStatistics_s Statistics;
+
+		CYPRESS_I2C_DeviceGetLeaseStatistics(&s_Controllers[Index].Bridge, &Statistics);
+
+		printf("%-4u %-24s %-8u %12.0f   0x%08X %12.1f\n",
+		       Index,
+		       Device->Name,
+		       Device->Status,
+		       Device->Result.BytesPerSecond,
+		       Device->Result.VerifyResult.FlashCrc32c,
+		       Statistics.TotalWaitMicroseconds / 1000.0);
+	}
+
+	CloseControllers(NumControllers);
+
+	return Status == 0 ? 0 : 1;
+}
@@ -1,6 +1,9 @@
 #include "dlpc654x_sample.h"
+#include "flash_checksum.h"
 #include "../../api/dlpc_common.h"
 #include "../../api/dlpc_common_private.h"
+#include "../../api/dlpc_common_platform.h"
+#include "../../api/dlpc_common_tuning.h"
 
 #ifdef _WIN32
 #include "win_io.h"
@@ -15,6 +18,7 @@
 #include <string.h>
 
 #define MODE_SWITCH_TIMEOUT_S 30
+#define MODE_POLL_INTERVAL_MS 50
 
 #define MAX_WIDTH                         DLP2010_WIDTH
 #define MAX_HEIGHT                        DLP2010_HEIGHT
@@ -27,19 +31,208 @@
 
 #define HEADER_LENGTH					  3
 
-static uint8_t                            s_WriteBuffer[MAX_WRITE_CMD_PAYLOAD];
-static uint8_t                            s_ReadBuffer[UINT16_MAX];
+#define TUNING_FILE						  "dlpc654x_tuning.cfg"
+#ifdef _WIN32
+#define TUNING_TRANSPORT_NAME			  "winusb"
+#else
+#define TUNING_TRANSPORT_NAME			  "libusb"
+#endif
+#define MAX_TUNING_KEY_LENGTH			  128
+#define MIN_TUNED_BLOCK_SIZE			  64
+
+#define CHECKSUM_THREADS				  4
+#define CHECKSUM_READ_BLOCK_SIZE		  (64 * 1024)
+#define MAX_COALESCED_SECTORS			  16 // a run that doesn't match costs one request per sector
+
+#define WRITE_FAILED					  0xFFFFFFFF
+#define READ_FAILED						  0xFFFF
+#define ASYNC_TRANSFERS					  8
+#define MAX_PROJECTORS					  16
+#define FLEET_POLL_INTERVAL_MS			  50
+#define FLEET_PROGRESS_INTERVAL_MS		  1000
+
+/*
+ * Framing buffers and device for one command context, found through the context's UserData.
+ * The command library packs each command at frame + HEADER_LENGTH, so doWrite and doRead
+ * only fill in the header in front of it. Nothing is allocated per command.
+*/
+struct CommandFrame
+{
+	uint8_t frame[HEADER_LENGTH + MAX_WRITE_CMD_PAYLOAD];
+	uint8_t responseHeader[HEADER_LENGTH];
+	uint8_t readBuffer[UINT16_MAX];
+	IoDevice* device;
+	uint8_t queueWrites;
+	uint8_t queuedAckFailed; // set by checkQueuedAck, collected after ioDeviceFlush
+};
+
+static CommandFrame                       s_CommandFrame;
+
+// the block size is kept per thread, every projector of a fleet update is programmed on its own thread
+static DLPC_COMMON_THREAD_LOCAL uint16_t                     s_FlashBlockSize = MAX_BLOCK_SIZE;
+static DLPC_COMMON_THREAD_LOCAL uint8_t                      s_TuneFlashBlockSize = 0;
+static DLPC_COMMON_THREAD_LOCAL DLPC_COMMON_BlockSizeTuner_s s_FlashBlockSizeTuner;
+
+enum FleetPhase
+{
+	FLEET_CONNECTING = 0,
+	FLEET_ERASING,
+	FLEET_PROGRAMMING,
+	FLEET_VERIFYING,
+	FLEET_SWITCHING
+};
+
+/*
+ * One projector of a fleet update. The progress fields are written by the thread updating the
+ * projector and read by the thread printing the progress table.
+*/
+typedef struct
+{
+	Projector            projector;
+	IoDeviceInfo         info;
+	const FlashImage*    image;
+	char*                filePath;
+	uint8_t              flashModifiedSectorsOnly;
+	enum FlashType       flashType;
+	DLPC_COMMON_Thread_s thread;
+	uint8_t              threadStarted;
+	volatile uint32_t    phase;
+	volatile uint32_t    sector;
+	volatile uint32_t    numSectors;
+	volatile uint32_t    done;
+	uint32_t             status;
+} FleetProjector;
+
+static FleetProjector                     s_FleetProjectors[MAX_PROJECTORS];
+static DLPC_COMMON_THREAD_LOCAL FleetProjector* s_FleetProjector;
+
+static const char* s_FleetPhaseNames[] = { "Connecting", "Erasing", "Programming", "Verifying", "Switching" };
 
 uint8_t doLog = 0;
 
 char flashTableSignature[] = { 0xF7, 0xA5, 0x47, 0xAB, 0x7E, 0x51, 0x62, 0xA7 };
 
-extern uint8_t variableLengthRead;
+static CommandFrame* getCommandFrame()
+{
+	CommandFrame* commandFrame = (CommandFrame*)DLPC_COMMON_GetCommandContext()->UserData;
+
+	return commandFrame ? commandFrame : &s_CommandFrame;
+}
+
+static void setFleetPhase(enum FleetPhase phase)
+{
+	if (s_FleetProjector)
+	{
+		DLPC_COMMON_AtomicStore(&s_FleetProjector->phase, phase);
+	}
+}
+
+/*
+ * @brief reports the sector being worked on, in the progress table during a fleet update and on stdout otherwise
+*/
+static void reportSector(enum FleetPhase phase, const char* description, uint32_t sector, uint32_t numSectors)
+{
+	if (!s_FleetProjector)
+	{
+		printf("%s (%d of %d)\n", description, sector + 1, numSectors);
+		return;
+	}
+
+	DLPC_COMMON_AtomicStore(&s_FleetProjector->numSectors, numSectors);
+	DLPC_COMMON_AtomicStore(&s_FleetProjector->sector, sector + 1);
+	setFleetPhase(phase);
+}
+
+/*
+ * @brief fills in the message header, opcode and length in front of the packed command
+ * @return the length of the frame, 0 if the command doesn't fit in the frame
+*/
+static uint32_t buildFrame(CommandFrame* commandFrame, union MessageHeader header, uint16_t writeDataLength, uint8_t* writeData)
+{
+	uint8_t* frame = commandFrame->frame;
+
+	if (writeDataLength < 1 || writeDataLength > MAX_WRITE_CMD_PAYLOAD)
+	{
+		return 0;
+	}
+
+	// commands packed into another buffer are moved into place, the library's own buffer already is
+	if (writeData != frame + HEADER_LENGTH)
+	{
+		memmove(frame + HEADER_LENGTH, writeData, writeDataLength);
+	}
+
+	// the opcode moves in front of the length, the payload stays where it was packed
+	frame[1] = frame[HEADER_LENGTH];
+	frame[0] = header.headerInt;
+	frame[2] = (writeDataLength - 1) & 0xFF; // remove opcode from length
+	frame[3] = (writeDataLength - 1) >> 8;
+
+	return HEADER_LENGTH + writeDataLength;
+}
+
+/*
+ * @brief gets the length of the payload following a response header, from its length field
+*/
+static uint16_t getResponseLength(const uint8_t* responseHeader)
+{
+	return (uint16_t)(responseHeader[1] | (responseHeader[2] << 8));
+}
+
+/*
+ * @brief checks the ACK of a queued write, a response header and the payload its length field announces
+*/
+static void checkQueuedAck(uint32_t status, const uint8_t* data, uint32_t length, void* userData)
+{
+	CommandFrame* commandFrame = (CommandFrame*)userData;
+
+	// transfer errors are reported by ioDeviceFlush
+	if (!status && (length < HEADER_LENGTH || length < HEADER_LENGTH + getResponseLength(data)))
+	{
+		commandFrame->queuedAckFailed = 1;
+	}
+}
+
+/*
+ * @brief reads the ACK of a write, a response header and the payload its length field announces
+ * @return 0 if a complete ACK was read, READ_FAILED otherwise
+*/
+static uint32_t readAck(CommandFrame* commandFrame)
+{
+	uint8_t* responseHeader = commandFrame->responseHeader;
+
+	if (ioDeviceRead(commandFrame->device, responseHeader, HEADER_LENGTH) != HEADER_LENGTH)
+	{
+		return READ_FAILED;
+	}
+
+	uint16_t responseLength = getResponseLength(responseHeader);
+
+	if (responseLength > 0 && ioDeviceRead(commandFrame->device, commandFrame->readBuffer, responseLength) != responseLength)
+	{
+		return READ_FAILED;
+	}
+
+	return 0;
+}
+
+static void logFrame(const char* prefix, const uint8_t* frame, uint32_t frameLength)
+{
+	printf("%s", prefix);
+
+	for (uint32_t i = 0; i < frameLength; i++)
+	{
+		printf("0x%02X ", frame[i]);
+	}
+	printf("\n");
+}
 
 uint32_t doWrite(uint16_t writeDataLength,
 	uint8_t* writeData,
 	DLPC_COMMON_CommandProtocolData_s* protocolData)
 {
+	CommandFrame* commandFrame = getCommandFrame();
+
 	union MessageHeader header;
 	header.headerStruct.destination = (uint8_t)protocolData->CommandDestination;
 	header.headerStruct.opcodeLen = 0;
@@ -49,50 +242,40 @@ uint32_t doWrite(uint16_t writeDataLength,
 	header.headerStruct.isRead = 0;
 	// 0x51
 
-	uint32_t fullWriteLength = HEADER_LENGTH + writeDataLength;
-
-	if (fullWriteLength < 4)
-	{
-		return 1;
-	}
-
-	unsigned char* fullWriteData = (unsigned char*)malloc(fullWriteLength);
+	uint32_t fullWriteLength = buildFrame(commandFrame, header, writeDataLength, writeData);
 
-	if (!fullWriteData)
+	if (fullWriteLength == 0)
 	{
 		return 1;
 	}
 
-	fullWriteData[0] = header.headerInt;
-	fullWriteData[1] = writeData[0];
-	fullWriteData[2] = (writeDataLength - 1) & 0xFF; // remove opcode from length
-	fullWriteData[3] = (writeDataLength - 1) >> 8;
-
-	for (int32_t i = 0; i < writeDataLength - 1; ++i)
+	if (doLog)
 	{
-		fullWriteData[i + 4] = writeData[i + 1];
+		logFrame("WRITE ", commandFrame->frame, fullWriteLength);
 	}
 
-	if (doLog)
+	if (commandFrame->queueWrites)
 	{
-		printf("WRITE ");
-
-		for (uint32_t i = 0; i < fullWriteLength; i++)
+		// the write and the read of its ACK are queued behind the ones in flight, ioDeviceFlush collects them
+		if (ioDeviceSubmitWrite(commandFrame->device, commandFrame->frame, fullWriteLength, NULL, NULL, NULL)
+			|| ioDeviceSubmitRead(commandFrame->device, HEADER_LENGTH, checkQueuedAck, commandFrame, NULL))
 		{
-			printf("0x%02X ", (unsigned char)fullWriteData[i]);
+			return 1;
 		}
-		printf("\n");
+		return 0;
 	}
 
-	ioWrite(fullWriteData, fullWriteLength);
+	if (ioDeviceWrite(commandFrame->device, commandFrame->frame, fullWriteLength) == WRITE_FAILED)
+	{
+		return 1;
+	}
 	
 	if (header.headerStruct.replyReq)
 	{
-		// make room for 2 length bits
-		uint8_t readLength = 2 + (header.headerStruct.hasDataLen * 2);
-		char* readData = (char*)malloc(sizeof(char) * readLength);
-
-		ioRead(readData, readLength);
+		if (readAck(commandFrame) == READ_FAILED)
+		{
+			return 1;
+		}
 	}
 
 	return 0;
@@ -104,6 +287,8 @@ uint32_t doRead(uint16_t               writeDataLength,
 	uint8_t*                           readData,
 	DLPC_COMMON_CommandProtocolData_s* protocolData)
 {
+	CommandFrame* commandFrame = getCommandFrame();
+
 	union MessageHeader header;
 	header.headerStruct.destination = (uint8_t)protocolData->CommandDestination;
 	header.headerStruct.opcodeLen = 0;
@@ -113,118 +298,59 @@ uint32_t doRead(uint16_t               writeDataLength,
 	header.headerStruct.isRead = 1;
 	// 0xD1 || 0b11010001
 
-	uint32_t fullWriteLength = HEADER_LENGTH + writeDataLength;
+	uint32_t fullWriteLength = buildFrame(commandFrame, header, writeDataLength, writeData);
 
-	if (fullWriteLength < 4)
+	if (fullWriteLength == 0)
 	{
 		return 1;
 	}
 
-	unsigned char* fullWriteData = (unsigned char*)malloc(fullWriteLength);
+	if (doLog)
+	{
+		logFrame("READ WRITE ", commandFrame->frame, fullWriteLength);
+	}
 
-	if (!fullWriteData)
+	if (ioDeviceWrite(commandFrame->device, commandFrame->frame, fullWriteLength) == WRITE_FAILED)
 	{
+		protocolData->BytesRead = 0;
 		return 1;
 	}
 
-	fullWriteData[0] = header.headerInt;
-	fullWriteData[1] = writeData[0];
-	fullWriteData[2] = (writeDataLength - 1) & 0xFF; // remove opcode from length
-	fullWriteData[3] = (writeDataLength - 1) >> 8;
+	// the response header carries the length of the payload that follows it
+	uint8_t* responseHeader = commandFrame->responseHeader;
 
-	for (int32_t i = 0; i < writeDataLength - 1; ++i)
+	if (ioDeviceRead(commandFrame->device, responseHeader, HEADER_LENGTH) != HEADER_LENGTH)
 	{
-		fullWriteData[i + 4] = writeData[i + 1];
+		protocolData->BytesRead = 0;
+		return 1;
 	}
 
+	uint16_t responseLength = getResponseLength(responseHeader);
+
 	if (doLog)
 	{
-		printf("READ WRITE ");
-
-		for (uint32_t i = 0; i < fullWriteLength; i++)
+		printf("\nGOT: ");
+		for (uint32_t i = 0; i < HEADER_LENGTH; ++i)
 		{
-			printf("0x%02X ", (unsigned char)fullWriteData[i]);
+			printf("0x%02X ", responseHeader[i]);
 		}
-		printf("\n");
+		printf("(%d bytes)\n", responseLength);
 	}
 
-	ioWrite(fullWriteData, fullWriteLength);
-
-	if (variableLengthRead)
-	{
-		protocolData->BytesRead = ioRead(readData, HEADER_LENGTH);
-
-		uint16_t responseLength = readData[2];
-		responseLength = responseLength << 8;
-		responseLength += readData[1];
-
-		if (doLog)
-		{
-			printf("Variable read. %d bytes\n", responseLength);
-		}
-		if (responseLength > 0)
-		{
-			for (int32_t i = 0; i < readDataLength - HEADER_LENGTH; ++i)
-			{
-				// "shift" out the header
-				readData[i] = readData[i + HEADER_LENGTH];
-			}
-
-			uint32_t readDataLength = responseLength < MAX_READ_CMD_PAYLOAD - HEADER_LENGTH ? responseLength : MAX_READ_CMD_PAYLOAD - HEADER_LENGTH;
-
-			uint32_t remainingDataLength = responseLength;
-			if (remainingDataLength > 1)
-			{
-				uint8_t* readBuffer = (uint8_t*)malloc(remainingDataLength);
-
-				if (!readBuffer)
-				{
-					return 1;
-				}
+	// the payload is read straight into the caller's buffer
+	uint16_t payloadLength = responseLength < readDataLength ? responseLength : readDataLength;
 
-				protocolData->BytesRead = ioRead(readBuffer, remainingDataLength);
+	protocolData->BytesRead = payloadLength > 0 ? ioDeviceRead(commandFrame->device, readData, payloadLength) : 0;
 
-				for (uint16_t i = 0; i < remainingDataLength; ++i)
-				{
-					readData[i] = readBuffer[i];
-				}
-			}
-		}
-	}
-	else //fixed-length read
+	if (protocolData->BytesRead == READ_FAILED)
 	{
-		protocolData->BytesRead = ioRead(readData, HEADER_LENGTH);
-		if (protocolData->BytesRead != 0xFFFF) // if first read didn't fail
-		{
-			if (doLog)
-			{
-				printf("\nGOT: ");
-				for (uint32_t i = 0; i < protocolData->BytesRead; ++i)
-				{
-					printf("0x%02X ", readData[i]);
-				}
-			}
-			protocolData->BytesRead = ioRead(readData, readDataLength);
-			if (protocolData->BytesRead != 0xFFFF) // if first read didn't fail
-			{
-				if (doLog)
-				{
-					for (uint32_t i = 0; i < protocolData->BytesRead; ++i)
-					{
-						printf("0x%02X ", readData[i]);
-					}
-				}
-			}
-			if (doLog)
-			{
-				printf("\n");
-			}
-		}
+		protocolData->BytesRead = 0;
+		return 1;
 	}
 
-	if (doLog && variableLengthRead && protocolData->BytesRead > 0 && protocolData->BytesRead != 0xFFFF)
+	if (doLog && protocolData->BytesRead > 0)
 	{
-		printf("\nGOT ");
+		printf("GOT ");
 		for (uint32_t i = 0; i < protocolData->BytesRead; ++i)
 		{
 			printf("0x%02X ", readData[i]);
@@ -232,23 +358,85 @@ uint32_t doRead(uint16_t               writeDataLength,
 		printf("\n");
 	}
 
-	variableLengthRead = 0;
 	return 0;
 }
 
 uint32_t init()
 {
-	variableLengthRead = 0;
-	DLPC_COMMON_InitCommandLibrary(s_WriteBuffer,
-		sizeof(s_WriteBuffer),
-		s_ReadBuffer,
-		sizeof(s_ReadBuffer),
+	s_CommandFrame.device = ioGetDefaultDevice();
+
+	// commands are packed behind the space reserved for the header
+	DLPC_COMMON_InitCommandLibrary(s_CommandFrame.frame + HEADER_LENGTH,
+		MAX_WRITE_CMD_PAYLOAD,
+		s_CommandFrame.readBuffer,
+		sizeof(s_CommandFrame.readBuffer),
 		doWrite,
 		doRead);
 
 	return ioInit();
 }
 
+uint32_t listProjectors()
+{
+	IoDeviceInfo devices[MAX_PROJECTORS];
+	uint32_t numDevices = ioEnumerateDevices(devices, MAX_PROJECTORS);
+
+	for (uint32_t i = 0; i < numDevices; ++i)
+	{
+		printf("Bus %03u Device %03u  Port %-16s Serial %s\n",
+			devices[i].busNumber,
+			devices[i].address,
+			devices[i].portPath,
+			devices[i].serialNumber[0] != '\0' ? devices[i].serialNumber : "(unavailable)");
+	}
+	return numDevices;
+}
+
+uint32_t selectProjector(const char* serialOrPath)
+{
+	return ioSelectDevice(serialOrPath);
+}
+
+uint32_t openProjector(const char* serialOrPath, /*out*/ Projector* projector)
+{
+	// the frame holds a 64 KB read buffer, too much for the stack of a worker thread
+	CommandFrame* commandFrame = (CommandFrame*)calloc(1, sizeof(CommandFrame));
+
+	if (!commandFrame)
+	{
+		return 1;
+	}
+
+	commandFrame->device = ioOpenDevice(serialOrPath);
+	if (!commandFrame->device)
+	{
+		free(commandFrame);
+		return 1;
+	}
+
+	DLPC_COMMON_InitCommandContext(&projector->context,
+		commandFrame->frame + HEADER_LENGTH,
+		MAX_WRITE_CMD_PAYLOAD,
+		commandFrame->readBuffer,
+		sizeof(commandFrame->readBuffer),
+		doWrite,
+		doRead,
+		commandFrame);
+	projector->frame = commandFrame;
+
+	return 0;
+}
+
+void closeProjector(Projector* projector)
+{
+	if (projector->frame)
+	{
+		ioCloseDevice(projector->frame->device);
+		free(projector->frame);
+		projector->frame = NULL;
+	}
+}
+
 SectorAddressAndSize* getSectorStartAddressesAndSize(/*out*/ uint32_t *numSectors)
 {
 	uint32_t numSectorInfos;
@@ -257,8 +445,6 @@ SectorAddressAndSize* getSectorStartAddressesAndSize(/*out*/ uint32_t *numSector
 		return NULL;
 	}
 
-	variableLengthRead = 1;
-
 	// This sends the same opcode to the projector (0x21) as the upcoming call to DLPC654X_ReadGetFlashSectorInformation.
 	// From this first call, we only check the number of sector infos so we know how much space to allocate ahead of time
 	// since the latter call expects space to be allocated already
@@ -282,7 +468,6 @@ SectorAddressAndSize* getSectorStartAddressesAndSize(/*out*/ uint32_t *numSector
 		sectorInfo[i] = (DLPC654X_SectorInfo_s*)malloc(sizeof(DLPC654X_SectorInfo_s));
 	}
 
-	variableLengthRead = 1;
 	DLPC654X_ReadGetFlashSectorInformation(sectorInfo);
 
 	// calculate needed size of array
@@ -348,44 +533,59 @@ uint32_t getSectorInfoCount()
 	return 1;
 }
 
-uint32_t getStartOfFlashTable(SectorAddressAndSize* allSectors, uint32_t numSectors, char* flashImgFile)
+uint32_t openFlashImage(const char* flashImgFile, /*out*/ FlashImage* image)
 {
-	FILE* imgFile = fopen(flashImgFile, "rb");
-	
-	if (imgFile != NULL)
+	if (DLPC_COMMON_MapFile(flashImgFile, &image->mapping))
 	{
-		char c;
-		for (uint32_t i = 0; i < numSectors; ++i)
-		{
-			uint8_t foundSignature = 1;
-			fseek(imgFile, allSectors[i].startAddress, SEEK_SET);
+		fprintf(IN_STDERR, "Failed to open file %s for reading\n", flashImgFile);
+		image->data = NULL;
+		image->size = 0;
+		return 1;
+	}
 
-			for (uint8_t j = 0; j < FLASH_TABLE_SIGNATURE_LENGTH; ++j)
-			{
-				c = fgetc(imgFile);
-				if (c != flashTableSignature[j])
-				{
-					foundSignature = 0;
-					break;
-				}
-			}
+	image->data = image->mapping.Data;
+	image->size = image->mapping.Size;
+	return 0;
+}
 
-			if (foundSignature)
-			{
-				fclose(imgFile);
-				return allSectors[i].startAddress;
-			}
-		}
+void closeFlashImage(FlashImage* image)
+{
+	DLPC_COMMON_UnmapFile(&image->mapping);
+	image->data = NULL;
+	image->size = 0;
+}
 
-		fclose(imgFile);
-	}
-	else
+uint32_t findStartOfFlashTable(SectorAddressAndSize* allSectors, uint32_t numSectors, const FlashImage* image)
+{
+	for (uint32_t i = 0; i < numSectors; ++i)
 	{
-		fprintf(IN_STDERR, "Failed to open file %s for reading\n", flashImgFile);
+		uint32_t startAddress = allSectors[i].startAddress;
+
+		if (startAddress <= image->size
+			&& image->size - startAddress >= FLASH_TABLE_SIGNATURE_LENGTH
+			&& memcmp(image->data + startAddress, flashTableSignature, FLASH_TABLE_SIGNATURE_LENGTH) == 0)
+		{
+			return startAddress;
+		}
 	}
 	return UINT32_MAX;
 }
 
+uint32_t getStartOfFlashTable(SectorAddressAndSize* allSectors, uint32_t numSectors, char* flashImgFile)
+{
+	FlashImage image;
+
+	if (openFlashImage(flashImgFile, &image))
+	{
+		return UINT32_MAX;
+	}
+
+	uint32_t startOfFlashTable = findStartOfFlashTable(allSectors, numSectors, &image);
+	closeFlashImage(&image);
+
+	return startOfFlashTable;
+}
+
 uint32_t validateFlashImage(SectorAddressAndSize* allSectors, uint32_t numSectors, uint32_t startOfFlashTable, char* flashImgFile)
 {
 	FILE* imgFile = fopen(flashImgFile, "rb");
@@ -468,13 +668,37 @@ uint32_t changeMode(uint8_t doChange)
 
 }
 
+/*
+ * @brief waits for the projector to re-enumerate after a mode switch armed with ioDeviceArmReconnect
+ *        and reports how long that took
+ * @return 0 once the projector is reconnected, 1 on timeout
+*/
+static uint32_t reconnectAfterModeSwitch()
+{
+	uint32_t leftMs = 0;
+	uint32_t arrivedMs = 0;
+
+	if (ioDeviceReconnect(getCommandFrame()->device, MODE_SWITCH_TIMEOUT_S * 1000, &leftMs, &arrivedMs))
+	{
+		fprintf(IN_STDERR, "Timeout reached. The projector did not reconnect\n");
+		return 1;
+	}
+
+	printf("Re-enumerated after %u ms (left the bus after %u ms)\n", arrivedMs, leftMs);
+	return 0;
+}
+
 uint32_t switchToBootloaderMode()
 {
-	Sleep(1000); // Wait for the system to boot up
+	uint64_t startTime = DLPC_COMMON_GetTimeInMicroseconds();
 
-	struct timespec startTime;
-	struct timespec currentTime;
-	timespec_get(&startTime, TIME_UTC);
+	// watch for the projector leaving the bus before asking it to switch
+	uint8_t hotplug = ioDeviceArmReconnect(getCommandFrame()->device) == 0;
+
+	if (!hotplug)
+	{
+		Sleep(1000); // Wait for the system to boot up
+	}
 
 	printf("Switching modes...\n");
 	uint32_t notInBootloaderMode = changeMode(1);
@@ -489,23 +713,36 @@ uint32_t switchToBootloaderMode()
 		{
             printf("\nReconnecting...\n");
 			reconnected = 1;
-			Sleep(1000);
-			disconnectDevice();
-			Sleep(3250);
-			ioInit();
-			Sleep(250);
+			if (hotplug)
+			{
+				if (reconnectAfterModeSwitch())
+				{
+					break;
+				}
+			}
+			else
+			{
+				Sleep(1000);
+				ioDeviceDisconnect(getCommandFrame()->device);
+				Sleep(3250);
+				ioDeviceConnect(getCommandFrame()->device);
+				Sleep(250);
+			}
 		}
 
 		notInBootloaderMode = changeMode(0);
 
-		timespec_get(&currentTime, TIME_UTC);
+		if (!notInBootloaderMode)
+		{
+			break;
+		}
 
-		if (currentTime.tv_sec - startTime.tv_sec > MODE_SWITCH_TIMEOUT_S)
+		if (DLPC_COMMON_GetTimeInMicroseconds() - startTime > MODE_SWITCH_TIMEOUT_S * 1000000ULL)
 		{
 			fprintf(IN_STDERR, "Timeout reached. Could not switch to bootloader mode\n");
 			break;
 		}
-		Sleep(500);
+		Sleep(hotplug ? MODE_POLL_INTERVAL_MS : 500);
 	}
 
 	return notInBootloaderMode;
@@ -513,26 +750,30 @@ uint32_t switchToBootloaderMode()
 
 Checksum getChecksum(FILE* imgFile, SectorAddressAndSize sector)
 {
+	uint8_t buffer[CHECKSUM_READ_BLOCK_SIZE];
+
 	fseek(imgFile, sector.startAddress, SEEK_SET);
 	Checksum checksum;
 	checksum.simpleCheckSum = 0;
 	checksum.sumOfSumChecksum = 0;
 
-	unsigned char c;
-	for (uint32_t i = 0; i < sector.size; ++i)
+	for (uint32_t remaining = sector.size; remaining > 0;)
 	{
-		c = (unsigned char)fgetc(imgFile);
-		checksum.simpleCheckSum += c;
-		checksum.sumOfSumChecksum += checksum.simpleCheckSum;
+		uint32_t blockSize = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+		size_t read = fread(buffer, 1, blockSize, imgFile);
+
+		// bytes past the end of the image count as erased flash
+		memset(buffer + read, 0xFF, blockSize - read);
+
+		updateChecksum(&checksum, buffer, blockSize);
+		remaining -= blockSize;
 	}
 
 	return checksum;
 }
 
-AddressChecksum* getFlashImageChecksums(SectorAddressAndSize* allSectors, uint32_t numSectors, char* flashImgFile, /*out*/ uint32_t *numFlashImgSectors)
+AddressChecksum* getImageChecksums(SectorAddressAndSize* allSectors, uint32_t numSectors, const FlashImage* image, /*out*/ uint32_t *numFlashImgSectors)
 {
-	FILE* imgFile = fopen(flashImgFile, "rb");
-
 	AddressChecksum* addressChecksums = (AddressChecksum*)malloc(numSectors * sizeof(AddressChecksum));
 
 	if (!addressChecksums)
@@ -540,26 +781,30 @@ AddressChecksum* getFlashImageChecksums(SectorAddressAndSize* allSectors, uint32
 		return NULL;
 	}
 
-	fseek(imgFile, 0, SEEK_END);
-	uint64_t flashImgSize = ftell(imgFile);
-
-	fseek(imgFile, 0, SEEK_SET);
-
 	*numFlashImgSectors = 0;
 
-	for (uint32_t i = 0; i < numSectors; ++i)
+	while (*numFlashImgSectors < numSectors && allSectors[*numFlashImgSectors].startAddress <= image->size)
 	{
-		if (allSectors[i].startAddress > flashImgSize)
-		{
-			break;
-		}
+		++(*numFlashImgSectors);
+	}
 
-		addressChecksums[i].checksum = getChecksum(imgFile, allSectors[i]);
-		addressChecksums[i].startAddress = allSectors[i].startAddress;
+	// one pass over the mapped image, split across threads by sector range
+	getImageSectorChecksums(image->data, image->size, allSectors, *numFlashImgSectors, addressChecksums, CHECKSUM_THREADS);
 
-		++(*numFlashImgSectors);
+	return addressChecksums;
+}
+
+AddressChecksum* getFlashImageChecksums(SectorAddressAndSize* allSectors, uint32_t numSectors, char* flashImgFile, /*out*/ uint32_t *numFlashImgSectors)
+{
+	FlashImage image;
+
+	if (openFlashImage(flashImgFile, &image))
+	{
+		return NULL;
 	}
-	fclose(imgFile);
+
+	AddressChecksum* addressChecksums = getImageChecksums(allSectors, numSectors, &image, numFlashImgSectors);
+	closeFlashImage(&image);
 
 	return addressChecksums;
 }
@@ -574,6 +819,52 @@ Checksum getFlashSectorChecksum(SectorAddressAndSize sector)
 	return checksum;
 }
 
+static uint8_t isChecksumEqual(Checksum a, Checksum b)
+{
+	return a.simpleCheckSum == b.simpleCheckSum && a.sumOfSumChecksum == b.sumOfSumChecksum;
+}
+
+/*
+ * Compares the flash against the image for a run of adjacent sectors with a
+ * single device checksum request. When the run doesn't match, every sector in
+ * it is checked with its own request, so a sector is only reported modified by
+ * a checksum over exactly that sector.
+ */
+static void findModifiedSectors(SectorAddressAndSize* sectors,
+	AddressChecksum* flashImgChecksums,
+	uint32_t first,
+	uint32_t count,
+	/*out*/ uint8_t* modified,
+	/*out*/ uint32_t* numRequests)
+{
+	if (count > 1)
+	{
+		SectorAddressAndSize range = sectors[first];
+		Checksum imgChecksum = flashImgChecksums[first].checksum;
+
+		for (uint32_t i = first + 1; i < first + count; ++i)
+		{
+			imgChecksum = combineChecksums(imgChecksum, flashImgChecksums[i].checksum, sectors[i].size);
+			range.size += sectors[i].size;
+		}
+
+		++(*numRequests);
+		if (isChecksumEqual(getFlashSectorChecksum(range), imgChecksum))
+		{
+			return;
+		}
+	}
+
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		++(*numRequests);
+		if (!isChecksumEqual(getFlashSectorChecksum(sectors[i]), flashImgChecksums[i].checksum))
+		{
+			modified[i] = 1;
+		}
+	}
+}
+
 SectorAddressAndSize* getSectorsToProgram(SectorAddressAndSize* allSectors,
 	uint32_t numSectors,
 	AddressChecksum* flashImgChecksums,
@@ -586,55 +877,94 @@ SectorAddressAndSize* getSectorsToProgram(SectorAddressAndSize* allSectors,
 	*numSectorsToProgram = 0;
 
 	SectorAddressAndSize* sectorsToProgram = (SectorAddressAndSize*)malloc(numSectors * sizeof(SectorAddressAndSize));
-	SectorAddressAndSize flashSector = allSectors[0];
+	uint8_t* include = (uint8_t*)calloc(numFlashImgChecksums + 1, 1);  // +1 so an empty image still allocates
 
-	if (!sectorsToProgram)
+	if (!sectorsToProgram || !include)
 	{
+		free(sectorsToProgram);
+		free(include);
 		return NULL;
 	}
 
 	uint8_t addedFlashSector = 0;
+	uint32_t numRequests = 0;
+	uint32_t runStart = 0;
+	uint32_t runLength = 0;
 
 	for (uint32_t i = 0; i < numFlashImgChecksums; ++i)
 	{
-		uint8_t isFlashSector = 0;
 		SectorAddressAndSize sector = allSectors[i];
+		uint8_t checkForChanges = 0;
+
 		if (sector.startAddress == startOfFlashTable)
 		{
-			isFlashSector = 1;
+			// always include flash sector
+			include[i] = 1;
 			addedFlashSector = 1;
-			flashSector = sector;
 		}
-
-		if (!isFlashSector
-			&& ((sector.startAddress < startOfFlashTable && (flashType & BOOTLOADER) == 0)
-			|| sector.startAddress >= startOfFlashTable && (flashType & APPLICATION) == 0))
+		else if ((sector.startAddress < startOfFlashTable && (flashType & BOOTLOADER) == 0)
+			|| (sector.startAddress >= startOfFlashTable && (flashType & APPLICATION) == 0))
 		{
-			continue;
+			// not selected for programming
 		}
-
-		if (updateModifiedSectorsOnly)
+		else if (updateModifiedSectorsOnly)
 		{
-			printf("Building the list of sectors to program (%d of %d)\n", i + 1, numFlashImgChecksums);
+			checkForChanges = 1;
+		}
+		else
+		{
+			include[i] = 1;
+		}
 
-			Checksum flashSectorChecksum = getFlashSectorChecksum(sector);
+		// sectors are checked in runs of adjacent sectors, one device request per run
+		uint8_t extendsRun = checkForChanges
+			&& runLength > 0
+			&& runLength < MAX_COALESCED_SECTORS
+			&& runStart + runLength == i
+			&& allSectors[i - 1].startAddress + allSectors[i - 1].size == sector.startAddress;
 
-			if (!isFlashSector // always include flash sector
-				&& flashSectorChecksum.simpleCheckSum == flashImgChecksums[i].checksum.simpleCheckSum
-				&& flashSectorChecksum.sumOfSumChecksum == flashImgChecksums[i].checksum.sumOfSumChecksum)
+		if (runLength > 0 && !extendsRun)
+		{
+			printf("Checking sectors %d to %d for changes\n", runStart + 1, runStart + runLength);
+			findModifiedSectors(allSectors, flashImgChecksums, runStart, runLength, include, &numRequests);
+			runLength = 0;
+		}
+
+		if (checkForChanges)
+		{
+			if (runLength == 0)
 			{
-				printf("Skipping sector (%d)\n", i + 1);
-				continue;
+				runStart = i;
 			}
-			else
+			++runLength;
+		}
+	}
+
+	if (runLength > 0)
+	{
+		printf("Checking sectors %d to %d for changes\n", runStart + 1, runStart + runLength);
+		findModifiedSectors(allSectors, flashImgChecksums, runStart, runLength, include, &numRequests);
+	}
+
+	for (uint32_t i = 0; i < numFlashImgChecksums; ++i)
+	{
+		if (include[i])
+		{
+			if (updateModifiedSectorsOnly)
 			{
 				printf("Adding sector (%d)\n", i + 1);
 			}
-
+			sectorsToProgram[(*numSectorsToProgram)++] = allSectors[i];
 		}
-		sectorsToProgram[(*numSectorsToProgram)++] = sector;
 	}
 
+	if (updateModifiedSectorsOnly)
+	{
+		printf("Found %u sectors to program with %u checksum requests\n", *numSectorsToProgram, numRequests);
+	}
+
+	free(include);
+
 	// if we only added the flash sector, don't update anything
 	if (addedFlashSector && (*numSectorsToProgram) == 1 || (*numSectorsToProgram) == 0)
 	{
@@ -667,12 +997,12 @@ uint32_t eraseSectors(SectorAddressAndSize* sectorsToProgram, uint32_t numSector
 		uint32_t retVal = 0;
 		if ((flashType & BOOTLOADER) == BOOTLOADER && sectorsToProgram[i].startAddress < startOfFlashTable)
 		{
-			printf("Erasing boot sector (%d of %d)\n", i + 1, numSectors);
+			reportSector(FLEET_ERASING, "Erasing boot sector", i, numSectors);
 			retVal = DLPC654X_WriteEraseSector(sectorsToProgram[i].startAddress);
 		}
 		if ((flashType & APPLICATION) == APPLICATION && sectorsToProgram[i].startAddress >= startOfFlashTable)
 		{
-			printf("Erasing app  sector (%d of %d)\n", i + 1, numSectors);
+			reportSector(FLEET_ERASING, "Erasing app  sector", i, numSectors);
 			retVal = DLPC654X_WriteEraseSector(sectorsToProgram[i].startAddress);
 		}
 
@@ -684,10 +1014,63 @@ uint32_t eraseSectors(SectorAddressAndSize* sectorsToProgram, uint32_t numSector
 	return 0;
 }
 
+void setFlashBlockSize(uint16_t blockSize)
+{
+	// flash writes must be even and fit in the command write buffer
+	blockSize -= blockSize % 2;
+	if (blockSize > FLASH_WRITE_BLOCK_SIZE)
+	{
+		blockSize = FLASH_WRITE_BLOCK_SIZE;
+	}
+	if (blockSize > 0)
+	{
+		s_FlashBlockSize = blockSize;
+	}
+}
+
+uint16_t getFlashBlockSize()
+{
+	return s_FlashBlockSize;
+}
+
+void tuneFlashBlockSize()
+{
+	DLPC_COMMON_InitBlockSizeTuner(&s_FlashBlockSizeTuner, MIN_TUNED_BLOCK_SIZE, FLASH_WRITE_BLOCK_SIZE, 2);
+	s_TuneFlashBlockSize = 1;
+}
+
+static uint16_t getNextFlashBlockSize()
+{
+	if (s_TuneFlashBlockSize)
+	{
+		return DLPC_COMMON_GetTunerBlockSize(&s_FlashBlockSizeTuner);
+	}
+	return s_FlashBlockSize;
+}
+
+static void updateFlashBlockSizeTuner(uint16_t bytesWritten)
+{
+	if (!s_TuneFlashBlockSize)
+	{
+		return;
+	}
+
+	DLPC_COMMON_UpdateBlockSizeTuner(&s_FlashBlockSizeTuner, bytesWritten);
+
+	if (DLPC_COMMON_IsTunerDone(&s_FlashBlockSizeTuner))
+	{
+		s_TuneFlashBlockSize = 0;
+		s_FlashBlockSize = s_FlashBlockSizeTuner.BestBlockSize;
+		printf("Flash block size tuned to %u bytes (%.0f bytes/s)\n",
+			s_FlashBlockSize, s_FlashBlockSizeTuner.BestBytesPerSecond);
+	}
+}
+
 uint32_t programSector(FILE* imgFile, SectorAddressAndSize sector)
 {
-	char buffer[MAX_BLOCK_SIZE];
-	uint32_t bufferLimit = MAX_BLOCK_SIZE; // to avoid reallocations, track the end of the usable section of the buffer
+	char buffer[FLASH_WRITE_BLOCK_SIZE];
+	uint32_t bufferLimit; // the usable section of the buffer for the current block
+	uint16_t blockSize;
 
 	fseek(imgFile, 0, SEEK_END);
 	uint64_t flashImgSize = ftell(imgFile);
@@ -709,14 +1092,12 @@ uint32_t programSector(FILE* imgFile, SectorAddressAndSize sector)
 		return retVal;
 	}
 
-	for (int64_t remainingBytes = bytesToProgram, offset = sector.startAddress;
+	for (int64_t remainingBytes = bytesToProgram;
 		remainingBytes > 0;
-		remainingBytes -= MAX_BLOCK_SIZE, offset += MAX_BLOCK_SIZE)
+		remainingBytes -= blockSize)
 	{
-		if (remainingBytes < MAX_BLOCK_SIZE)
-		{
-			bufferLimit = remainingBytes;
-		}
+		blockSize = getNextFlashBlockSize();
+		bufferLimit = remainingBytes < blockSize ? (uint32_t)remainingBytes : blockSize;
 
 		size_t read = fread(buffer, 1, bufferLimit, imgFile);
 
@@ -734,70 +1115,141 @@ uint32_t programSector(FILE* imgFile, SectorAddressAndSize sector)
 			continue;
 		}
 
-		if (read == bufferLimit)
+		DLPC654X_WriteFlashWrite((uint16_t)read, buffer);
+		updateFlashBlockSizeTuner((uint16_t)read);
+	}
+	return 0;
+}
+
+uint32_t programSectorFromMemory(const uint8_t* data, size_t len, SectorAddressAndSize sector)
+{
+	uint8_t lastBlock[FLASH_WRITE_BLOCK_SIZE];
+
+	if (sector.startAddress >= len)
+	{
+		return 0;
+	}
+
+	const uint8_t* sectorData = data + sector.startAddress;
+	uint32_t bytesInImage = sector.size < (len - sector.startAddress) ? sector.size : (uint32_t)(len - sector.startAddress);
+
+	// force even writes
+	uint32_t bytesToProgram = bytesInImage + (bytesInImage % 2);
+
+	uint32_t retVal = DLPC654X_WriteInitializeFlashReadWriteSettings(sector.startAddress, bytesToProgram);
+	if (retVal)
+	{
+		return retVal;
+	}
+
+	// where the transport supports it, the blocks are queued back to back instead of waiting on each ACK
+	CommandFrame* commandFrame = getCommandFrame();
+	commandFrame->queueWrites = ioDeviceStartAsync(commandFrame->device, ASYNC_TRANSFERS) == 0;
+	commandFrame->queuedAckFailed = 0;
+
+	uint16_t blockSize;
+	for (uint32_t offset = 0; offset < bytesToProgram && !retVal; offset += blockSize)
+	{
+		blockSize = getNextFlashBlockSize();
+		if (blockSize > bytesToProgram - offset)
+		{
+			blockSize = (uint16_t)(bytesToProgram - offset);
+		}
+
+		// the blocks are sent straight from the image, except an odd final byte that needs padding
+		uint8_t* block = (uint8_t*)sectorData + offset;
+		if (offset + blockSize > bytesInImage)
 		{
-			DLPC654X_WriteFlashWrite(bufferLimit, buffer);
+			memcpy(lastBlock, block, blockSize - 1);
+			lastBlock[blockSize - 1] = 0xFF;
+			block = lastBlock;
 		}
-		else
+
+		retVal = DLPC654X_WriteFlashWrite(blockSize, block);
+		if (!retVal)
 		{
-			DLPC654X_WriteFlashWrite(read, buffer);
+			updateFlashBlockSizeTuner(blockSize);
 		}
 	}
-	return 0;
+
+	commandFrame->queueWrites = 0;
+
+	uint32_t queuedStatus = ioDeviceFlush(commandFrame->device);
+	if (!queuedStatus && commandFrame->queuedAckFailed)
+	{
+		queuedStatus = READ_FAILED;
+	}
+	return retVal ? retVal : queuedStatus;
 }
 
-uint32_t programSectors(SectorAddressAndSize* sectorsToProgram,
+uint32_t programImageSectors(SectorAddressAndSize* sectorsToProgram,
 	uint32_t numSectorsToProgram,
 	uint32_t startOfFlashTable,
-	char* flashImgFile,
+	const FlashImage* image,
 	enum FlashType flashType)
 {
-	uint32_t dataBytesToProgram = 0;
-	for (uint32_t i = 0; i < numSectorsToProgram; ++i)
-	{
-		dataBytesToProgram += sectorsToProgram[i].size;
-	}
+	uint32_t retVal = 0;
 
-	FILE* imgFile = fopen(flashImgFile, "rb");
-	
-	if (imgFile != NULL)
+	for (uint32_t i = 0; i < numSectorsToProgram && !retVal; ++i)
 	{
-		for (uint32_t i = 0; i < numSectorsToProgram; ++i)
+		SectorAddressAndSize sector = sectorsToProgram[i];
+		if ((flashType & BOOTLOADER) == BOOTLOADER && sectorsToProgram[i].startAddress < startOfFlashTable)
 		{
-			SectorAddressAndSize sector = sectorsToProgram[i];
-			if ((flashType & BOOTLOADER) == BOOTLOADER && sectorsToProgram[i].startAddress < startOfFlashTable)
+			reportSector(FLEET_PROGRAMMING, "Flashing boot sector", i, numSectorsToProgram);
+			retVal = programSectorFromMemory(image->data, image->size, sector);
+		}
+		if ((flashType & APPLICATION) == APPLICATION && sectorsToProgram[i].startAddress >= startOfFlashTable)
+		{
+			reportSector(FLEET_PROGRAMMING, "Flashing app  sector", i, numSectorsToProgram);
+			// don't write the flash header
+			if (sector.startAddress == startOfFlashTable)
 			{
-				printf("Flashing boot sector (%d of %d)\n", i + 1, numSectorsToProgram);
-				programSector(imgFile, sector);
+				SectorAddressAndSize modifiedSector;
+				modifiedSector.startAddress = sector.startAddress + FLASH_TABLE_SIGNATURE_LENGTH;
+				modifiedSector.size = sector.size - FLASH_TABLE_SIGNATURE_LENGTH;
+				retVal = programSectorFromMemory(image->data, image->size, modifiedSector);
 			}
-			if ((flashType & APPLICATION) == APPLICATION && sectorsToProgram[i].startAddress >= startOfFlashTable)
+			else
 			{
-				printf("Flashing app  sector (%d of %d)\n", i + 1, numSectorsToProgram);
-				// don't write the flash header
-				if (sector.startAddress == startOfFlashTable)
-				{
-					SectorAddressAndSize modifiedSector;
-					modifiedSector.startAddress = sector.startAddress + FLASH_TABLE_SIGNATURE_LENGTH;
-					modifiedSector.size = sector.size - FLASH_TABLE_SIGNATURE_LENGTH;
-					programSector(imgFile, modifiedSector);
-				}
-				else
-				{
-					programSector(imgFile, sector);
-				}
+				retVal = programSectorFromMemory(image->data, image->size, sector);
 			}
+		}
 
+		if (retVal)
+		{
+			fprintf(IN_STDERR, "Programming sector (%d of %d) failed (%u)\n", i + 1, numSectorsToProgram, retVal);
 		}
-		fclose(imgFile);
 	}
-	return 0;
+	return retVal;
+}
+
+uint32_t programSectors(SectorAddressAndSize* sectorsToProgram,
+	uint32_t numSectorsToProgram,
+	uint32_t startOfFlashTable,
+	char* flashImgFile,
+	enum FlashType flashType)
+{
+	FlashImage image;
+
+	if (openFlashImage(flashImgFile, &image))
+	{
+		return 1;
+	}
+
+	uint32_t retVal = programImageSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, &image, flashType);
+	closeFlashImage(&image);
+
+	return retVal;
 }
 
 uint32_t programFlashTableSignature(uint32_t startOfFlashTable)
 {
-	DLPC654X_WriteInitializeFlashReadWriteSettings(startOfFlashTable, FLASH_TABLE_SIGNATURE_LENGTH);
-	DLPC654X_WriteFlashWrite(FLASH_TABLE_SIGNATURE_LENGTH, flashTableSignature);
-	return 0;
+	uint32_t retVal = DLPC654X_WriteInitializeFlashReadWriteSettings(startOfFlashTable, FLASH_TABLE_SIGNATURE_LENGTH);
+	if (retVal)
+	{
+		return retVal;
+	}
+	return DLPC654X_WriteFlashWrite(FLASH_TABLE_SIGNATURE_LENGTH, flashTableSignature);
 }
 
 uint32_t verifyFlashData(SectorAddressAndSize* allSectors,
@@ -825,7 +1277,7 @@ uint32_t verifyFlashData(SectorAddressAndSize* allSectors,
 			continue;
 		}
 
-		printf("Verifying sector (%d of %d)\n", i + 1, numFlashImgChecksums);
+		reportSector(FLEET_VERIFYING, "Verifying sector", i, numFlashImgChecksums);
 
 		Checksum flashSectorChecksum = getFlashSectorChecksum(sector);
 
@@ -842,27 +1294,61 @@ uint32_t verifyFlashData(SectorAddressAndSize* allSectors,
 
 uint32_t switchToMainApp()
 {
+	uint64_t startTime = DLPC_COMMON_GetTimeInMicroseconds();
+	uint8_t hotplug = ioDeviceArmReconnect(getCommandFrame()->device) == 0;
+
 	DLPC654X_CmdSwitchTypeT_e switchType = DLPC654X_CSTT_TO_APP_VIA_RESET;
-	return DLPC654X_WriteSwitchMode(switchType);
-}
+	uint32_t err = DLPC654X_WriteSwitchMode(switchType);
 
-int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType)
-{
-	if (!filePath)
+	// without hotplug events there is no telling when the reset is over, so the switch isn't confirmed
+	if (err || !hotplug)
 	{
-		printf("Usage: dlpc654x_sample.exe /path/to/img/file\n");
-		return 1;
+		return err;
 	}
 
-	uint32_t err = init();
+	err = reconnectAfterModeSwitch();
 
-	if (!err)
+	while (!err)
 	{
-		err = switchToBootloaderMode();
-		if (err)
+		DLPC654X_CmdModeT_e mode;
+		DLPC654X_CmdControllerConfigT_e config;
+
+		if (DLPC654X_ReadMode(&mode, &config) == 0 && mode != DLPC654X_CMT_BOOTLOADER)
 		{
-			fprintf(IN_STDERR, "Could not switch to bootloader mode\n");
+			printf("Main application running after %llu ms\n",
+				(unsigned long long)((DLPC_COMMON_GetTimeInMicroseconds() - startTime) / 1000));
+			break;
+		}
+
+		if (DLPC_COMMON_GetTimeInMicroseconds() - startTime > MODE_SWITCH_TIMEOUT_S * 1000000ULL)
+		{
+			fprintf(IN_STDERR, "Timeout reached. Could not switch to the main application\n");
+			err = 1;
 		}
+		Sleep(MODE_POLL_INTERVAL_MS);
+	}
+
+	return err;
+}
+
+int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType)
+{
+	return doFlashUpdateEx(filePath, flashModifiedSectorsOnly, flashType, 0);
+}
+
+/*
+ * @brief updates the flash of the projector of the current command context with the flash block size
+ *        set for the calling thread, and switches it back to the main application
+ * @return 0 if successful, >0 on error
+*/
+static uint32_t updateFlash(const FlashImage* image, char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType)
+{
+	setFleetPhase(FLEET_CONNECTING);
+
+	uint32_t err = switchToBootloaderMode();
+	if (err)
+	{
+		fprintf(IN_STDERR, "Could not switch to bootloader mode\n");
 	}
 
 	uint32_t numSectors = 0;
@@ -882,7 +1368,7 @@ int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashTy
 
 	if (!err)
 	{
-		startOfFlashTable = getStartOfFlashTable(allSectors, numSectors, filePath);
+		startOfFlashTable = findStartOfFlashTable(allSectors, numSectors, image);
 
 		printf("startOfFlashTable: %u\n", startOfFlashTable);
 
@@ -902,7 +1388,7 @@ int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashTy
 	
 	if (!err)
 	{
-		flashImgChecksums = getFlashImageChecksums(allSectors, numSectors, filePath, &numFlashImgChecksums);
+		flashImgChecksums = getImageChecksums(allSectors, numSectors, image, &numFlashImgChecksums);
 
 		if (flashImgChecksums == NULL)
 		{
@@ -945,36 +1431,57 @@ int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashTy
 
 	if (!err)
 	{
+		// the update stops at the first step that fails, the flash is relocked either way
 		if ((flashType & BOOTLOADER) == BOOTLOADER)
 		{
-			eraseSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, BOOTLOADER);
+			err = eraseSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, BOOTLOADER);
 
-			programSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, filePath, BOOTLOADER);
+			if (!err)
+			{
+				err = programImageSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, image, BOOTLOADER);
+			}
 		}
 
-		if ((flashType & APPLICATION) == APPLICATION)
+		if (!err && (flashType & APPLICATION) == APPLICATION)
 		{
-			eraseSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, APPLICATION);
+			err = eraseSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, APPLICATION);
+
+			if (!err)
+			{
+				err = programImageSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, image, APPLICATION);
+			}
+		}
 
-			programSectors(sectorsToProgram, numSectorsToProgram, startOfFlashTable, filePath, APPLICATION);
+		if (!err && flashType > 0)
+		{
+			err = programFlashTableSignature(startOfFlashTable);
 		}
 
-		if (flashType > 0)
+		if (err)
 		{
-			programFlashTableSignature(startOfFlashTable);
+			fprintf(IN_STDERR, "Flash update failed (%u)\n", err);
 		}
 
-		setLockedForFlashProgramming(1);
+		uint32_t lockErr = setLockedForFlashProgramming(1);
+
+		if (!err)
+		{
+			err = lockErr;
+		}
 
 		// Sometimes, bootloader sector gets incorrectly reported as being incorrect.
 		// The cause has not been identified, so let's skip the verification step if
 		// we only program the bootloader
-		if ((flashType & APPLICATION) == APPLICATION)
+		if (!err && (flashType & APPLICATION) == APPLICATION)
 		{
-			verifyFlashData(allSectors, numSectors, flashImgChecksums, numFlashImgChecksums, startOfFlashTable, flashType);
+			err = verifyFlashData(allSectors, numSectors, flashImgChecksums, numFlashImgChecksums, startOfFlashTable, flashType);
 		}
 
-		switchToMainApp();
+		if (!err)
+		{
+			setFleetPhase(FLEET_SWITCHING);
+			err = switchToMainApp();
+		}
 	}
 
 	if (allSectors != NULL)
@@ -985,8 +1492,247 @@ int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashTy
 	{
 		free(flashImgChecksums);
 	}
+	if (sectorsToProgram != NULL)
+	{
+		free(sectorsToProgram);
+	}
 
-	return 0;
+	return err;
+}
+
+/*
+ * @brief builds the key the flash block size is stored under, specific to the transport,
+ *        the adapter (serial number, or port path when it has none) and the controller
+*/
+static void getFlashBlockSizeTuningKey(char* tuningKey)
+{
+	IoDevice* device = getCommandFrame()->device;
+	const char* adapter = device ? ioDeviceGetSerialNumber(device) : "";
+
+	if (adapter[0] == '\0' && device)
+	{
+		adapter = ioDeviceGetPortPath(device);
+	}
+
+	snprintf(tuningKey, MAX_TUNING_KEY_LENGTH, "%s/%s/DLPC654X/flash_block_size",
+		TUNING_TRANSPORT_NAME, adapter[0] != '\0' ? adapter : "default");
+
+	// tuning keys can't contain spaces
+	for (char* space = strchr(tuningKey, ' '); space; space = strchr(space, ' '))
+	{
+		*space = '_';
+	}
+}
+
+int doFlashUpdateEx(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType, uint8_t retuneBlockSize)
+{
+	if (!filePath)
+	{
+		printf("Usage: dlpc654x_sample.exe /path/to/img/file\n");
+		return 1;
+	}
+
+	FlashImage image;
+	uint32_t err = openFlashImage(filePath, &image);
+
+	if (!err)
+	{
+		err = init();
+	}
+
+	char tuningKey[MAX_TUNING_KEY_LENGTH];
+
+	if (!err)
+	{
+		uint32_t tunedBlockSize;
+		getFlashBlockSizeTuningKey(tuningKey);
+		if (!retuneBlockSize && DLPC_COMMON_LoadTunedValue(TUNING_FILE, tuningKey, &tunedBlockSize) == 0)
+		{
+			setFlashBlockSize((uint16_t)tunedBlockSize);
+		}
+		else
+		{
+			tuneFlashBlockSize();
+		}
+
+		err = updateFlash(&image, filePath, flashModifiedSectorsOnly, flashType);
+	}
+
+	// only persist the block size if enough data was written to time every candidate
+	if (!err && DLPC_COMMON_IsTunerDone(&s_FlashBlockSizeTuner) && s_FlashBlockSizeTuner.BestBytesPerSecond > 0)
+	{
+		DLPC_COMMON_SaveTunedValue(TUNING_FILE, tuningKey, s_FlashBlockSize);
+	}
+
+	closeFlashImage(&image);
+
+	return (int)err;
+}
+
+static uint32_t updateFleetProjector(void* argument)
+{
+	FleetProjector* fleetProjector = (FleetProjector*)argument;
+	char tuningKey[MAX_TUNING_KEY_LENGTH];
+	uint32_t tunedBlockSize;
+
+	DLPC_COMMON_SetCommandContext(&fleetProjector->projector.context);
+	s_FleetProjector = fleetProjector;
+
+	// projectors sharing the host would skew each other's timings, so only a stored block size is used
+	getFlashBlockSizeTuningKey(tuningKey);
+	if (DLPC_COMMON_LoadTunedValue(TUNING_FILE, tuningKey, &tunedBlockSize) == 0)
+	{
+		setFlashBlockSize((uint16_t)tunedBlockSize);
+	}
+
+	fleetProjector->status = updateFlash(fleetProjector->image,
+		fleetProjector->filePath,
+		fleetProjector->flashModifiedSectorsOnly,
+		fleetProjector->flashType);
+
+	s_FleetProjector = NULL;
+	DLPC_COMMON_SetCommandContext(NULL);
+	DLPC_COMMON_AtomicStore(&fleetProjector->done, 1);
+
+	return fleetProjector->status;
+}
+
+static void printFleetProgress(uint32_t numProjectors, uint64_t startTime)
+{
+	printf("\n%-4s %-16s %-24s %-12s %9s\n", "#", "Port", "Serial", "State", "Sector");
+
+	for (uint32_t i = 0; i < numProjectors; ++i)
+	{
+		FleetProjector* fleetProjector = &s_FleetProjectors[i];
+		const char* state = s_FleetPhaseNames[DLPC_COMMON_AtomicLoad(&fleetProjector->phase)];
+
+		if (DLPC_COMMON_AtomicLoad(&fleetProjector->done))
+		{
+			state = fleetProjector->status ? "Failed" : "Done";
+		}
+
+		printf("%-4u %-16s %-24s %-12s %4u/%-4u\n",
+			i,
+			fleetProjector->info.portPath,
+			fleetProjector->info.serialNumber[0] != '\0' ? fleetProjector->info.serialNumber : "(unavailable)",
+			state,
+			DLPC_COMMON_AtomicLoad(&fleetProjector->sector),
+			DLPC_COMMON_AtomicLoad(&fleetProjector->numSectors));
+	}
+
+	printf("Elapsed %.1f s\n", (DLPC_COMMON_GetTimeInMicroseconds() - startTime) / 1000000.0);
+}
+
+int doFleetFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType)
+{
+	IoDeviceInfo devices[MAX_PROJECTORS];
+	uint32_t numProjectors = 0;
+	uint32_t err = 0;
+
+	if (!filePath)
+	{
+		printf("Usage: dlpc654x_sample.exe /path/to/img/file -a\n");
+		return 1;
+	}
+
+	// the image is mapped once and read by every thread
+	FlashImage image;
+	if (openFlashImage(filePath, &image))
+	{
+		return 1;
+	}
+
+	uint32_t numDevices = ioEnumerateDevices(devices, MAX_PROJECTORS);
+
+	for (uint32_t i = 0; i < numDevices; ++i)
+	{
+		FleetProjector* fleetProjector = &s_FleetProjectors[numProjectors];
+		memset(fleetProjector, 0, sizeof(*fleetProjector));
+
+		// projectors are opened by port path, which stays the same across the resets of the mode switches
+		if (openProjector(devices[i].portPath, &fleetProjector->projector))
+		{
+			fprintf(IN_STDERR, "Could not open the projector on port %s\n", devices[i].portPath);
+			continue;
+		}
+
+		fleetProjector->info = devices[i];
+		fleetProjector->image = &image;
+		fleetProjector->filePath = filePath;
+		fleetProjector->flashModifiedSectorsOnly = flashModifiedSectorsOnly;
+		fleetProjector->flashType = flashType;
+		++numProjectors;
+	}
+
+	if (numProjectors == 0)
+	{
+		fprintf(IN_STDERR, "No projectors found\n");
+		closeFlashImage(&image);
+		return 1;
+	}
+
+	printf("Updating %u projectors\n", numProjectors);
+	uint64_t startTime = DLPC_COMMON_GetTimeInMicroseconds();
+
+	for (uint32_t i = 0; i < numProjectors; ++i)
+	{
+		FleetProjector* fleetProjector = &s_FleetProjectors[i];
+		uint32_t status = DLPC_COMMON_CreateThread(updateFleetProjector, fleetProjector, &fleetProjector->thread);
+
+		if (status)
+		{
+			fleetProjector->status = status;
+			DLPC_COMMON_AtomicStore(&fleetProjector->done, 1);
+		}
+		else
+		{
+			fleetProjector->threadStarted = 1;
+		}
+	}
+
+	uint64_t lastPrintTime = startTime;
+	uint32_t numDone = 0;
+
+	while (numDone < numProjectors)
+	{
+		Sleep(FLEET_POLL_INTERVAL_MS);
+
+		numDone = 0;
+		for (uint32_t i = 0; i < numProjectors; ++i)
+		{
+			numDone += DLPC_COMMON_AtomicLoad(&s_FleetProjectors[i].done);
+		}
+
+		if (DLPC_COMMON_GetTimeInMicroseconds() - lastPrintTime >= FLEET_PROGRESS_INTERVAL_MS * 1000ULL)
+		{
+			printFleetProgress(numProjectors, startTime);
+			lastPrintTime = DLPC_COMMON_GetTimeInMicroseconds();
+		}
+	}
+
+	for (uint32_t i = 0; i < numProjectors; ++i)
+	{
+		FleetProjector* fleetProjector = &s_FleetProjectors[i];
+
+		if (fleetProjector->threadStarted)
+		{
+			DLPC_COMMON_JoinThread(&fleetProjector->thread);
+		}
+		if (!err)
+		{
+			err = fleetProjector->status;
+		}
+	}
+
+	printFleetProgress(numProjectors, startTime);
+
+	for (uint32_t i = 0; i < numProjectors; ++i)
+	{
+		closeProjector(&s_FleetProjectors[i].projector);
+	}
+	closeFlashImage(&image);
+
+	return (int)err;
 }
 
 int doFastBootloaderUpdate(uint8_t* bootloaderData, uint32_t bootloaderSize)
@@ -1047,41 +1793,36 @@ int doFastBootloaderUpdate(uint8_t* bootloaderData, uint32_t bootloaderSize)
 
 	if (!err)
 	{
-		DLPC654X_WriteEraseSector(0x00000000);
+		err = DLPC654X_WriteEraseSector(0x00000000);
 
-		FILE* imgFile = tmpfile();
+		// the rest of the bootloader area is left erased
 		SectorAddressAndSize sector = { 0x20000, 0 };
-
-		uint32_t written = 0;
-
-		while (written < sector.size)
+		if (!err)
 		{
-			int toWrite;
-
-			if (written < bootloaderSize)
-			{
-				toWrite = bootloaderData[written];
-			}
-			else
-			{
-				toWrite = 0xFF;
-			}
-
-			fputc(toWrite, imgFile);
-			++written;
+			err = programSectorFromMemory(bootloaderData, bootloaderSize, sector);
 		}
 
-		rewind(imgFile);
-
-		programSector(imgFile, sector);
+		if (!err)
+		{
+			err = programFlashTableSignature(startOfFlashTable);
+		}
 
-		fclose(imgFile);
+		if (err)
+		{
+			fprintf(IN_STDERR, "Bootloader update failed (%u)\n", err);
+		}
 
-		programFlashTableSignature(startOfFlashTable);
+		uint32_t lockErr = setLockedForFlashProgramming(1);
 
-		setLockedForFlashProgramming(1);
+		if (!err)
+		{
+			err = lockErr;
+		}
 
-		switchToMainApp();
+		if (!err)
+		{
+			err = switchToMainApp();
+		}
 	}
 
 	if (allSectors != NULL)
@@ -1093,5 +1834,5 @@ int doFastBootloaderUpdate(uint8_t* bootloaderData, uint32_t bootloaderSize)
 		free(flashImgChecksums);
 	}
 
-	return 0;
+	return (int)err;
 }
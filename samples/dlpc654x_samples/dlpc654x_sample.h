@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include "../../api/dlpc654x.h"
+#include "../../api/dlpc_common_platform.h"
 
 #ifdef _WIN32
 #include <Windows.h> // sleep()
@@ -61,6 +62,33 @@ typedef struct
 	Checksum checksum;
 } AddressChecksum;
 
+/*
+ * A flash image mapped into memory. The image is mapped once and shared by
+ * every step of the update instead of reopening and re-reading the file.
+*/
+typedef struct
+{
+	const uint8_t* data;
+	uint32_t size;
+	DLPC_COMMON_MappedFile_s mapping;
+} FlashImage;
+
+/*
+ * The framing buffers and USB device behind a command context
+*/
+typedef struct CommandFrame CommandFrame;
+
+/*
+ * A projector opened with its own command context. Select the context with
+ * DLPC_COMMON_SetCommandContext(&projector.context) on the thread that commands the
+ * projector; several projectors can then be commanded from different threads.
+*/
+typedef struct
+{
+	DLPC_COMMON_CommandContext_s context;
+	CommandFrame*                frame;
+} Projector;
+
 enum FlashType
 {
 	NONE = 0,
@@ -91,6 +119,30 @@ EXPORTFUNC uint32_t doRead(uint16_t            WriteDataLength,
 */
 EXPORTFUNC uint32_t init();
 
+/*
+ * @brief prints the bus, port path and serial number of every attached projector
+ * @return the number of projectors found
+*/
+EXPORTFUNC uint32_t listProjectors();
+
+/*
+ * @brief selects the projector init() connects to by serial number or port path (e.g. 1-4.2),
+          NULL for the first one found
+ * @return 0 if successful or >0 if the transport can't select devices
+*/
+EXPORTFUNC uint32_t selectProjector(const char* serialOrPath);
+
+/*
+ * @brief opens a projector by serial number or port path with a command context of its own
+ * @return 0 if successful or >0 if no matching projector could be opened
+*/
+EXPORTFUNC uint32_t openProjector(const char* serialOrPath, /*out*/ Projector* projector);
+
+/*
+ * @brief closes a projector opened with openProjector
+*/
+EXPORTFUNC void closeProjector(Projector* projector);
+
 /*
  * @brief attempts to change the projector to bootloader mode, if not in it already
  * @param doChange toggles whether or not we should write the change mode command,
@@ -101,7 +153,9 @@ EXPORTFUNC uint32_t changeMode(uint8_t doChange);
 
 /*
  * @brief uses changeMode() to switch to bootloader mode, periodically checking
-          if the change has finished for up to MODE_SWITCH_TIMEOUT_S seconds
+          if the change has finished for up to MODE_SWITCH_TIMEOUT_S seconds.
+          Where the transport reports hotplug events, the projector is reopened as soon
+          as it re-enumerates instead of after fixed delays
  * @return  0 if the projector ends in bootloader mode, 1 otherwise
 */
 EXPORTFUNC uint32_t switchToBootloaderMode();
@@ -128,6 +182,28 @@ EXPORTFUNC uint32_t getSectorInfoCount();
  */
 EXPORTFUNC uint32_t getStartOfFlashTable(SectorAddressAndSize *allSectors, uint32_t numSectors, char* flashImgFile);
 
+/*
+ * @brief maps a flash image file into memory
+ * @param flashImgFile the path to the flash image file
+ * @param image [OUT] the mapped image, release it with closeFlashImage
+ * @return 0 if successful, >0 if the file could not be opened
+*/
+EXPORTFUNC uint32_t openFlashImage(const char* flashImgFile, /*out*/ FlashImage* image);
+
+/*
+ * @brief releases an image opened with openFlashImage
+*/
+EXPORTFUNC void closeFlashImage(FlashImage* image);
+
+/*
+ * @brief looks for the start of the flash table in a mapped flash image
+ * @param allSectors an array with the information for each sector (from getSectorStartAddressAndSize)
+ * @param numSectors the length of allSectors
+ * @param image the flash image
+ * @return the address of the start of the flash table, or UINT32_MAX if not found
+ */
+EXPORTFUNC uint32_t findStartOfFlashTable(SectorAddressAndSize* allSectors, uint32_t numSectors, const FlashImage* image);
+
 /*
  * @brief ensures that the flash image is not too large for the device
  * @param allSectors an array with the information for each sector (from getSectorStartAddressAndSize)
@@ -157,6 +233,16 @@ EXPORTFUNC Checksum getChecksum(FILE* imgFile, SectorAddressAndSize sector);
 */
 EXPORTFUNC AddressChecksum* getFlashImageChecksums(SectorAddressAndSize* allSectors, uint32_t numSectors, char* flashImgFile, /*out*/ uint32_t *numFlashImgChecksums);
 
+/*
+ * @brief gets the checksums for all sectors in a mapped flash image
+ * @param allSectors an array with the information for each sector (from getSectorStartAddressAndSize)
+ * @param numSectors the length of allSectors
+ * @param image the flash image
+ * @param numFlashImgChecksums [OUT] the number of checksums calculated
+ * @param an array of AddressChecksums containing the checksums of each sector from the flash image
+*/
+EXPORTFUNC AddressChecksum* getImageChecksums(SectorAddressAndSize* allSectors, uint32_t numSectors, const FlashImage* image, /*out*/ uint32_t *numFlashImgChecksums);
+
 /*
  * @brief gets the checksum for the given sector on the projector
  * @param sector the sector to get the checksum for
@@ -203,6 +289,24 @@ EXPORTFUNC uint32_t setLockedForFlashProgramming(uint8_t locked);
 EXPORTFUNC uint32_t eraseSectors(SectorAddressAndSize* sectorsToProgram, uint32_t numSectors,
 		                       	 uint32_t startOfFlashTable, enum FlashType flashType);
 
+/*
+ * @brief sets the number of bytes sent with each flash write command by the calling thread
+ * @param blockSize the block size, rounded down to an even value and limited to the write buffer
+*/
+EXPORTFUNC void setFlashBlockSize(uint16_t blockSize);
+
+/*
+ * @brief gets the number of bytes sent with each flash write command
+ * @return the block size in bytes
+*/
+EXPORTFUNC uint16_t getFlashBlockSize();
+
+/*
+ * @brief times the next flash writes with a range of block sizes and switches
+          to the fastest one once every size has been tried
+*/
+EXPORTFUNC void tuneFlashBlockSize();
+
 /*
  * @brief programs a sector on the chip with the sector from the flash image
  * @param imgFile the opened FILE* handle to the flash image file
@@ -211,6 +315,16 @@ EXPORTFUNC uint32_t eraseSectors(SectorAddressAndSize* sectorsToProgram, uint32_
 */
 EXPORTFUNC uint32_t programSector(FILE* imgFile, SectorAddressAndSize sector);
 
+/*
+ * @brief programs a sector on the chip straight from a flash image held in memory
+ * @param data the flash image, indexed by the sector start address
+ * @param len the number of bytes in data. Only the part of the sector inside the
+              image is written, padded with 0xFF to an even length
+ * @param sector the sector to flash
+ * @return 0 if successful or >0 on error
+*/
+EXPORTFUNC uint32_t programSectorFromMemory(const uint8_t* data, size_t len, SectorAddressAndSize sector);
+
 /*
  * @brief programs the given sectors on the chip
  * @param sectorsToProgram the sectors to program
@@ -223,6 +337,18 @@ EXPORTFUNC uint32_t programSector(FILE* imgFile, SectorAddressAndSize sector);
 EXPORTFUNC uint32_t programSectors(SectorAddressAndSize* sectorsToProgram, uint32_t numSectorsToProgram,
 							   	   uint32_t startOfFlashTable, char* flashImgFile, enum FlashType flashType);
 
+/*
+ * @brief programs the given sectors on the chip from a mapped flash image
+ * @param sectorsToProgram the sectors to program
+ * @param numSectorsToProgram the length of sectorsToProgram
+ * @param startOfFlashTable the address of the start of the flash table
+ * @param image the flash image
+ * @param flashType which sectors to flash
+ * @return 0 if successful or >0 on error
+*/
+EXPORTFUNC uint32_t programImageSectors(SectorAddressAndSize* sectorsToProgram, uint32_t numSectorsToProgram,
+	uint32_t startOfFlashTable, const FlashImage* image, enum FlashType flashType);
+
 /*
  * @brief programs the flash table signature
  * @param startOfFlashTable the address of the start of the flash table
@@ -248,7 +374,8 @@ EXPORTFUNC uint32_t verifyFlashData(SectorAddressAndSize* sectorsToProgram,
 	enum FlashType flashType);
 
 /*
- * @brief switches to the main application via reset
+ * @brief switches to the main application via reset. Where the transport reports hotplug events,
+          waits for the projector to re-enumerate and confirms the main application is running
  * @return 0 if successful or >0 on error
 */
 EXPORTFUNC uint32_t switchToMainApp();
@@ -262,4 +389,35 @@ EXPORTFUNC uint32_t switchToMainApp();
 */
 EXPORTFUNC int doFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType);
 
+/*
+ * @brief same as doFlashUpdate, with control over the flash block size tuning
+ * @param filePath path to flash image file
+ * @param flashModifiedSectorsOnly 1 = flash only modified sectors, 0 = flash all sectors
+ * @param flashType the type of flash to perform
+ * @param retuneBlockSize 1 = time the flash block sizes again, 0 = use the stored block size if there is one.
+ *        Block sizes are stored per adapter (serial number, or port path) in dlpc654x_tuning.cfg
+ * @return 0 if successful, >0 on error
+*/
+EXPORTFUNC int doFlashUpdateEx(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType, uint8_t retuneBlockSize);
+
+/*
+ * @brief updates every attached projector with the data pointed to by file `filePath`. The projectors
+          are found by bus, port path and serial number and updated concurrently, one thread each,
+          from one mapping of the image. A progress table is printed while the update runs.
+          The stored flash block size is used, the block size isn't tuned.
+ * @param filePath path to flash image file
+ * @param flashModifiedSectorsOnly 1 = flash only modified sectors, 0 = flash all sectors
+ * @param flashType the type of flash to perform
+ * @return 0 if every projector was updated, the first error otherwise
+*/
+EXPORTFUNC int doFleetFlashUpdate(char* filePath, uint8_t flashModifiedSectorsOnly, enum FlashType flashType);
+
+/*
+ * @brief replaces the bootloader with the given bootloader binary
+ * @param bootloaderData the bootloader binary
+ * @param bootloaderSize the number of bytes in bootloaderData
+ * @return 0 if successful, >0 on error
+*/
+EXPORTFUNC int doFastBootloaderUpdate(uint8_t* bootloaderData, uint32_t bootloaderSize);
+
 #endif
@@ -0,0 +1,255 @@
+#include "flash_checksum.h"
+#include "../../api/dlpc_common_platform.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define MAX_CHECKSUM_THREADS 16
+
+/*
+ * For a block of m bytes b[0..m-1] added to a running checksum (S, T):
+ *     S' = S + sum(b[i])
+ *     T' = T + m * S + sum((m - i) * b[i])
+ * The vector loops compute the block sums a chunk at a time. Everything wraps
+ * modulo 2^32 like the controller, so the lane sums never need reducing.
+ */
+
+static void updateChecksumScalar(Checksum* checksum, const uint8_t* data, uint32_t length)
+{
+	uint32_t simple = checksum->simpleCheckSum;
+	uint32_t sumOfSums = checksum->sumOfSumChecksum;
+
+	for (uint32_t i = 0; i < length; ++i)
+	{
+		simple += data[i];
+		sumOfSums += simple;
+	}
+
+	checksum->simpleCheckSum = simple;
+	checksum->sumOfSumChecksum = sumOfSums;
+}
+
+#if defined(__AVX2__)
+
+#define CHUNK_SIZE 32
+
+static uint32_t sumLanes(__m256i v)
+{
+	__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+/* Returns the number of bytes consumed, a multiple of CHUNK_SIZE */
+static uint32_t updateChecksumVector(Checksum* checksum, const uint8_t* data, uint32_t length)
+{
+	const __m256i weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m256i ones = _mm256_set1_epi16(1);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i sums = zero;        // sum of all bytes
+	__m256i prefixSums = zero;  // sum of the byte sums before each chunk
+	__m256i weightedSums = zero;
+	uint32_t numChunks = length / CHUNK_SIZE;
+
+	for (uint32_t i = 0; i < numChunks; ++i)
+	{
+		__m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i * CHUNK_SIZE));
+
+		prefixSums = _mm256_add_epi32(prefixSums, sums);
+		sums = _mm256_add_epi32(sums, _mm256_sad_epu8(chunk, zero));
+		weightedSums = _mm256_add_epi32(weightedSums,
+			_mm256_madd_epi16(_mm256_maddubs_epi16(chunk, weights), ones));
+	}
+
+	uint32_t blockLength = numChunks * CHUNK_SIZE;
+	checksum->sumOfSumChecksum += blockLength * checksum->simpleCheckSum
+		+ CHUNK_SIZE * sumLanes(prefixSums) + sumLanes(weightedSums);
+	checksum->simpleCheckSum += sumLanes(sums);
+
+	return blockLength;
+}
+
+#elif defined(USE_SSE2)
+
+#define CHUNK_SIZE 16
+
+static uint32_t sumLanes(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+/* Returns the number of bytes consumed, a multiple of CHUNK_SIZE */
+static uint32_t updateChecksumVector(Checksum* checksum, const uint8_t* data, uint32_t length)
+{
+	const __m128i weightsLow = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+	const __m128i weightsHigh = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sums = zero;        // sum of all bytes
+	__m128i prefixSums = zero;  // sum of the byte sums before each chunk
+	__m128i weightedSums = zero;
+	uint32_t numChunks = length / CHUNK_SIZE;
+
+	for (uint32_t i = 0; i < numChunks; ++i)
+	{
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + i * CHUNK_SIZE));
+
+		prefixSums = _mm_add_epi32(prefixSums, sums);
+		sums = _mm_add_epi32(sums, _mm_sad_epu8(chunk, zero));
+		weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpacklo_epi8(chunk, zero), weightsLow));
+		weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpackhi_epi8(chunk, zero), weightsHigh));
+	}
+
+	uint32_t blockLength = numChunks * CHUNK_SIZE;
+	checksum->sumOfSumChecksum += blockLength * checksum->simpleCheckSum
+		+ CHUNK_SIZE * sumLanes(prefixSums) + sumLanes(weightedSums);
+	checksum->simpleCheckSum += sumLanes(sums);
+
+	return blockLength;
+}
+
+#else
+
+static uint32_t updateChecksumVector(Checksum* checksum, const uint8_t* data, uint32_t length)
+{
+	return 0;
+}
+
+#endif
+
+void updateChecksum(Checksum* checksum, const uint8_t* data, uint32_t length)
+{
+	uint32_t consumed = updateChecksumVector(checksum, data, length);
+	updateChecksumScalar(checksum, data + consumed, length - consumed);
+}
+
+Checksum combineChecksums(Checksum first, Checksum second, uint32_t secondSize)
+{
+	Checksum checksum;
+	checksum.simpleCheckSum = first.simpleCheckSum + second.simpleCheckSum;
+	checksum.sumOfSumChecksum = first.sumOfSumChecksum + secondSize * first.simpleCheckSum + second.sumOfSumChecksum;
+
+	return checksum;
+}
+
+/* Adds count bytes of erased flash (0xFF) without touching memory */
+static void addErasedBytes(Checksum* checksum, uint32_t count)
+{
+	uint64_t triangle = ((uint64_t)count * (count + 1)) / 2;
+
+	checksum->sumOfSumChecksum += count * checksum->simpleCheckSum + (uint32_t)(triangle * 0xFF);
+	checksum->simpleCheckSum += count * 0xFF;
+}
+
+Checksum getImageSectorChecksum(const uint8_t* image, uint32_t imageSize, SectorAddressAndSize sector)
+{
+	Checksum checksum;
+	checksum.simpleCheckSum = 0;
+	checksum.sumOfSumChecksum = 0;
+
+	uint32_t inImage = 0;
+	if (sector.startAddress < imageSize)
+	{
+		inImage = imageSize - sector.startAddress;
+		if (inImage > sector.size)
+		{
+			inImage = sector.size;
+		}
+		updateChecksum(&checksum, image + sector.startAddress, inImage);
+	}
+
+	addErasedBytes(&checksum, sector.size - inImage);
+
+	return checksum;
+}
+
+typedef struct
+{
+	const uint8_t* image;
+	uint32_t imageSize;
+	const SectorAddressAndSize* sectors;
+	uint32_t numSectors;
+	AddressChecksum* checksums;
+} ChecksumJob;
+
+static uint32_t runChecksumJob(void* argument)
+{
+	ChecksumJob* job = (ChecksumJob*)argument;
+
+	for (uint32_t i = 0; i < job->numSectors; ++i)
+	{
+		job->checksums[i].startAddress = job->sectors[i].startAddress;
+		job->checksums[i].checksum = getImageSectorChecksum(job->image, job->imageSize, job->sectors[i]);
+	}
+
+	return 0;
+}
+
+void getImageSectorChecksums(const uint8_t* image,
+	uint32_t imageSize,
+	const SectorAddressAndSize* sectors,
+	uint32_t numSectors,
+	/*out*/ AddressChecksum* checksums,
+	uint32_t numThreads)
+{
+	ChecksumJob jobs[MAX_CHECKSUM_THREADS];
+	DLPC_COMMON_Thread_s threads[MAX_CHECKSUM_THREADS];
+	uint8_t started[MAX_CHECKSUM_THREADS];
+	uint32_t numJobs = numThreads;
+
+	if (numJobs > MAX_CHECKSUM_THREADS)
+	{
+		numJobs = MAX_CHECKSUM_THREADS;
+	}
+	if (numJobs > numSectors)
+	{
+		numJobs = numSectors;
+	}
+	if (numJobs == 0)
+	{
+		numJobs = 1;
+	}
+
+	// split into runs of neighbouring sectors so each thread streams through its own part of the image
+	uint32_t firstSector = 0;
+	for (uint32_t i = 0; i < numJobs; ++i)
+	{
+		uint32_t count = (numSectors - firstSector) / (numJobs - i);
+
+		jobs[i].image = image;
+		jobs[i].imageSize = imageSize;
+		jobs[i].sectors = sectors + firstSector;
+		jobs[i].numSectors = count;
+		jobs[i].checksums = checksums + firstSector;
+		firstSector += count;
+	}
+
+	// the calling thread takes the first job, and any job a thread could not be started for
+	for (uint32_t i = 1; i < numJobs; ++i)
+	{
+		started[i] = DLPC_COMMON_CreateThread(runChecksumJob, &jobs[i], &threads[i]) == 0;
+		if (!started[i])
+		{
+			runChecksumJob(&jobs[i]);
+		}
+	}
+
+	runChecksumJob(&jobs[0]);
+
+	for (uint32_t i = 1; i < numJobs; ++i)
+	{
+		if (started[i])
+		{
+			DLPC_COMMON_JoinThread(&threads[i]);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include "dlpc654x_sample.h"
+
+/*
+ * @brief adds data to a running checksum. The simple checksum is the sum of all
+          bytes and the sum of sums checksum is the sum of the running simple
+          checksum after each byte, both modulo 2^32, as computed by the controller
+          for DLPC654X_ReadChecksum. Uses SIMD when the compiler targets SSE2 or AVX2.
+ * @param checksum [IN/OUT] the checksum of the preceding data, zero to start
+ * @param data the data to add
+ * @param length the number of bytes in data
+*/
+EXPORTFUNC void updateChecksum(Checksum* checksum, const uint8_t* data, uint32_t length);
+
+/*
+ * @brief gets the checksum of two adjacent ranges from the checksums of each range
+ * @param first the checksum of the lower range
+ * @param second the checksum of the range that directly follows it
+ * @param secondSize the number of bytes in the second range
+ * @return the checksum of both ranges together
+*/
+EXPORTFUNC Checksum combineChecksums(Checksum first, Checksum second, uint32_t secondSize);
+
+/*
+ * @brief gets the checksum of a sector of a flash image held in memory. Bytes
+          of the sector past the end of the image count as erased flash (0xFF).
+ * @param image the flash image
+ * @param imageSize the number of bytes in image
+ * @param sector the sector to get the checksum for
+ * @return the checksum of the sector
+*/
+EXPORTFUNC Checksum getImageSectorChecksum(const uint8_t* image, uint32_t imageSize, SectorAddressAndSize sector);
+
+/*
+ * @brief gets the checksums of several sectors of a flash image held in memory
+ * @param image the flash image
+ * @param imageSize the number of bytes in image
+ * @param sectors the sectors to get the checksums for
+ * @param numSectors the length of sectors and checksums
+ * @param checksums [OUT] the address and checksum of each sector
+ * @param numThreads the number of threads to split the sectors across, 0 or 1
+                     computes all checksums on the calling thread
+*/
+EXPORTFUNC void getImageSectorChecksums(const uint8_t* image,
+	uint32_t imageSize,
+	const SectorAddressAndSize* sectors,
+	uint32_t numSectors,
+	/*out*/ AddressChecksum* checksums,
+	uint32_t numThreads);
@@ -9,6 +9,14 @@ void printUsage()
 	printf("\t\tUpdate modified sectors only\n");
 	printf("\t-b\n");
 	printf("\t\tProgram bootloader (skipped by default)\n");
+	printf("\t-t\n");
+	printf("\t\tRe-tune the flash block size\n");
+	printf("\t-s <serial number | port path>\n");
+	printf("\t\tUpdate the projector with this serial number or on this USB port\n");
+	printf("\t-l\n");
+	printf("\t\tList the attached projectors\n");
+	printf("\t-a\n");
+	printf("\t\tUpdate all attached projectors concurrently\n");
 	printf("=======================================================\n\n");
 }
 
@@ -22,6 +30,8 @@ int main(int argc, char** argv)
 
 	uint8_t modifiedOnly = 0;
 	uint8_t skipBootloader = 1;
+	uint8_t retuneBlockSize = 0;
+	uint8_t allProjectors = 0;
 
 	size_t i;
 
@@ -37,6 +47,21 @@ int main(int argc, char** argv)
 			case 'b':
 				skipBootloader = 0;
 				break;
+			case 't':
+				retuneBlockSize = 1;
+				break;
+			case 's':
+				if (i + 1 >= argc || selectProjector(argv[++i]))
+				{
+					printUsage();
+					return 1;
+				}
+				break;
+			case 'l':
+				return listProjectors() == 0;
+			case 'a':
+				allProjectors = 1;
+				break;
 			default:
 				printUsage();
 				return 1;
@@ -48,5 +73,10 @@ int main(int argc, char** argv)
 	printf("Updating flash\nUpdating modified sectors only? %d\nProgramming bootloader? %d\n", modifiedOnly, !skipBootloader);
 	printf("=================================\n\n");
 
-	return doFlashUpdate(argv[1], modifiedOnly, APPLICATION | skipBootloader);
+	if (allProjectors)
+	{
+		return doFleetFlashUpdate(argv[1], modifiedOnly, APPLICATION | skipBootloader);
+	}
+
+	return doFlashUpdateEx(argv[1], modifiedOnly, APPLICATION | skipBootloader, retuneBlockSize);
 }
\ No newline at end of file
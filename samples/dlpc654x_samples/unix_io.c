@@ -1,147 +1,860 @@
 #include "unix_io.h"
+#include "../../api/dlpc_common_platform.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include <libusb.h>
 
 #define USB_ENDPOINT_IN	    (LIBUSB_ENDPOINT_IN  | 1)   /* endpoint address */
 #define USB_ENDPOINT_OUT	(LIBUSB_ENDPOINT_OUT | 2)   /* endpoint address */
 #define USB_TIMEOUT	        2000        /* Connection timeout (in ms) */
 
+#define MAX_PACKET_SIZE     1024        /* largest bulk wMaxPacketSize (SuperSpeed) */
+#define MAX_PORT_DEPTH      7           /* USB allows up to 7 tiers */
+#define READ_FAILED         0xFFFF
+#define EVENT_TIMEOUT_US    100000      /* how often the event thread checks for a stop */
+#define RECONNECT_POLL_MS   50
+
+typedef enum
+{
+    TRANSFER_FREE,
+    TRANSFER_PENDING,
+    TRANSFER_DONE
+} TransferState;
+
+struct IoTransfer
+{
+    struct libusb_transfer* transfer;
+    IoDevice*               device;
+    uint8_t                 buffer[IO_ASYNC_BUFFER_SIZE];
+    TransferState           state;
+    uint8_t                 detached;
+    uint32_t                status;
+    uint32_t                length;
+    IoCallback              callback;
+    void*                   userData;
+};
+
+struct IoDevice
+{
+    libusb_device_handle* handle;
+    int                   maxPacketSize;
+
+    // the device to open: a serial number or port path, empty for the first one found
+    char                  selector[MAX_STR];
+    // the port the device was opened on, which it comes back on after a reset
+    char                  portPath[IO_MAX_PORT_PATH];
+    // empty if the device has none
+    char                  serialNumber[MAX_STR];
+
+    /*
+     * libusb can't request part of a packet (asking for 3 bytes of a 64 byte packet overflows),
+     * so a read that ends inside a packet receives the whole packet here and the rest of it is
+     * handed out by the next read of the same response.
+    */
+    uint8_t               packetBuf[MAX_PACKET_SIZE];
+    uint32_t              packetLength;
+    uint32_t              packetOffset;
+    uint8_t               responseEnded;
+
+    // the async pool; the state of its transfers is guarded by asyncLock
+    IoTransfer*           asyncPool;
+    uint32_t              asyncPoolSize;
+    uint32_t              asyncInFlight;
+    uint32_t              asyncError;
+    volatile uint8_t      asyncRunning;
+    DLPC_COMMON_Thread_s  asyncThread;
+    pthread_mutex_t       asyncLock;
+    pthread_cond_t        asyncCond;
+
+    // hotplug state for ioDeviceArmReconnect/ioDeviceReconnect, times in microseconds
+    libusb_hotplug_callback_handle hotplugHandle;
+    uint8_t               hotplugRegistered;
+    uint64_t              reconnectArmTime;
+    uint64_t              deviceLeftTime;
+    uint64_t              deviceArrivedTime;
+    libusb_device*        arrivedDevice;
+    pthread_mutex_t       hotplugLock;
+};
+
 static libusb_context *ctx = NULL;
-static libusb_device_handle *handle;
 
-// ioRead fakes read operations, necessitating the use of a second buffer
-static uint8_t receiveBuf[UINT16_MAX];
-int totalReceive = 0;
-uint16_t totalRead = 0;
-uint8_t  lastTransferWasWrite = 0;
+// the device used by the functions without a device parameter
+static IoDevice defaultDevice = {
+    .maxPacketSize = 512,
+    .asyncLock = PTHREAD_MUTEX_INITIALIZER,
+    .asyncCond = PTHREAD_COND_INITIALIZER,
+    .hotplugLock = PTHREAD_MUTEX_INITIALIZER
+};
 
-uint8_t variableLengthRead;
+static uint32_t initLibrary()
+{
+    if (!ctx)
+    {
+        if (libusb_init(&ctx))
+        {
+            ctx = NULL;
+            return 1;
+        }
+        libusb_set_option(ctx, LIBUSB_OPTION_LOG_LEVEL, 3);
+    }
+    return 0;
+}
 
-/*
- * libusb (on Linux, at least) can't handle fine-grained read sizes (i.e., try to read 3, get 4 returned)
- * Because of this, I had to do things kind of weird to make it work with the current business logic of:
- *      Step 1: Read header
- *      Step 2: Read data
- * Basically, my solution is to just read as much as possible in step 1, and then "fake" the read in step 2
- *
- * Since each read operation is preceeded by a write operation, we can use whether or not the previous
- * operation was a write to determine whether or not to do a real read operation or to fake one
-*/
-uint32_t ioRead(char* buffer, uint32_t dwSize)
+static void getPortPath(libusb_device* device, char* portPath)
 {
-    int ret = 0;
+    uint8_t ports[MAX_PORT_DEPTH];
+    int numPorts = libusb_get_port_numbers(device, ports, MAX_PORT_DEPTH);
+    int length = snprintf(portPath, IO_MAX_PORT_PATH, "%u", libusb_get_bus_number(device));
+
+    // same format as the kernel's sysfs names, e.g. 1-4.2
+    for (int i = 0; i < numPorts && length < IO_MAX_PORT_PATH; ++i)
+    {
+        length += snprintf(portPath + length, IO_MAX_PORT_PATH - length, "%c%u", i == 0 ? '-' : '.', ports[i]);
+    }
+}
+
+static void getSerialNumber(libusb_device* device, uint8_t serialIndex, char* serialNumber)
+{
+    libusb_device_handle* deviceHandle;
+
+    serialNumber[0] = '\0';
+
+    // a device that can't be opened (in use elsewhere, no permission) is listed without a serial number
+    if (serialIndex && libusb_open(device, &deviceHandle) == 0)
+    {
+        if (libusb_get_string_descriptor_ascii(deviceHandle, serialIndex, (unsigned char*)serialNumber, MAX_STR) < 0)
+        {
+            serialNumber[0] = '\0';
+        }
+        libusb_close(deviceHandle);
+    }
+}
+
+static uint8_t isDevice(libusb_device* device, struct libusb_device_descriptor* descriptor)
+{
+    return libusb_get_device_descriptor(device, descriptor) == 0
+        && descriptor->idVendor == VID_DEVICE
+        && descriptor->idProduct == PID_DEVICE;
+}
+
+uint32_t ioEnumerateDevices(IoDeviceInfo* devices, uint32_t maxDevices)
+{
+    libusb_device** list;
+    uint32_t numDevices = 0;
+
+    if (initLibrary())
+    {
+        return 0;
+    }
+
+    ssize_t count = libusb_get_device_list(ctx, &list);
+
+    for (ssize_t i = 0; i < count && numDevices < maxDevices; ++i)
+    {
+        struct libusb_device_descriptor descriptor;
+
+        if (isDevice(list[i], &descriptor))
+        {
+            IoDeviceInfo* info = &devices[numDevices++];
+
+            info->busNumber = libusb_get_bus_number(list[i]);
+            info->address = libusb_get_device_address(list[i]);
+            getPortPath(list[i], info->portPath);
+            getSerialNumber(list[i], descriptor.iSerialNumber, info->serialNumber);
+        }
+    }
+
+    if (count >= 0)
+    {
+        libusb_free_device_list(list, 1);
+    }
+    return numDevices;
+}
+
+static uint32_t claimDevice(IoDevice* device)
+{
+    int packetSize = libusb_get_max_packet_size(libusb_get_device(device->handle), USB_ENDPOINT_IN);
+    if (packetSize > 0 && packetSize <= MAX_PACKET_SIZE)
+    {
+        device->maxPacketSize = packetSize;
+    }
+
+    getPortPath(libusb_get_device(device->handle), device->portPath);
+
+    struct libusb_device_descriptor descriptor;
+    device->serialNumber[0] = '\0';
+    if (libusb_get_device_descriptor(libusb_get_device(device->handle), &descriptor) == 0 && descriptor.iSerialNumber
+        && libusb_get_string_descriptor_ascii(device->handle, descriptor.iSerialNumber, (unsigned char*)device->serialNumber, MAX_STR) < 0)
+    {
+        device->serialNumber[0] = '\0';
+    }
+
+    int ret = libusb_claim_interface(device->handle, 0);
+
+    if (ret < 0) {
+        fprintf(stderr, "usb_claim_interface error %d\n", ret);
+        return 1;
+    }
+
+    printf("Device connected (%s)\n", device->portPath);
+
+    return 0;
+}
+
+uint32_t ioDeviceConnect(IoDevice* device)
+{
+    libusb_device** list;
+
+    if (initLibrary())
+    {
+        return 1;
+    }
+
+    ssize_t count = libusb_get_device_list(ctx, &list);
+
+    for (ssize_t i = 0; i < count && !device->handle; ++i)
+    {
+        struct libusb_device_descriptor descriptor;
+
+        if (!isDevice(list[i], &descriptor))
+        {
+            continue;
+        }
+
+        char portPath[IO_MAX_PORT_PATH];
+        getPortPath(list[i], portPath);
+
+        // once connected, the device is looked for on the same port again
+        const char* wanted = device->portPath[0] != '\0' ? device->portPath : device->selector;
+
+        uint8_t matches = wanted[0] == '\0' || strcmp(wanted, portPath) == 0;
+        if (!matches && device->portPath[0] == '\0')
+        {
+            char serialNumber[MAX_STR];
+            getSerialNumber(list[i], descriptor.iSerialNumber, serialNumber);
+            matches = strcmp(device->selector, serialNumber) == 0;
+        }
+
+        if (matches && libusb_open(list[i], &device->handle))
+        {
+            device->handle = NULL;
+        }
+    }
+
+    if (count >= 0)
+    {
+        libusb_free_device_list(list, 1);
+    }
+
+    if (!device->handle) {
+        printf("ERROR: Could not connect to device\n");
+        return 1;
+    }
+
+    return claimDevice(device);
+}
+
+void ioDeviceDisconnect(IoDevice* device)
+{
+    ioDeviceStopAsync(device);
+    if (device->handle)
+    {
+        libusb_release_interface(device->handle, 0);
+        libusb_close(device->handle);
+        device->handle = NULL;
+    }
+}
+
+IoDevice* ioOpenDevice(const char* serialOrPath)
+{
+    IoDevice* device = (IoDevice*)calloc(1, sizeof(IoDevice));
 
-    if (lastTransferWasWrite)
+    if (!device)
     {
-        totalRead = 0;
-        totalReceive = 0;
-        ret = libusb_bulk_transfer(handle, 0x81, receiveBuf, UINT16_MAX, &totalReceive, 0);
+        return NULL;
     }
 
-    lastTransferWasWrite = 0;
+    device->maxPacketSize = 512;
+    pthread_mutex_init(&device->asyncLock, NULL);
+    pthread_cond_init(&device->asyncCond, NULL);
+    pthread_mutex_init(&device->hotplugLock, NULL);
+
+    if (serialOrPath)
+    {
+        strncpy(device->selector, serialOrPath, MAX_STR - 1);
+    }
 
-    for (int i = 0; i < dwSize; ++i)
+    if (ioDeviceConnect(device))
     {
-        buffer[i] = receiveBuf[i + totalRead];
+        ioCloseDevice(device);
+        return NULL;
     }
+    return device;
+}
 
-    totalRead += dwSize;
+void ioCloseDevice(IoDevice* device)
+{
+    if (!device || device == &defaultDevice)
+    {
+        return;
+    }
+
+    ioDeviceDisconnect(device);
+    if (device->hotplugRegistered)
+    {
+        libusb_hotplug_deregister_callback(ctx, device->hotplugHandle);
+    }
+    if (device->arrivedDevice)
+    {
+        libusb_unref_device(device->arrivedDevice);
+    }
+
+    pthread_mutex_destroy(&device->asyncLock);
+    pthread_cond_destroy(&device->asyncCond);
+    pthread_mutex_destroy(&device->hotplugLock);
+    free(device);
+}
+
+IoDevice* ioGetDefaultDevice()
+{
+    return &defaultDevice;
+}
+
+const char* ioDeviceGetSerialNumber(IoDevice* device)
+{
+    return device->serialNumber;
+}
+
+const char* ioDeviceGetPortPath(IoDevice* device)
+{
+    return device->portPath;
+}
+
+uint32_t ioSelectDevice(const char* serialOrPath)
+{
+    strncpy(defaultDevice.selector, serialOrPath ? serialOrPath : "", MAX_STR - 1);
+    defaultDevice.portPath[0] = '\0';
+    return 0;
+}
+
+static void waitForAsync(IoDevice* device)
+{
+    pthread_mutex_lock(&device->asyncLock);
+    while (device->asyncInFlight > 0)
+    {
+        pthread_cond_wait(&device->asyncCond, &device->asyncLock);
+    }
+    pthread_mutex_unlock(&device->asyncLock);
+}
 
+static void printTransferError(const char* direction, int ret)
+{
     switch(ret){
-        case 0:
-            break;
         case LIBUSB_ERROR_TIMEOUT:
-            printf("ERROR in bulk read: %d Timeout\n", ret);
+            printf("ERROR in bulk %s: %d Timeout\n", direction, ret);
             break;
         case LIBUSB_ERROR_PIPE:
-            printf("ERROR in bulk read: %d Pipe\n", ret);
+            printf("ERROR in bulk %s: %d Pipe\n", direction, ret);
             break;
         case LIBUSB_ERROR_OVERFLOW:
-            printf("ERROR in bulk read: %d Overflow\n", ret);
+            printf("ERROR in bulk %s: %d Overflow\n", direction, ret);
             break;
         case LIBUSB_ERROR_NO_DEVICE:
-            printf("ERROR in bulk read: %d No Device\n", ret);
+            printf("ERROR in bulk %s: %d No Device\n", direction, ret);
             break;
         case LIBUSB_ERROR_BUSY:
-            printf("ERROR in bulk read: %d Busy\n", ret);
+            printf("ERROR in bulk %s: %d Busy\n", direction, ret);
             break;
         case LIBUSB_ERROR_INVALID_PARAM:
-            printf("ERROR in bulk read: %d Invalid param\n", ret);
+            printf("ERROR in bulk %s: %d Invalid param\n", direction, ret);
             break;
         default:
-            printf("ERROR in bulk read: %d\n", ret);
+            printf("ERROR in bulk %s: %d\n", direction, ret);
             break;
+    }
+}
+
+/*
+ * Reads the next dwSize bytes of the current response. Whole packets are transferred straight
+ * into the caller's buffer; only a trailing partial packet goes through packetBuf.
+ * A short packet ends the response, after which reads return what was left of it.
+ * Returns the number of bytes read, or 0xFFFF if a transfer failed.
+*/
+uint32_t ioDeviceRead(IoDevice* device, char* buffer, uint32_t dwSize)
+{
+    uint8_t* dest = (uint8_t*)buffer;
+    uint32_t totalRead = device->packetLength - device->packetOffset;
+
+    if (totalRead > dwSize)
+    {
+        totalRead = dwSize;
+    }
+
+    memcpy(dest, device->packetBuf + device->packetOffset, totalRead);
+    device->packetOffset += totalRead;
+
+    while (totalRead < dwSize && !device->responseEnded)
+    {
+        uint32_t remaining = dwSize - totalRead;
+        int maxPacketSize = device->maxPacketSize;
+        int received = 0;
+        int ret;
+
+        if (remaining >= (uint32_t)maxPacketSize)
+        {
+            int length = remaining - remaining % maxPacketSize;
+
+            ret = libusb_bulk_transfer(device->handle, USB_ENDPOINT_IN, dest + totalRead, length, &received, USB_TIMEOUT);
+            totalRead += received;
+            device->responseEnded = received < length;
+        }
+        else
+        {
+            ret = libusb_bulk_transfer(device->handle, USB_ENDPOINT_IN, device->packetBuf, maxPacketSize, &received, USB_TIMEOUT);
+            device->packetLength = received;
+            device->packetOffset = (uint32_t)received < remaining ? received : remaining;
+            memcpy(dest + totalRead, device->packetBuf, device->packetOffset);
+            totalRead += device->packetOffset;
+            device->responseEnded = received < maxPacketSize;
+        }
 
+        if (ret)
+        {
+            printTransferError("read", ret);
+            return READ_FAILED;
+        }
     }
-    return totalReceive;
+
+    return totalRead;
 }
 
-uint32_t ioWrite(char* buffer, uint32_t dwSize)
+uint32_t ioDeviceWrite(IoDevice* device, char* buffer, uint32_t dwSize)
 {
     int ret = 0;
     int bytesWritten = 0xFFFFFFFF;
 
-    lastTransferWasWrite = 1;
+    // queued transfers go first, so that their ACKs aren't taken for this write's response
+    waitForAsync(device);
 
-    ret = libusb_bulk_transfer(handle, 0x01, buffer, dwSize, &bytesWritten, USB_TIMEOUT);
+    // whatever is left of the previous response is dropped
+    device->packetLength = 0;
+    device->packetOffset = 0;
+    device->responseEnded = 0;
 
-    switch(ret){
-        case 0:
-            return 0;
-            break;
-        case LIBUSB_ERROR_TIMEOUT:
-            printf("ERROR in bulk write: %d Timeout\n", ret);
-            break;
-        case LIBUSB_ERROR_PIPE:
-            printf("ERROR in bulk write: %d Pipe\n", ret);
-            break;
-        case LIBUSB_ERROR_OVERFLOW:
-            printf("ERROR in bulk write: %d Overflow\n", ret);
-            break;
-        case LIBUSB_ERROR_NO_DEVICE:
-            printf("ERROR in bulk write: %d No Device\n", ret);
-            break;
-        case LIBUSB_ERROR_BUSY:
-            printf("ERROR in bulk write: %d Busy\n", ret);
-            break;
-        case LIBUSB_ERROR_INVALID_PARAM:
-            printf("ERROR in bulk write: %d Invalid param\n", ret);
-            break;
-        default:
-            printf("ERROR in bulk write: %d\n", ret);
-            break;
+    ret = libusb_bulk_transfer(device->handle, 0x01, buffer, dwSize, &bytesWritten, USB_TIMEOUT);
 
+    if (ret)
+    {
+        printTransferError("write", ret);
+        return -1;
     }
-    return -1;
+    return 0;
 }
 
-uint32_t ioInit()
+static void LIBUSB_CALL transferComplete(struct libusb_transfer* transfer)
 {
-    libusb_init(&ctx);
-    handle = libusb_open_device_with_vid_pid(ctx, VID_DEVICE, PID_DEVICE);
+    IoTransfer* ioTransfer = (IoTransfer*)transfer->user_data;
+    IoDevice* device = ioTransfer->device;
+    uint32_t status = transfer->status == LIBUSB_TRANSFER_COMPLETED ? 0 : (uint32_t)transfer->status;
 
-    if (!handle) {
-        printf("ERROR: Could not connect to device\n");
+    if (ioTransfer->callback)
+    {
+        ioTransfer->callback(status, ioTransfer->buffer, transfer->actual_length, ioTransfer->userData);
+    }
+
+    pthread_mutex_lock(&device->asyncLock);
+    ioTransfer->status = status;
+    ioTransfer->length = transfer->actual_length;
+    ioTransfer->state = TRANSFER_DONE;
+
+    if (ioTransfer->detached)
+    {
+        if (status && !device->asyncError)
+        {
+            device->asyncError = status;
+        }
+        ioTransfer->state = TRANSFER_FREE;
+    }
+
+    --device->asyncInFlight;
+    pthread_cond_broadcast(&device->asyncCond);
+    pthread_mutex_unlock(&device->asyncLock);
+}
+
+static uint32_t handleEvents(void* argument)
+{
+    IoDevice* device = (IoDevice*)argument;
+
+    while (device->asyncRunning)
+    {
+        struct timeval timeout = { 0, EVENT_TIMEOUT_US };
+        libusb_handle_events_timeout_completed(ctx, &timeout, NULL);
+    }
+    return 0;
+}
+
+static uint32_t submitTransfer(IoDevice* device,
+    unsigned char endpoint,
+    const char* buffer,
+    uint32_t dwSize,
+    IoCallback callback,
+    void* userData,
+    IoTransfer** transfer)
+{
+    if (!device->asyncRunning || dwSize > IO_ASYNC_BUFFER_SIZE)
+    {
         return 1;
     }
 
-    libusb_set_option(ctx, LIBUSB_OPTION_LOG_LEVEL, 3);
+    IoTransfer* ioTransfer = NULL;
 
-    int ret = libusb_claim_interface(handle, 0);
+    pthread_mutex_lock(&device->asyncLock);
+    while (!ioTransfer)
+    {
+        for (uint32_t i = 0; i < device->asyncPoolSize && !ioTransfer; ++i)
+        {
+            if (device->asyncPool[i].state == TRANSFER_FREE)
+            {
+                ioTransfer = &device->asyncPool[i];
+            }
+        }
+        if (!ioTransfer)
+        {
+            pthread_cond_wait(&device->asyncCond, &device->asyncLock);
+        }
+    }
+    ioTransfer->state = TRANSFER_PENDING;
+    ioTransfer->detached = transfer == NULL;
+    ioTransfer->callback = callback;
+    ioTransfer->userData = userData;
+    ++device->asyncInFlight;
+    pthread_mutex_unlock(&device->asyncLock);
 
-    if (ret < 0) {
-        fprintf(stderr, "usb_claim_interface error %d\n", ret);
+    if (buffer)
+    {
+        memcpy(ioTransfer->buffer, buffer, dwSize);
+    }
+
+    libusb_fill_bulk_transfer(ioTransfer->transfer, device->handle, endpoint, ioTransfer->buffer, dwSize, transferComplete, ioTransfer, USB_TIMEOUT);
+
+    int ret = libusb_submit_transfer(ioTransfer->transfer);
+    if (ret)
+    {
+        printTransferError(buffer ? "write" : "read", ret);
+
+        pthread_mutex_lock(&device->asyncLock);
+        ioTransfer->state = TRANSFER_FREE;
+        --device->asyncInFlight;
+        pthread_cond_broadcast(&device->asyncCond);
+        pthread_mutex_unlock(&device->asyncLock);
+        return 1;
+    }
+
+    if (transfer)
+    {
+        *transfer = ioTransfer;
+    }
+    return 0;
+}
+
+uint32_t ioDeviceSubmitWrite(IoDevice* device, const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+    return submitTransfer(device, 0x01, buffer, dwSize, callback, userData, transfer);
+}
+
+uint32_t ioDeviceSubmitRead(IoDevice* device, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+    // a read can't end inside a packet
+    uint32_t length = (dwSize + device->maxPacketSize - 1) / device->maxPacketSize * device->maxPacketSize;
+
+    return submitTransfer(device, USB_ENDPOINT_IN, NULL, length, callback, userData, transfer);
+}
+
+uint32_t ioWait(IoTransfer* transfer, char* buffer, uint32_t dwSize, uint32_t* bytesTransferred)
+{
+    IoDevice* device = transfer->device;
+
+    pthread_mutex_lock(&device->asyncLock);
+    while (transfer->state == TRANSFER_PENDING)
+    {
+        pthread_cond_wait(&device->asyncCond, &device->asyncLock);
+    }
+
+    uint32_t status = transfer->status;
+    uint32_t length = transfer->length < dwSize ? transfer->length : dwSize;
+
+    if (buffer)
+    {
+        memcpy(buffer, transfer->buffer, length);
+    }
+    if (bytesTransferred)
+    {
+        *bytesTransferred = length;
+    }
+
+    transfer->state = TRANSFER_FREE;
+    pthread_cond_broadcast(&device->asyncCond);
+    pthread_mutex_unlock(&device->asyncLock);
+
+    return status;
+}
+
+uint32_t ioDeviceFlush(IoDevice* device)
+{
+    waitForAsync(device);
+
+    pthread_mutex_lock(&device->asyncLock);
+    uint32_t status = device->asyncError;
+    device->asyncError = 0;
+    pthread_mutex_unlock(&device->asyncLock);
+
+    return status;
+}
+
+static void freeAsyncPool(IoDevice* device)
+{
+    for (uint32_t i = 0; i < device->asyncPoolSize; ++i)
+    {
+        libusb_free_transfer(device->asyncPool[i].transfer);
+    }
+    free(device->asyncPool);
+    device->asyncPool = NULL;
+    device->asyncPoolSize = 0;
+}
+
+uint32_t ioDeviceStartAsync(IoDevice* device, uint32_t numTransfers)
+{
+    if (device->asyncRunning)
+    {
+        return 0;
+    }
+    if (!device->handle || numTransfers == 0)
+    {
+        return 1;
+    }
+
+    device->asyncPool = (IoTransfer*)calloc(numTransfers, sizeof(IoTransfer));
+    if (!device->asyncPool)
+    {
+        return 1;
+    }
+
+    for (device->asyncPoolSize = 0; device->asyncPoolSize < numTransfers; ++device->asyncPoolSize)
+    {
+        IoTransfer* ioTransfer = &device->asyncPool[device->asyncPoolSize];
+
+        ioTransfer->device = device;
+        ioTransfer->transfer = libusb_alloc_transfer(0);
+        if (!ioTransfer->transfer)
+        {
+            freeAsyncPool(device);
+            return 1;
+        }
+    }
+
+    device->asyncInFlight = 0;
+    device->asyncError = 0;
+    device->asyncRunning = 1;
+
+    if (DLPC_COMMON_CreateThread(handleEvents, device, &device->asyncThread))
+    {
+        device->asyncRunning = 0;
+        freeAsyncPool(device);
+        return 1;
+    }
+    return 0;
+}
+
+void ioDeviceStopAsync(IoDevice* device)
+{
+    if (!device->asyncRunning)
+    {
+        return;
+    }
+
+    ioDeviceFlush(device);
+
+    device->asyncRunning = 0;
+    DLPC_COMMON_JoinThread(&device->asyncThread);
+    freeAsyncPool(device);
+}
+
+static int LIBUSB_CALL hotplugEvent(libusb_context* context, libusb_device* usbDevice, libusb_hotplug_event event, void* userData)
+{
+    IoDevice* device = (IoDevice*)userData;
+    char portPath[IO_MAX_PORT_PATH];
+
+    // with several projectors attached, only the one on this device's port is of interest
+    getPortPath(usbDevice, portPath);
+    if (device->portPath[0] != '\0' && strcmp(device->portPath, portPath) != 0)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&device->hotplugLock);
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT && !device->deviceLeftTime)
+    {
+        device->deviceLeftTime = DLPC_COMMON_GetTimeInMicroseconds();
+    }
+    else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED && device->deviceLeftTime && !device->arrivedDevice)
+    {
+        // the device is opened by ioDeviceReconnect, not from within the callback
+        device->deviceArrivedTime = DLPC_COMMON_GetTimeInMicroseconds();
+        device->arrivedDevice = libusb_ref_device(usbDevice);
+    }
+    pthread_mutex_unlock(&device->hotplugLock);
+
+    return 0;
+}
+
+uint32_t ioDeviceArmReconnect(IoDevice* device)
+{
+    if (!ctx || !libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    {
         return 1;
     }
 
-    printf("Device connected\n");
+    if (!device->hotplugRegistered)
+    {
+        int ret = libusb_hotplug_register_callback(ctx,
+            LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+            LIBUSB_HOTPLUG_NO_FLAGS,
+            VID_DEVICE,
+            PID_DEVICE,
+            LIBUSB_HOTPLUG_MATCH_ANY,
+            hotplugEvent,
+            device,
+            &device->hotplugHandle);
+
+        if (ret)
+        {
+            return 1;
+        }
+        device->hotplugRegistered = 1;
+    }
+
+    pthread_mutex_lock(&device->hotplugLock);
+    if (device->arrivedDevice)
+    {
+        libusb_unref_device(device->arrivedDevice);
+        device->arrivedDevice = NULL;
+    }
+    device->deviceLeftTime = 0;
+    device->deviceArrivedTime = 0;
+    device->reconnectArmTime = DLPC_COMMON_GetTimeInMicroseconds();
+    pthread_mutex_unlock(&device->hotplugLock);
 
     return 0;
 }
 
+uint32_t ioDeviceReconnect(IoDevice* device, uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs)
+{
+    uint64_t deadline = device->reconnectArmTime + (uint64_t)timeoutMs * 1000;
+    libusb_device* usbDevice = NULL;
+
+    // the queued transfers belong to the handle that is going away
+    ioDeviceStopAsync(device);
+
+    while (!usbDevice && DLPC_COMMON_GetTimeInMicroseconds() < deadline)
+    {
+        struct timeval timeout = { 0, RECONNECT_POLL_MS * 1000 };
+        libusb_handle_events_timeout_completed(ctx, &timeout, NULL);
+
+        pthread_mutex_lock(&device->hotplugLock);
+        usbDevice = device->arrivedDevice;
+        device->arrivedDevice = NULL;
+        pthread_mutex_unlock(&device->hotplugLock);
+    }
+
+    if (!usbDevice)
+    {
+        return 1;
+    }
+
+    ioDeviceDisconnect(device);
+
+    // the device node can take a moment to become accessible after it is announced
+    int ret = libusb_open(usbDevice, &device->handle);
+    while (ret == LIBUSB_ERROR_ACCESS && DLPC_COMMON_GetTimeInMicroseconds() < deadline)
+    {
+        DLPC_COMMON_SleepMilliseconds(RECONNECT_POLL_MS);
+        ret = libusb_open(usbDevice, &device->handle);
+    }
+    libusb_unref_device(usbDevice);
+
+    if (ret)
+    {
+        printf("ERROR: Could not reopen device: %d\n", ret);
+        device->handle = NULL;
+        return 1;
+    }
+
+    if (leftMs)
+    {
+        *leftMs = (uint32_t)((device->deviceLeftTime - device->reconnectArmTime) / 1000);
+    }
+    if (arrivedMs)
+    {
+        *arrivedMs = (uint32_t)((device->deviceArrivedTime - device->reconnectArmTime) / 1000);
+    }
+
+    return claimDevice(device);
+}
+
+uint32_t ioInit()
+{
+    return ioDeviceConnect(&defaultDevice);
+}
+
+uint32_t ioRead(char* buffer, uint32_t dwSize)
+{
+    return ioDeviceRead(&defaultDevice, buffer, dwSize);
+}
+
+uint32_t ioWrite(char* buffer, uint32_t dwSize)
+{
+    return ioDeviceWrite(&defaultDevice, buffer, dwSize);
+}
+
 void disconnectDevice()
 {
-    libusb_release_interface(handle, 0);
-    libusb_close(handle);
+    ioDeviceDisconnect(&defaultDevice);
+}
+
+uint32_t ioArmReconnect()
+{
+    return ioDeviceArmReconnect(&defaultDevice);
+}
+
+uint32_t ioReconnect(uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs)
+{
+    return ioDeviceReconnect(&defaultDevice, timeoutMs, leftMs, arrivedMs);
+}
+
+uint32_t ioStartAsync(uint32_t numTransfers)
+{
+    return ioDeviceStartAsync(&defaultDevice, numTransfers);
+}
+
+void ioStopAsync()
+{
+    ioDeviceStopAsync(&defaultDevice);
+}
+
+uint32_t ioSubmitWrite(const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+    return ioDeviceSubmitWrite(&defaultDevice, buffer, dwSize, callback, userData, transfer);
+}
+
+uint32_t ioSubmitRead(uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+    return ioDeviceSubmitRead(&defaultDevice, dwSize, callback, userData, transfer);
+}
+
+uint32_t ioFlush()
+{
+    return ioDeviceFlush(&defaultDevice);
 }
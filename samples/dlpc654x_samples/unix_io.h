@@ -13,7 +13,93 @@
 static const unsigned short VID_DEVICE = 0x0451;
 static const unsigned short PID_DEVICE = 0x7540;
 
-extern uint8_t variableLengthRead;
+#define IO_MAX_PORT_PATH 32
+
+/*
+ * A connected 654x. The functions without a device parameter use a default device,
+ * opened by ioInit.
+*/
+typedef struct IoDevice IoDevice;
+
+typedef struct
+{
+	uint8_t busNumber;
+	uint8_t address;
+	char    portPath[IO_MAX_PORT_PATH];  // bus-port.port..., e.g. 1-4.2, stable across resets
+	char    serialNumber[MAX_STR];       // empty if the device couldn't be opened to read it
+} IoDeviceInfo;
+
+// largest transfer the async transport can queue
+#define IO_ASYNC_BUFFER_SIZE 4096
+
+/*
+ * An asynchronous transfer. Returned by ioSubmitWrite/ioSubmitRead when the caller
+ * wants to wait on it, and given back to the pool by ioWait.
+*/
+typedef struct IoTransfer IoTransfer;
+
+/*
+ * @brief called from the event thread when a transfer completes
+ * @param status 0 on success, the libusb transfer status otherwise
+ * @param data   the data received by a read, or the data sent by a write
+*/
+typedef void (*IoCallback)(uint32_t status, const uint8_t* data, uint32_t length, void* userData);
+
+/*
+ * @brief lists the attached 654x controllers
+ * @return the number of devices written to devices
+*/
+EXPORTFUNC uint32_t ioEnumerateDevices(IoDeviceInfo* devices, uint32_t maxDevices);
+
+/*
+ * @brief opens the device with the given serial number or port path, the first one found when NULL
+ * @return the device, NULL if no matching device could be opened
+*/
+EXPORTFUNC IoDevice* ioOpenDevice(const char* serialOrPath);
+
+EXPORTFUNC void ioCloseDevice(IoDevice* device);
+
+/*
+ * @brief selects the device ioInit opens by serial number or port path, NULL for the first one found
+*/
+EXPORTFUNC uint32_t ioSelectDevice(const char* serialOrPath);
+
+EXPORTFUNC IoDevice* ioGetDefaultDevice();
+
+/*
+ * @brief gets the serial number and port path of a connected device, empty if unknown
+*/
+EXPORTFUNC const char* ioDeviceGetSerialNumber(IoDevice* device);
+
+EXPORTFUNC const char* ioDeviceGetPortPath(IoDevice* device);
+
+/*
+ * @brief (re)opens a device by its port path, or by its selector before it was first connected
+*/
+EXPORTFUNC uint32_t ioDeviceConnect(IoDevice* device);
+
+EXPORTFUNC void ioDeviceDisconnect(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceRead(IoDevice* device, char* buffer, uint32_t dwSize);
+
+EXPORTFUNC uint32_t ioDeviceWrite(IoDevice* device, char* buffer, uint32_t dwSize);
+
+/*
+ * Per-device versions of the reconnect and async functions below
+*/
+EXPORTFUNC uint32_t ioDeviceArmReconnect(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceReconnect(IoDevice* device, uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs);
+
+EXPORTFUNC uint32_t ioDeviceStartAsync(IoDevice* device, uint32_t numTransfers);
+
+EXPORTFUNC void ioDeviceStopAsync(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceSubmitWrite(IoDevice* device, const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioDeviceSubmitRead(IoDevice* device, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioDeviceFlush(IoDevice* device);
 
 EXPORTFUNC uint32_t ioInit();
 
@@ -22,3 +108,57 @@ EXPORTFUNC uint32_t ioRead(char* buffer, uint32_t dwSize);
 EXPORTFUNC uint32_t ioWrite(char* buffer, uint32_t dwSize);
 
 EXPORTFUNC void disconnectDevice();
+
+/*
+ * @brief starts watching for the device to leave the bus and re-enumerate. Call it before
+ *        the command that makes the device reset, so that neither event is missed.
+ *        Only events for the port the device is connected on are taken into account.
+ * @return 0 if hotplug events are available, 1 if the caller has to reconnect on its own
+*/
+EXPORTFUNC uint32_t ioArmReconnect();
+
+/*
+ * @brief waits for the device to re-enumerate after ioArmReconnect and reopens it as soon as it does
+ * @param leftMs    receives the time from ioArmReconnect until the device left the bus
+ * @param arrivedMs receives the time from ioArmReconnect until the device came back
+ * @return 0 once the device is reopened, 1 if it didn't come back within timeoutMs
+*/
+EXPORTFUNC uint32_t ioReconnect(uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs);
+
+/*
+ * @brief preallocates a pool of transfers and starts the thread handling their completion.
+ *        Does nothing if the async transport is already running.
+ * @return 0 on success, 1 if there is no device or the thread couldn't be started
+*/
+EXPORTFUNC uint32_t ioStartAsync(uint32_t numTransfers);
+
+/*
+ * @brief waits for the queued transfers and stops the event thread. Called by disconnectDevice.
+*/
+EXPORTFUNC void ioStopAsync();
+
+/*
+ * @brief queues a write behind the transfers already in flight, blocking while the pool is empty.
+ *        The data is copied, so the buffer can be reused as soon as this returns.
+ * @param transfer receives the transfer to pass to ioWait. When NULL, the transfer is
+ *                 returned to the pool on completion and a failure is reported by ioFlush.
+ * @return 0 if the transfer was queued
+*/
+EXPORTFUNC uint32_t ioSubmitWrite(const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+/*
+ * @brief queues a read of up to dwSize bytes, rounded up to whole packets. See ioSubmitWrite.
+*/
+EXPORTFUNC uint32_t ioSubmitRead(uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+/*
+ * @brief waits for a transfer, copies the data it read to buffer and returns it to the pool
+ * @return 0 on success, the libusb transfer status otherwise
+*/
+EXPORTFUNC uint32_t ioWait(IoTransfer* transfer, char* buffer, uint32_t dwSize, uint32_t* bytesTransferred);
+
+/*
+ * @brief waits for every queued transfer to complete
+ * @return 0 if none of the transfers queued without a waiter failed since the last flush
+*/
+EXPORTFUNC uint32_t ioFlush();
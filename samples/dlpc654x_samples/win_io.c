@@ -5,8 +5,6 @@
 PWINUSB_INTERFACE_HANDLE winUsbHandle;
 HANDLE driverHandle;
 
-uint8_t variableLengthRead;
-
 uint32_t ioRead(PVOID pBuffer, uint32_t dwSize)
 {
 	ULONG bytesRead = 0xFFFF;
@@ -46,6 +44,133 @@ uint32_t ioWrite(PVOID pBuffer, uint32_t dwSize)
     return bytesWritten;
 }
 
+uint32_t ioEnumerateDevices(IoDeviceInfo* devices, uint32_t maxDevices)
+{
+	return 0;
+}
+
+IoDevice* ioOpenDevice(const char* serialOrPath)
+{
+	return NULL;
+}
+
+void ioCloseDevice(IoDevice* device)
+{
+}
+
+uint32_t ioSelectDevice(const char* serialOrPath)
+{
+	return serialOrPath ? 1 : 0;
+}
+
+IoDevice* ioGetDefaultDevice()
+{
+	return NULL;
+}
+
+const char* ioDeviceGetSerialNumber(IoDevice* device)
+{
+	return "";
+}
+
+const char* ioDeviceGetPortPath(IoDevice* device)
+{
+	return "";
+}
+
+uint32_t ioDeviceConnect(IoDevice* device)
+{
+	return ioInit();
+}
+
+void ioDeviceDisconnect(IoDevice* device)
+{
+	disconnectDevice();
+}
+
+uint32_t ioDeviceRead(IoDevice* device, PVOID pBuffer, uint32_t dwSize)
+{
+	return ioRead(pBuffer, dwSize);
+}
+
+uint32_t ioDeviceWrite(IoDevice* device, PVOID pBuffer, uint32_t dwSize)
+{
+	return ioWrite(pBuffer, dwSize);
+}
+
+uint32_t ioDeviceArmReconnect(IoDevice* device)
+{
+	return ioArmReconnect();
+}
+
+uint32_t ioDeviceReconnect(IoDevice* device, uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs)
+{
+	return ioReconnect(timeoutMs, leftMs, arrivedMs);
+}
+
+uint32_t ioDeviceStartAsync(IoDevice* device, uint32_t numTransfers)
+{
+	return ioStartAsync(numTransfers);
+}
+
+void ioDeviceStopAsync(IoDevice* device)
+{
+}
+
+uint32_t ioDeviceSubmitWrite(IoDevice* device, const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+	return 1;
+}
+
+uint32_t ioDeviceSubmitRead(IoDevice* device, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+	return 1;
+}
+
+uint32_t ioDeviceFlush(IoDevice* device)
+{
+	return 0;
+}
+
+uint32_t ioArmReconnect()
+{
+	return 1;
+}
+
+uint32_t ioReconnect(uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs)
+{
+	return 1;
+}
+
+uint32_t ioStartAsync(uint32_t numTransfers)
+{
+	return 1;
+}
+
+void ioStopAsync()
+{
+}
+
+uint32_t ioSubmitWrite(const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+	return 1;
+}
+
+uint32_t ioSubmitRead(uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer)
+{
+	return 1;
+}
+
+uint32_t ioWait(IoTransfer* transfer, char* buffer, uint32_t dwSize, uint32_t* bytesTransferred)
+{
+	return 1;
+}
+
+uint32_t ioFlush()
+{
+	return 0;
+}
+
 uint32_t ioInit()
 {
 	LPSTR devicePath = getDevicePath(VID_DEVICE, PID_DEVICE);
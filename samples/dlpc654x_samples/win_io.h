@@ -27,7 +27,19 @@ static const GUID GUID_DLP_DEVICE = { 0xecceff35, 0x1463, 0x4ff3, {0xac, 0xd9, 0
 static const DWORD VID_DEVICE = 0x0451;
 static const DWORD PID_DEVICE = 0x7540;
 
-extern uint8_t variableLengthRead;
+#define MAX_STR 255
+#define IO_MAX_PORT_PATH 32
+
+// Device selection is libusb only. Over WinUSB the device functions act on the device opened by ioInit.
+typedef struct IoDevice IoDevice;
+
+typedef struct
+{
+	uint8_t busNumber;
+	uint8_t address;
+	char    portPath[IO_MAX_PORT_PATH];
+	char    serialNumber[MAX_STR];
+} IoDeviceInfo;
 
 // WinUSB
 EXPORTFUNC uint32_t ioInit();
@@ -38,12 +50,75 @@ EXPORTFUNC uint32_t connectDevice(LPSTR devicePath);
 
 EXPORTFUNC void disconnectDevice();
 
+EXPORTFUNC uint32_t ioEnumerateDevices(IoDeviceInfo* devices, uint32_t maxDevices);
+
+EXPORTFUNC IoDevice* ioOpenDevice(const char* serialOrPath);
+
+EXPORTFUNC void ioCloseDevice(IoDevice* device);
+
+EXPORTFUNC uint32_t ioSelectDevice(const char* serialOrPath);
+
+EXPORTFUNC IoDevice* ioGetDefaultDevice();
+
+/*
+ * @brief gets the serial number and port path of a connected device, empty if unknown
+*/
+EXPORTFUNC const char* ioDeviceGetSerialNumber(IoDevice* device);
+
+EXPORTFUNC const char* ioDeviceGetPortPath(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceConnect(IoDevice* device);
+
+EXPORTFUNC void ioDeviceDisconnect(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceRead(IoDevice* device, PVOID pBuffer, uint32_t dwSize);
+
+EXPORTFUNC uint32_t ioDeviceWrite(IoDevice* device, PVOID pBuffer, uint32_t dwSize);
+
+EXPORTFUNC uint32_t ioDeviceArmReconnect(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceReconnect(IoDevice* device, uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs);
+
+// No hotplug notification over WinUSB here; ioArmReconnect fails and callers reconnect on their own
+EXPORTFUNC uint32_t ioArmReconnect();
+
+EXPORTFUNC uint32_t ioReconnect(uint32_t timeoutMs, uint32_t* leftMs, uint32_t* arrivedMs);
+
 EXPORTFUNC BOOL initializeWinUsb(PWINUSB_INTERFACE_HANDLE winUsbHandle);
 
 EXPORTFUNC uint32_t ioRead(PVOID pBuffer, uint32_t dwSize);
 
 EXPORTFUNC uint32_t ioWrite(PVOID pBuffer, uint32_t dwSize);
 
+// Async transport, not implemented over WinUSB. ioStartAsync fails, so callers stay synchronous.
+#define IO_ASYNC_BUFFER_SIZE 4096
+
+typedef struct IoTransfer IoTransfer;
+
+typedef void (*IoCallback)(uint32_t status, const uint8_t* data, uint32_t length, void* userData);
+
+EXPORTFUNC uint32_t ioStartAsync(uint32_t numTransfers);
+
+EXPORTFUNC void ioStopAsync();
+
+EXPORTFUNC uint32_t ioSubmitWrite(const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioSubmitRead(uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioWait(IoTransfer* transfer, char* buffer, uint32_t dwSize, uint32_t* bytesTransferred);
+
+EXPORTFUNC uint32_t ioFlush();
+
+EXPORTFUNC uint32_t ioDeviceStartAsync(IoDevice* device, uint32_t numTransfers);
+
+EXPORTFUNC void ioDeviceStopAsync(IoDevice* device);
+
+EXPORTFUNC uint32_t ioDeviceSubmitWrite(IoDevice* device, const char* buffer, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioDeviceSubmitRead(IoDevice* device, uint32_t dwSize, IoCallback callback, void* userData, IoTransfer** transfer);
+
+EXPORTFUNC uint32_t ioDeviceFlush(IoDevice* device);
+
 EXPORTFUNC void parseDevicePath(const char* pStr, uint32_t* vid, uint32_t* pid, uint32_t* mi);
 
 EXPORTFUNC LPSTR getDevicePath(DWORD vid, DWORD pid);
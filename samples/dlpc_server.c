@@ -0,0 +1,668 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Server that shares one controller between several processes. It
+ *         owns the transport to the controller and serves the commands of
+ *         its clients (see socket_transport.h) over a Unix domain socket.
+ *
+ * Usage: dlpc_server [-s <socket path>] [-t cypress|linux|loopback] [-a <address>]
+ *
+ * The address is passed to the transport, e.g. a bridge serial number or
+ * "/dev/i2c-1@0x1B". The loopback transport emulates a controller in
+ * software, for testing clients without hardware.
+ *
+ * Queued requests are served highest priority first, in arrival order
+ * within a priority. A read that is identical to one already queued is not
+ * sent again; both clients get the response of the first. Flash reads are
+ * never shared, as each one advances the flash read address.
+ */
+
+#include "dlpc_common.h"
+#include "dlpc_common_transport.h"
+#include "cypress_i2c.h"
+#include "linux_i2c.h"
+#include "loopback_transport.h"
+#include "socket_transport.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS      32
+#define NO_CLIENT        (-1)
+
+/* Flash reads, each advances the flash read address of the controller */
+#define OPCODE_READ_FLASH_START       0xE3
+#define OPCODE_READ_FLASH_CONTINUE    0xE4
+
+typedef struct
+{
+    int                    Fd;
+
+    /** The request being received or queued */
+    SOCKET_RequestHeader_s Header;
+    uint8_t                Data[SOCKET_MAX_TRANSFER_SIZE];
+    uint32_t               ReceivedLength;
+
+    /** The request is complete and waits to be served */
+    bool                   Queued;
+    uint64_t               Sequence;
+    uint8_t                Priority;
+
+    /** The client whose identical read answers this one, NO_CLIENT if none */
+    int32_t                Leader;
+} Client_s;
+
+typedef struct
+{
+    uint64_t Requests[SOCKET_NUM_PRIORITIES];
+    uint64_t CoalescedReads;
+    uint64_t Errors;
+    uint32_t MaxQueued;
+} Statistics_s;
+
+static Client_s                     s_Clients[MAX_CLIENTS];
+static int32_t                      s_LeaseOwner = NO_CLIENT;
+static uint64_t                     s_NextSequence;
+static Statistics_s                 s_Statistics;
+static volatile sig_atomic_t        s_Stop;
+
+static DLPC_COMMON_Transport_s      s_Transport;
+static DLPC_COMMON_CommandContext_s s_CommandContext;
+static LINUX_I2C_Device_s           s_LinuxI2CDevice;
+static LOOPBACK_Device_s            s_LoopbackDevice;
+static uint8_t                      s_WriteBuffer[SOCKET_MAX_TRANSFER_SIZE];
+static uint8_t                      s_ReadBuffer[SOCKET_MAX_TRANSFER_SIZE];
+static bool                         s_BusHeld;
+
+static void HandleSignal(int Signal)
+{
+    s_Stop = 1;
+}
+
+static uint32_t AcquireI2CBus(void* UserData)
+{
+    return CYPRESS_I2C_AcquireBus(CYPRESS_I2C_BUS_ACCESS_TIMEOUT_MS) ? 0 : ERR_TRANSPORT_IO;
+}
+
+static void ReleaseI2CBus(void* UserData)
+{
+    CYPRESS_I2C_ReleaseBus();
+}
+
+static bool OpenTransport(const char* Type, const char* Address)
+{
+    if (strcmp(Type, "cypress") == 0)
+    {
+        DLPC_COMMON_InitTransport(&s_Transport, &CYPRESS_I2C_TransportOps, NULL);
+    }
+    else if (strcmp(Type, "linux") == 0)
+    {
+        DLPC_COMMON_InitTransport(&s_Transport, &LINUX_I2C_TransportOps, &s_LinuxI2CDevice);
+    }
+    else if (strcmp(Type, "loopback") == 0)
+    {
+        LOOPBACK_Reset(&s_LoopbackDevice);
+        DLPC_COMMON_InitTransport(&s_Transport, &LOOPBACK_TransportOps, &s_LoopbackDevice);
+    }
+    else
+    {
+        printf("Unknown transport %s\n", Type);
+        return false;
+    }
+
+    DLPC_COMMON_InitTransportContext(&s_CommandContext,
+                                     &s_Transport,
+                                     s_WriteBuffer,
+                                     sizeof(s_WriteBuffer),
+                                     s_ReadBuffer,
+                                     sizeof(s_ReadBuffer));
+    DLPC_COMMON_SetCommandContext(&s_CommandContext);
+
+    if (DLPC_COMMON_OpenTransport(&s_Transport, Address) != 0)
+    {
+        printf("Could not open the %s transport\n", s_Transport.Ops->Name);
+        return false;
+    }
+
+    if (s_Transport.Ops == &CYPRESS_I2C_TransportOps)
+    {
+        DLPC_COMMON_SetBusCallbacks(&s_CommandContext, AcquireI2CBus, ReleaseI2CBus);
+    }
+
+    return true;
+}
+
+static int OpenListener(const char* Path)
+{
+    struct sockaddr_un Address;
+    int                Fd;
+
+    if (strlen(Path) >= sizeof(Address.sun_path))
+    {
+        printf("Socket path %s is too long\n", Path);
+        return -1;
+    }
+
+    memset(&Address, 0, sizeof(Address));
+    Address.sun_family = AF_UNIX;
+    strcpy(Address.sun_path, Path);
+
+    Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Fd < 0)
+    {
+        printf("Could not create a socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    /* Remove the socket left by a server that did not exit cleanly */
+    unlink(Path);
+
+    if ((bind(Fd, (struct sockaddr*)&Address, sizeof(Address)) < 0) || (listen(Fd, MAX_CLIENTS) < 0))
+    {
+        printf("Could not listen on %s: %s\n", Path, strerror(errno));
+        close(Fd);
+        return -1;
+    }
+
+    return Fd;
+}
+
+static void AcceptClient(int ListenFd)
+{
+    int32_t Index;
+    int     Fd = accept(ListenFd, NULL, NULL);
+
+    if (Fd < 0)
+    {
+        return;
+    }
+
+    for (Index = 0; Index < MAX_CLIENTS; Index++)
+    {
+        if (s_Clients[Index].Fd < 0)
+        {
+            memset(&s_Clients[Index], 0, sizeof(s_Clients[Index]));
+            s_Clients[Index].Fd     = Fd;
+            s_Clients[Index].Leader = NO_CLIENT;
+            return;
+        }
+    }
+
+    printf("Too many clients, rejecting a connection\n");
+    close(Fd);
+}
+
+static void DropClient(int32_t Index)
+{
+    int32_t NewLeader = NO_CLIENT;
+    int32_t Other;
+
+    close(s_Clients[Index].Fd);
+    s_Clients[Index].Fd     = -1;
+    s_Clients[Index].Queued = false;
+
+    if (s_LeaseOwner == Index)
+    {
+        s_LeaseOwner = NO_CLIENT;
+    }
+
+    /* The first client waiting on the read of this one sends it instead */
+    for (Other = 0; Other < MAX_CLIENTS; Other++)
+    {
+        if (s_Clients[Other].Queued && (s_Clients[Other].Leader == Index))
+        {
+            if (NewLeader == NO_CLIENT)
+            {
+                NewLeader = Other;
+                s_Clients[Other].Leader = NO_CLIENT;
+            }
+            else
+            {
+                s_Clients[Other].Leader = NewLeader;
+            }
+        }
+    }
+}
+
+/*
+ * Attaches a read to an identical queued read, so it is only sent once. While
+ * a client holds a bus session only its reads are served, so only those can
+ * lead; a read of the lease owner waiting on another client would never be
+ * sent.
+ */
+static void CoalesceRead(int32_t Index)
+{
+    Client_s* Client = &s_Clients[Index];
+    Client_s* Other;
+    int32_t   OtherIndex;
+
+    if ((Client->Header.WriteLength > 0) &&
+        ((Client->Data[0] == OPCODE_READ_FLASH_START) || (Client->Data[0] == OPCODE_READ_FLASH_CONTINUE)))
+    {
+        return;
+    }
+
+    for (OtherIndex = 0; OtherIndex < MAX_CLIENTS; OtherIndex++)
+    {
+        Other = &s_Clients[OtherIndex];
+
+        if ((OtherIndex == Index) || !Other->Queued || (Other->Leader != NO_CLIENT) ||
+            ((s_LeaseOwner != NO_CLIENT) && (s_LeaseOwner != OtherIndex)) ||
+            (Other->Header.Type != SOCKET_REQUEST_WRITE_READ) ||
+            (Other->Header.WriteLength != Client->Header.WriteLength) ||
+            (Other->Header.ReadLength != Client->Header.ReadLength) ||
+            (memcmp(Other->Data, Client->Data, Client->Header.WriteLength) != 0))
+        {
+            continue;
+        }
+
+        Client->Leader = OtherIndex;
+        if (Client->Priority < Other->Priority)
+        {
+            Other->Priority = Client->Priority;
+        }
+
+        s_Statistics.CoalescedReads++;
+        return;
+    }
+}
+
+static void QueueRequest(int32_t Index)
+{
+    Client_s* Client = &s_Clients[Index];
+    uint32_t  NumQueued = 0;
+    int32_t   Other;
+
+    Client->Queued   = true;
+    Client->Sequence = s_NextSequence++;
+    Client->Priority = Client->Header.Priority;
+    Client->Leader   = NO_CLIENT;
+
+    if (Client->Priority == SOCKET_PRIORITY_DEFAULT)
+    {
+        Client->Priority = SOCKET_PRIORITY_NORMAL;
+    }
+
+    s_Statistics.Requests[Client->Priority]++;
+
+    if (Client->Header.Type == SOCKET_REQUEST_WRITE_READ)
+    {
+        CoalesceRead(Index);
+    }
+
+    for (Other = 0; Other < MAX_CLIENTS; Other++)
+    {
+        NumQueued += s_Clients[Other].Queued ? 1 : 0;
+    }
+    if (NumQueued > s_Statistics.MaxQueued)
+    {
+        s_Statistics.MaxQueued = NumQueued;
+    }
+}
+
+/* Receives what is available of the request of a client */
+static void ReceiveRequest(int32_t Index)
+{
+    Client_s* Client = &s_Clients[Index];
+    uint8_t*  Target;
+    uint32_t  Remaining;
+    ssize_t   Received;
+
+    if (Client->ReceivedLength < sizeof(Client->Header))
+    {
+        Target    = (uint8_t*)&Client->Header + Client->ReceivedLength;
+        Remaining = sizeof(Client->Header) - Client->ReceivedLength;
+    }
+    else
+    {
+        Target    = Client->Data + (Client->ReceivedLength - sizeof(Client->Header));
+        Remaining = sizeof(Client->Header) + Client->Header.WriteLength - Client->ReceivedLength;
+    }
+
+    Received = recv(Client->Fd, Target, Remaining, 0);
+    if (Received <= 0)
+    {
+        if ((Received < 0) && (errno == EINTR))
+        {
+            return;
+        }
+        DropClient(Index);
+        return;
+    }
+
+    Client->ReceivedLength += (uint32_t)Received;
+
+    if (Client->ReceivedLength == sizeof(Client->Header))
+    {
+        if ((Client->Header.Type < SOCKET_REQUEST_WRITE) || (Client->Header.Type > SOCKET_REQUEST_RELEASE_BUS) ||
+            (Client->Header.Priority >= SOCKET_NUM_PRIORITIES) ||
+            (Client->Header.WriteLength > SOCKET_MAX_TRANSFER_SIZE) ||
+            (Client->Header.ReadLength > SOCKET_MAX_TRANSFER_SIZE))
+        {
+            printf("Invalid request from client %d\n", Index);
+            DropClient(Index);
+            return;
+        }
+    }
+
+    if ((Client->ReceivedLength >= sizeof(Client->Header)) &&
+        (Client->ReceivedLength == sizeof(Client->Header) + Client->Header.WriteLength))
+    {
+        Client->ReceivedLength = 0;
+        QueueRequest(Index);
+    }
+}
+
+/*
+ * Selects the next request to serve: the highest priority, then the oldest.
+ * While a client holds a bus session only its requests are served.
+ */
+static int32_t SelectRequest()
+{
+    int32_t   Selected = NO_CLIENT;
+    int32_t   Index;
+    Client_s* Client;
+
+    for (Index = 0; Index < MAX_CLIENTS; Index++)
+    {
+        Client = &s_Clients[Index];
+
+        if (!Client->Queued || (Client->Leader != NO_CLIENT))
+        {
+            continue;
+        }
+
+        if ((s_LeaseOwner != NO_CLIENT) && (s_LeaseOwner != Index))
+        {
+            continue;
+        }
+
+        if ((Selected == NO_CLIENT) ||
+            (Client->Priority < s_Clients[Selected].Priority) ||
+            ((Client->Priority == s_Clients[Selected].Priority) && (Client->Sequence < s_Clients[Selected].Sequence)))
+        {
+            Selected = Index;
+        }
+    }
+
+    return Selected;
+}
+
+static uint32_t ExecuteRequest(Client_s* Client, uint16_t* BytesRead)
+{
+    DLPC_COMMON_CommandProtocolData_s ProtocolData;
+    uint32_t                          Status;
+
+    memset(&ProtocolData, 0, sizeof(ProtocolData));
+    *BytesRead = 0;
+
+    if (Client->Header.Type == SOCKET_REQUEST_RELEASE_BUS)
+    {
+        if (s_LeaseOwner == (int32_t)(Client - s_Clients))
+        {
+            s_LeaseOwner = NO_CLIENT;
+        }
+        return 0;
+    }
+
+    if (!s_BusHeld)
+    {
+        Status = DLPC_COMMON_AcquireBus();
+        if (Status != 0)
+        {
+            return Status;
+        }
+        s_BusHeld = true;
+    }
+
+    switch (Client->Header.Type)
+    {
+        case SOCKET_REQUEST_WRITE:
+            return DLPC_COMMON_TransportWriteCommand(Client->Header.WriteLength, Client->Data, &ProtocolData);
+
+        case SOCKET_REQUEST_WRITE_READ:
+            Status = DLPC_COMMON_TransportReadCommand(Client->Header.WriteLength,
+                                                      Client->Data,
+                                                      Client->Header.ReadLength,
+                                                      s_ReadBuffer,
+                                                      &ProtocolData);
+            if (Status == 0)
+            {
+                *BytesRead = ProtocolData.BytesRead;
+            }
+            return Status;
+
+        default:
+            s_LeaseOwner = (int32_t)(Client - s_Clients);
+            return 0;
+    }
+}
+
+/* Serves a request and answers it and the reads coalesced with it */
+static void ServeRequest(int32_t Index)
+{
+    SOCKET_ResponseHeader_s Response;
+    bool                    Answer[MAX_CLIENTS];
+    uint16_t                BytesRead;
+    uint32_t                Status;
+    int32_t                 Other;
+
+    Status = ExecuteRequest(&s_Clients[Index], &BytesRead);
+    if (Status != 0)
+    {
+        s_Statistics.Errors++;
+    }
+
+    for (Other = 0; Other < MAX_CLIENTS; Other++)
+    {
+        Answer[Other] = s_Clients[Other].Queued && ((Other == Index) || (s_Clients[Other].Leader == Index));
+        if (Answer[Other])
+        {
+            s_Clients[Other].Queued = false;
+            s_Clients[Other].Leader = NO_CLIENT;
+        }
+    }
+
+    for (Other = 0; Other < MAX_CLIENTS; Other++)
+    {
+        if (!Answer[Other])
+        {
+            continue;
+        }
+
+        memset(&Response, 0, sizeof(Response));
+        Response.RequestId = s_Clients[Other].Header.RequestId;
+        Response.Status    = Status;
+        Response.BytesRead = BytesRead;
+
+        if (!SOCKET_SendAll(s_Clients[Other].Fd, &Response, sizeof(Response)) ||
+            !SOCKET_SendAll(s_Clients[Other].Fd, s_ReadBuffer, BytesRead))
+        {
+            DropClient(Other);
+        }
+    }
+}
+
+static void PrintStatistics()
+{
+    printf("Requests: %llu high, %llu normal, %llu low priority\n",
+           (unsigned long long)s_Statistics.Requests[SOCKET_PRIORITY_HIGH],
+           (unsigned long long)s_Statistics.Requests[SOCKET_PRIORITY_NORMAL],
+           (unsigned long long)s_Statistics.Requests[SOCKET_PRIORITY_LOW]);
+    printf("Requests: %llu coalesced reads, %llu errors, at most %u queued\n",
+           (unsigned long long)s_Statistics.CoalescedReads,
+           (unsigned long long)s_Statistics.Errors,
+           s_Statistics.MaxQueued);
+}
+
+int main(int argc, char** argv)
+{
+    const char*      SocketPath    = SOCKET_DEFAULT_PATH;
+    const char*      TransportType = "cypress";
+    const char*      Address       = NULL;
+    struct pollfd    PollFds[MAX_CLIENTS + 1];
+    struct sigaction Action;
+    int              ListenFd;
+    int32_t          Index;
+    int32_t          Next;
+    int              Arg;
+
+    for (Arg = 1; Arg + 1 < argc; Arg += 2)
+    {
+        if (strcmp(argv[Arg], "-s") == 0)
+        {
+            SocketPath = argv[Arg + 1];
+        }
+        else if (strcmp(argv[Arg], "-t") == 0)
+        {
+            TransportType = argv[Arg + 1];
+        }
+        else if (strcmp(argv[Arg], "-a") == 0)
+        {
+            Address = argv[Arg + 1];
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (Arg < argc)
+    {
+        printf("Usage: %s [-s <socket path>] [-t cypress|linux|loopback] [-a <address>]\n", argv[0]);
+        return 1;
+    }
+
+    if (!OpenTransport(TransportType, Address))
+    {
+        return 1;
+    }
+
+    ListenFd = OpenListener(SocketPath);
+    if (ListenFd < 0)
+    {
+        DLPC_COMMON_CloseTransport(&s_Transport);
+        return 1;
+    }
+
+    for (Index = 0; Index < MAX_CLIENTS; Index++)
+    {
+        s_Clients[Index].Fd = -1;
+    }
+
+    /* Without SA_RESTART, so that a signal interrupts poll */
+    memset(&Action, 0, sizeof(Action));
+    Action.sa_handler = HandleSignal;
+    sigaction(SIGINT, &Action, NULL);
+    sigaction(SIGTERM, &Action, NULL);
+
+    printf("Serving the %s transport on %s\n", s_Transport.Ops->Name, SocketPath);
+
+    while (!s_Stop)
+    {
+        Next = SelectRequest();
+
+        /* Keep the controller bus while there is work or a client session */
+        if ((Next == NO_CLIENT) && (s_LeaseOwner == NO_CLIENT) && s_BusHeld)
+        {
+            DLPC_COMMON_ReleaseBus();
+            s_BusHeld = false;
+        }
+
+        PollFds[0].fd     = ListenFd;
+        PollFds[0].events = POLLIN;
+        for (Index = 0; Index < MAX_CLIENTS; Index++)
+        {
+            /* One request per client at a time keeps the commands of a client in order */
+            PollFds[Index + 1].fd     = s_Clients[Index].Queued ? -1 : s_Clients[Index].Fd;
+            PollFds[Index + 1].events = POLLIN;
+        }
+
+        /* With requests queued, only look for new ones that may take precedence */
+        if (poll(PollFds, MAX_CLIENTS + 1, (Next == NO_CLIENT) ? -1 : 0) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            printf("poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        if (PollFds[0].revents & POLLIN)
+        {
+            AcceptClient(ListenFd);
+        }
+
+        for (Index = 0; Index < MAX_CLIENTS; Index++)
+        {
+            if ((PollFds[Index + 1].fd >= 0) && (PollFds[Index + 1].revents != 0))
+            {
+                ReceiveRequest(Index);
+            }
+        }
+
+        Next = SelectRequest();
+        if (Next != NO_CLIENT)
+        {
+            ServeRequest(Next);
+        }
+    }
+
+    for (Index = 0; Index < MAX_CLIENTS; Index++)
+    {
+        if (s_Clients[Index].Fd >= 0)
+        {
+            DropClient(Index);
+        }
+    }
+
+    if (s_BusHeld)
+    {
+        DLPC_COMMON_ReleaseBus();
+    }
+
+    close(ListenFd);
+    unlink(SocketPath);
+    DLPC_COMMON_CloseTransport(&s_Transport);
+    PrintStatistics();
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the i2c-dev transport.
+ */
+
+#include "linux_i2c.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#define MAX_BUS_NUMBER 16
+
+static LINUX_I2C_Device_s* GetDevice(DLPC_COMMON_Transport_s* Transport)
+{
+    return (LINUX_I2C_Device_s*)Transport->Data;
+}
+
+/* Splits "<path>[@<address>]" into the device path and slave address */
+static bool ParseAddress(const char* Address, LINUX_I2C_Device_s* Device)
+{
+    const char* Separator = strchr(Address, '@');
+    size_t      PathLength = (Separator != NULL) ? (size_t)(Separator - Address) : strlen(Address);
+    char*       End;
+    long        SlaveAddress;
+
+    if ((PathLength == 0) || (PathLength >= sizeof(Device->Path)))
+    {
+        return false;
+    }
+
+    memcpy(Device->Path, Address, PathLength);
+    Device->Path[PathLength] = '\0';
+    Device->SlaveAddress     = LINUX_I2C_DEFAULT_SLAVE_ADDRESS;
+
+    if (Separator != NULL)
+    {
+        SlaveAddress = strtol(Separator + 1, &End, 0);
+        if ((*End != '\0') || (SlaveAddress < 0x03) || (SlaveAddress > 0x77))
+        {
+            return false;
+        }
+        Device->SlaveAddress = (uint16_t)SlaveAddress;
+    }
+
+    return true;
+}
+
+static bool FindFirstBus(LINUX_I2C_Device_s* Device)
+{
+    uint32_t Bus;
+
+    for (Bus = 0; Bus < MAX_BUS_NUMBER; Bus++)
+    {
+        snprintf(Device->Path, sizeof(Device->Path), "/dev/i2c-%u", Bus);
+        if (access(Device->Path, R_OK | W_OK) == 0)
+        {
+            Device->SlaveAddress = LINUX_I2C_DEFAULT_SLAVE_ADDRESS;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t Open(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+    LINUX_I2C_Device_s* Device    = GetDevice(Transport);
+    unsigned long       Functions = 0;
+
+    if ((Address != NULL) ? !ParseAddress(Address, Device) : !FindFirstBus(Device))
+    {
+        printf("Invalid or missing I2C bus %s\n", (Address != NULL) ? Address : "");
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    Device->Fd = open(Device->Path, O_RDWR);
+    if (Device->Fd < 0)
+    {
+        printf("Could not open %s: %s\n", Device->Path, strerror(errno));
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    /* Combined transactions need plain I2C support, not just SMBus */
+    if ((ioctl(Device->Fd, I2C_FUNCS, &Functions) < 0) || ((Functions & I2C_FUNC_I2C) == 0))
+    {
+        printf("%s does not support I2C_RDWR transfers\n", Device->Path);
+        close(Device->Fd);
+        Device->Fd = -1;
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    Transport->MaxTransferSize = LINUX_I2C_MAX_TRANSFER_SIZE;
+    Transport->Capabilities    = DLPC_COMMON_TRANSPORT_CAP_COMBINED_WRITE_READ;
+
+    return 0;
+}
+
+static void Close(DLPC_COMMON_Transport_s* Transport)
+{
+    LINUX_I2C_Device_s* Device = GetDevice(Transport);
+
+    if (Device->Fd >= 0)
+    {
+        close(Device->Fd);
+        Device->Fd = -1;
+    }
+}
+
+static uint32_t Transfer(LINUX_I2C_Device_s* Device, struct i2c_msg* Messages, uint32_t NumMessages)
+{
+    struct i2c_rdwr_ioctl_data Data;
+
+    Data.msgs  = Messages;
+    Data.nmsgs = NumMessages;
+
+    if (ioctl(Device->Fd, I2C_RDWR, &Data) != (int)NumMessages)
+    {
+        printf("I2C transfer to 0x%02X on %s failed: %s\n", Device->SlaveAddress, Device->Path, strerror(errno));
+
+        /* NAKs (ENXIO, EREMOTEIO), timeouts and lost arbitration (EAGAIN) may pass when repeated */
+        switch (errno)
+        {
+            case ENODEV:
+            case EBADF:
+            case EINVAL:
+            case EOPNOTSUPP:
+                return ERR_TRANSPORT_FATAL;
+
+            default:
+                return ERR_TRANSPORT_IO;
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t Write(DLPC_COMMON_Transport_s* Transport,
+                      uint16_t                 WriteLength,
+                      const uint8_t*           WriteData)
+{
+    LINUX_I2C_Device_s* Device = GetDevice(Transport);
+    struct i2c_msg      Message;
+
+    Message.addr  = Device->SlaveAddress;
+    Message.flags = 0;
+    Message.len   = WriteLength;
+    Message.buf   = (uint8_t*)WriteData;
+
+    return Transfer(Device, &Message, 1);
+}
+
+static uint32_t WriteRead(DLPC_COMMON_Transport_s* Transport,
+                          uint16_t                 WriteLength,
+                          const uint8_t*           WriteData,
+                          uint16_t                 ReadLength,
+                          uint8_t*                 ReadData,
+                          uint16_t*                BytesRead)
+{
+    LINUX_I2C_Device_s* Device = GetDevice(Transport);
+    struct i2c_msg      Messages[2];
+    uint32_t            Status;
+
+    if (ReadLength > LINUX_I2C_MAX_TRANSFER_SIZE)
+    {
+        return ERR_TRANSPORT_TOO_LONG;
+    }
+
+    Messages[0].addr  = Device->SlaveAddress;
+    Messages[0].flags = 0;
+    Messages[0].len   = WriteLength;
+    Messages[0].buf   = (uint8_t*)WriteData;
+
+    Messages[1].addr  = Device->SlaveAddress;
+    Messages[1].flags = I2C_M_RD;
+    Messages[1].len   = ReadLength;
+    Messages[1].buf   = ReadData;
+
+    Status = Transfer(Device, Messages, 2);
+    *BytesRead = (Status == 0) ? ReadLength : 0;
+
+    return Status;
+}
+
+const DLPC_COMMON_TransportOps_s LINUX_I2C_TransportOps =
+{
+    "linux-i2c",
+    Open,
+    Close,
+    Write,
+    WriteRead,
+    NULL,
+    NULL
+};
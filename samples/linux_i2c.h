@@ -0,0 +1,85 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Transport for controllers on a native Linux I2C bus, through the
+ *         i2c-dev interface (/dev/i2c-N).
+ */
+
+#ifndef LINUX_I2C_H
+#define LINUX_I2C_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "dlpc_common_transport.h"
+
+/** 7-bit address of the DLPC34xx (0x36 in 8-bit notation) */
+#define LINUX_I2C_DEFAULT_SLAVE_ADDRESS   0x1B
+
+/** i2c-dev rejects I2C_RDWR messages longer than this */
+#define LINUX_I2C_MAX_TRANSFER_SIZE       8192
+
+#define LINUX_I2C_MAX_PATH                64
+
+/**
+ * An i2c-dev bus and the address of the controller on it
+ */
+typedef struct
+{
+    int      Fd;
+    uint16_t SlaveAddress;
+    char     Path[LINUX_I2C_MAX_PATH];
+} LINUX_I2C_Device_s;
+
+/**
+ * Transport backend for i2c-dev. The transport Data is a LINUX_I2C_Device_s.
+ *
+ * The Address is the bus device, optionally followed by the 7-bit
+ * controller address, e.g. "/dev/i2c-1" or "/dev/i2c-1@0x1B". NULL selects
+ * the first /dev/i2c-N found and LINUX_I2C_DEFAULT_SLAVE_ADDRESS.
+ *
+ * Each write is one I2C_RDWR message. A write/read is a single I2C_RDWR
+ * call with two messages, so the read follows the write with a repeated
+ * start and no other master can take the bus in between.
+ */
+extern const DLPC_COMMON_TransportOps_s LINUX_I2C_TransportOps;
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* LINUX_I2C_H */
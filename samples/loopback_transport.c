@@ -0,0 +1,225 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the loopback transport.
+ */
+
+#include "loopback_transport.h"
+#include <string.h>
+
+static LOOPBACK_Device_s* GetDevice(DLPC_COMMON_Transport_s* Transport)
+{
+    return (LOOPBACK_Device_s*)Transport->Data;
+}
+
+/* Consumes one of the injected failures, if any are left */
+static bool InjectFailure(LOOPBACK_Device_s* Device)
+{
+    if (Device->FailTransfers == 0)
+    {
+        return false;
+    }
+
+    Device->FailTransfers--;
+    Device->FailedTransfers++;
+    return true;
+}
+
+void LOOPBACK_Reset(LOOPBACK_Device_s* Device)
+{
+    memset(Device->Registers, 0, sizeof(Device->Registers));
+    memset(Device->RegisterLengths, 0, sizeof(Device->RegisterLengths));
+
+    Device->NumPendingWrites = 0;
+    Device->Writes           = 0;
+    Device->WriteReads       = 0;
+    Device->SubmittedWrites  = 0;
+    Device->FailedTransfers  = 0;
+    Device->BytesWritten     = 0;
+    Device->BytesRead        = 0;
+}
+
+static uint32_t Open(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+    LOOPBACK_Device_s* Device = GetDevice(Transport);
+
+    Transport->MaxTransferSize = Device->MaxTransferSize;
+    Transport->Capabilities    = DLPC_COMMON_TRANSPORT_CAP_COMBINED_WRITE_READ;
+    if (Device->Async)
+    {
+        Transport->Capabilities |= DLPC_COMMON_TRANSPORT_CAP_ASYNC;
+    }
+
+    return 0;
+}
+
+static void Close(DLPC_COMMON_Transport_s* Transport)
+{
+}
+
+static uint32_t Write(DLPC_COMMON_Transport_s* Transport,
+                      uint16_t                 WriteLength,
+                      const uint8_t*           WriteData)
+{
+    LOOPBACK_Device_s* Device = GetDevice(Transport);
+    uint16_t           PayloadLength;
+
+    if (InjectFailure(Device))
+    {
+        return ERR_TRANSPORT_IO;
+    }
+
+    Device->Writes++;
+    Device->BytesWritten += WriteLength;
+
+    if (WriteLength > 0)
+    {
+        PayloadLength = WriteLength - 1;
+        if (PayloadLength > LOOPBACK_MAX_REGISTER_SIZE)
+        {
+            PayloadLength = LOOPBACK_MAX_REGISTER_SIZE;
+        }
+
+        memcpy(Device->Registers[WriteData[0]], &WriteData[1], PayloadLength);
+        Device->RegisterLengths[WriteData[0]] = PayloadLength;
+    }
+
+    return 0;
+}
+
+static uint32_t WriteRead(DLPC_COMMON_Transport_s* Transport,
+                          uint16_t                 WriteLength,
+                          const uint8_t*           WriteData,
+                          uint16_t                 ReadLength,
+                          uint8_t*                 ReadData,
+                          uint16_t*                BytesRead)
+{
+    LOOPBACK_Device_s* Device = GetDevice(Transport);
+    uint16_t           RegisterLength;
+    uint32_t           Status = 0;
+
+    if (InjectFailure(Device))
+    {
+        return ERR_TRANSPORT_IO;
+    }
+
+    Device->WriteReads++;
+    Device->BytesWritten += WriteLength;
+
+    if (Device->ReadHandler != NULL)
+    {
+        Status = Device->ReadHandler(Device->HandlerData, WriteLength, WriteData, ReadLength, ReadData, BytesRead);
+    }
+    else
+    {
+        memset(ReadData, 0, ReadLength);
+        if (WriteLength > 0)
+        {
+            RegisterLength = Device->RegisterLengths[WriteData[0]];
+            memcpy(ReadData, Device->Registers[WriteData[0]], (RegisterLength < ReadLength) ? RegisterLength : ReadLength);
+        }
+        *BytesRead = ReadLength;
+    }
+
+    if (Status == 0)
+    {
+        Device->BytesRead += *BytesRead;
+    }
+
+    return Status;
+}
+
+static uint32_t Flush(DLPC_COMMON_Transport_s* Transport);
+
+/* The write is applied right away; its completion is held until the next flush */
+static uint32_t SubmitWrite(DLPC_COMMON_Transport_s*        Transport,
+                            uint16_t                        WriteLength,
+                            const uint8_t*                  WriteData,
+                            DLPC_COMMON_TransportCompletion Completion,
+                            void*                           CallbackData)
+{
+    LOOPBACK_Device_s*       Device = GetDevice(Transport);
+    LOOPBACK_PendingWrite_s* Pending;
+    uint32_t                 Status;
+
+    if (Device->NumPendingWrites == LOOPBACK_MAX_PENDING_WRITES)
+    {
+        Status = Flush(Transport);
+        if (Status != 0)
+        {
+            return Status;
+        }
+    }
+
+    Device->SubmittedWrites++;
+    if (Write(Transport, WriteLength, WriteData) != 0)
+    {
+        return ERR_TRANSPORT_IO;
+    }
+
+    Pending = &Device->PendingWrites[Device->NumPendingWrites++];
+    Pending->Completion   = Completion;
+    Pending->CallbackData = CallbackData;
+
+    return 0;
+}
+
+static uint32_t Flush(DLPC_COMMON_Transport_s* Transport)
+{
+    LOOPBACK_Device_s* Device = GetDevice(Transport);
+    uint32_t           Index;
+
+    for (Index = 0; Index < Device->NumPendingWrites; Index++)
+    {
+        if (Device->PendingWrites[Index].Completion != NULL)
+        {
+            Device->PendingWrites[Index].Completion(0, Device->PendingWrites[Index].CallbackData);
+        }
+    }
+    Device->NumPendingWrites = 0;
+
+    return 0;
+}
+
+const DLPC_COMMON_TransportOps_s LOOPBACK_TransportOps =
+{
+    "loopback",
+    Open,
+    Close,
+    Write,
+    WriteRead,
+    SubmitWrite,
+    Flush
+};
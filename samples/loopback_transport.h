@@ -0,0 +1,121 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Loopback transport that emulates a controller in memory, so code
+ *         using the transport interface can be exercised without hardware.
+ */
+
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "dlpc_common_transport.h"
+
+#define LOOPBACK_NUM_OPCODES              256
+#define LOOPBACK_MAX_REGISTER_SIZE        64
+#define LOOPBACK_MAX_PENDING_WRITES       16
+
+/**
+ * Handles a write/read in place of the register emulation
+ *
+ * \return 0 if successful, error code otherwise
+ */
+typedef uint32_t (*LOOPBACK_ReadHandler)(void*          HandlerData,
+                                         uint16_t       WriteLength,
+                                         const uint8_t* WriteData,
+                                         uint16_t       ReadLength,
+                                         uint8_t*       ReadData,
+                                         uint16_t*      BytesRead);
+
+typedef struct
+{
+    DLPC_COMMON_TransportCompletion Completion;
+    void*                           CallbackData;
+} LOOPBACK_PendingWrite_s;
+
+/**
+ * The emulated controller. Every write stores its payload in the register
+ * of its opcode, and a write/read returns the register of the opcode written
+ * first, zero padded to the read length. A write/read with a payload, e.g.
+ * a read of one entry of a table, returns the same register.
+ *
+ * Set the configuration fields before opening the transport.
+ */
+typedef struct
+{
+    /** Configuration */
+    uint32_t             MaxTransferSize;   /* Reported transfer limit, 0 if unlimited */
+    bool                 Async;             /* Report the async capability */
+    uint32_t             FailTransfers;     /* Number of upcoming transfers that fail */
+    LOOPBACK_ReadHandler ReadHandler;       /* Optional, replaces the register reads */
+    void*                HandlerData;
+
+    /** Emulated registers */
+    uint8_t              Registers[LOOPBACK_NUM_OPCODES][LOOPBACK_MAX_REGISTER_SIZE];
+    uint16_t             RegisterLengths[LOOPBACK_NUM_OPCODES];
+
+    /** Completions of submitted writes, reported by the next flush */
+    LOOPBACK_PendingWrite_s PendingWrites[LOOPBACK_MAX_PENDING_WRITES];
+    uint32_t             NumPendingWrites;
+
+    /** Statistics */
+    uint32_t             Writes;
+    uint32_t             WriteReads;
+    uint32_t             SubmittedWrites;
+    uint32_t             FailedTransfers;
+    uint64_t             BytesWritten;
+    uint64_t             BytesRead;
+} LOOPBACK_Device_s;
+
+/**
+ * Transport backend for the emulated controller. The transport Data is a
+ * LOOPBACK_Device_s. The Address is ignored.
+ */
+extern const DLPC_COMMON_TransportOps_s LOOPBACK_TransportOps;
+
+/**
+ * Clears the registers and statistics, keeping the configuration
+ */
+void LOOPBACK_Reset(LOOPBACK_Device_s* Device);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* LOOPBACK_TRANSPORT_H */
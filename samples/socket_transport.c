@@ -0,0 +1,284 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Implements the dlpc_server client transport.
+ */
+
+#include "socket_transport.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static SOCKET_Client_s* GetClient(DLPC_COMMON_Transport_s* Transport)
+{
+    return (SOCKET_Client_s*)Transport->Data;
+}
+
+bool SOCKET_SendAll(int Fd, const void* Data, uint32_t Length)
+{
+    const uint8_t* Bytes = (const uint8_t*)Data;
+    ssize_t        Sent;
+
+    while (Length > 0)
+    {
+        Sent = send(Fd, Bytes, Length, MSG_NOSIGNAL);
+        if (Sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        Bytes  += Sent;
+        Length -= (uint32_t)Sent;
+    }
+
+    return true;
+}
+
+bool SOCKET_ReceiveAll(int Fd, void* Data, uint32_t Length)
+{
+    uint8_t* Bytes = (uint8_t*)Data;
+    ssize_t  Received;
+
+    while (Length > 0)
+    {
+        Received = recv(Fd, Bytes, Length, 0);
+        if (Received < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        /* Closed by the server */
+        if (Received == 0)
+        {
+            return false;
+        }
+
+        Bytes  += Received;
+        Length -= (uint32_t)Received;
+    }
+
+    return true;
+}
+
+static uint32_t Open(DLPC_COMMON_Transport_s* Transport, const char* Address)
+{
+    SOCKET_Client_s*   Client = GetClient(Transport);
+    struct sockaddr_un SocketAddress;
+    const char*        Path   = (Address != NULL) ? Address : SOCKET_DEFAULT_PATH;
+
+    if (strlen(Path) >= sizeof(SocketAddress.sun_path))
+    {
+        printf("Socket path %s is too long\n", Path);
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    memset(&SocketAddress, 0, sizeof(SocketAddress));
+    SocketAddress.sun_family = AF_UNIX;
+    strcpy(SocketAddress.sun_path, Path);
+
+    Client->Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Client->Fd < 0)
+    {
+        printf("Could not create a socket: %s\n", strerror(errno));
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    if (connect(Client->Fd, (struct sockaddr*)&SocketAddress, sizeof(SocketAddress)) < 0)
+    {
+        printf("Could not connect to %s: %s\n", Path, strerror(errno));
+        close(Client->Fd);
+        Client->Fd = -1;
+        return ERR_TRANSPORT_OPEN;
+    }
+
+    strcpy(Client->Path, Path);
+    Client->NextRequestId = 1;
+    if ((Client->Priority == SOCKET_PRIORITY_DEFAULT) || (Client->Priority >= SOCKET_NUM_PRIORITIES))
+    {
+        Client->Priority = SOCKET_PRIORITY_NORMAL;
+    }
+
+    Transport->MaxTransferSize = SOCKET_MAX_TRANSFER_SIZE;
+    Transport->Capabilities    = DLPC_COMMON_TRANSPORT_CAP_COMBINED_WRITE_READ |
+                                 DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION;
+
+    return 0;
+}
+
+static void Close(DLPC_COMMON_Transport_s* Transport)
+{
+    SOCKET_Client_s* Client = GetClient(Transport);
+
+    if (Client->Fd >= 0)
+    {
+        close(Client->Fd);
+        Client->Fd = -1;
+    }
+}
+
+/*
+ * Sends a request and waits for its response. A broken connection is fatal,
+ * errors of the server transport are passed on so that transient errors can
+ * be retried.
+ */
+static uint32_t Request(SOCKET_Client_s* Client,
+                        uint8_t          Type,
+                        uint16_t         WriteLength,
+                        const uint8_t*   WriteData,
+                        uint16_t         ReadLength,
+                        uint8_t*         ReadData,
+                        uint16_t*        BytesRead)
+{
+    SOCKET_RequestHeader_s  Header;
+    SOCKET_ResponseHeader_s Response;
+
+    if (Client->Fd < 0)
+    {
+        return ERR_TRANSPORT_NOT_OPEN;
+    }
+
+    memset(&Header, 0, sizeof(Header));
+    Header.RequestId   = Client->NextRequestId++;
+    Header.Type        = Type;
+    Header.Priority    = Client->Priority;
+    Header.WriteLength = WriteLength;
+    Header.ReadLength  = ReadLength;
+
+    if (!SOCKET_SendAll(Client->Fd, &Header, sizeof(Header)) ||
+        !SOCKET_SendAll(Client->Fd, WriteData, WriteLength) ||
+        !SOCKET_ReceiveAll(Client->Fd, &Response, sizeof(Response)))
+    {
+        printf("Lost the connection to %s\n", Client->Path);
+        return ERR_TRANSPORT_FATAL;
+    }
+
+    if ((Response.RequestId != Header.RequestId) || (Response.BytesRead > ReadLength))
+    {
+        printf("Unexpected response %u from %s\n", Response.RequestId, Client->Path);
+        return ERR_TRANSPORT_FATAL;
+    }
+
+    if (!SOCKET_ReceiveAll(Client->Fd, ReadData, Response.BytesRead))
+    {
+        printf("Lost the connection to %s\n", Client->Path);
+        return ERR_TRANSPORT_FATAL;
+    }
+
+    if (BytesRead != NULL)
+    {
+        *BytesRead = Response.BytesRead;
+    }
+
+    return Response.Status;
+}
+
+static uint32_t Write(DLPC_COMMON_Transport_s* Transport,
+                      uint16_t                 WriteLength,
+                      const uint8_t*           WriteData)
+{
+    return Request(GetClient(Transport), SOCKET_REQUEST_WRITE, WriteLength, WriteData, 0, NULL, NULL);
+}
+
+static uint32_t WriteRead(DLPC_COMMON_Transport_s* Transport,
+                          uint16_t                 WriteLength,
+                          const uint8_t*           WriteData,
+                          uint16_t                 ReadLength,
+                          uint8_t*                 ReadData,
+                          uint16_t*                BytesRead)
+{
+    if (ReadLength > SOCKET_MAX_TRANSFER_SIZE)
+    {
+        return ERR_TRANSPORT_TOO_LONG;
+    }
+
+    return Request(GetClient(Transport), SOCKET_REQUEST_WRITE_READ, WriteLength, WriteData, ReadLength, ReadData, BytesRead);
+}
+
+void SOCKET_SetPriority(DLPC_COMMON_Transport_s* Transport, SOCKET_Priority_e Priority)
+{
+    GetClient(Transport)->Priority = (uint8_t)Priority;
+}
+
+/* The default command context has no UserData, it uses the default transport */
+static DLPC_COMMON_Transport_s* GetBusTransport(void* UserData)
+{
+    return (UserData != NULL) ? (DLPC_COMMON_Transport_s*)UserData : DLPC_COMMON_GetCommandTransport();
+}
+
+uint32_t SOCKET_AcquireBus(void* UserData)
+{
+    DLPC_COMMON_Transport_s* Transport = GetBusTransport(UserData);
+
+    if (Transport == NULL)
+    {
+        return ERR_TRANSPORT_NOT_OPEN;
+    }
+
+    return Request(GetClient(Transport), SOCKET_REQUEST_ACQUIRE_BUS, 0, NULL, 0, NULL, NULL);
+}
+
+void SOCKET_ReleaseBus(void* UserData)
+{
+    DLPC_COMMON_Transport_s* Transport = GetBusTransport(UserData);
+
+    if (Transport == NULL)
+    {
+        return;
+    }
+
+    Request(GetClient(Transport), SOCKET_REQUEST_RELEASE_BUS, 0, NULL, 0, NULL, NULL);
+}
+
+const DLPC_COMMON_TransportOps_s SOCKET_TransportOps =
+{
+    "socket",
+    Open,
+    Close,
+    Write,
+    WriteRead,
+    NULL,
+    NULL
+};
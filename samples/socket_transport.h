@@ -0,0 +1,154 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Client transport for dlpc_server, which shares one controller
+ *         between several processes over a Unix domain socket.
+ *
+ * Each command is a request tagged with a request ID and a priority,
+ * answered by a response with the same ID:
+ *
+ *     Request:  SOCKET_RequestHeader_s, WriteLength bytes of command data
+ *     Response: SOCKET_ResponseHeader_s, BytesRead bytes of response data
+ *
+ * The server sends the commands of each client in order and handles one
+ * request per client at a time.
+ */
+
+#ifndef SOCKET_TRANSPORT_H
+#define SOCKET_TRANSPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "dlpc_common_transport.h"
+
+#define SOCKET_DEFAULT_PATH          "/tmp/dlpc_server.sock"
+#define SOCKET_MAX_PATH              108   /* sun_path size */
+#define SOCKET_MAX_TRANSFER_SIZE     8192
+
+/** Request types */
+#define SOCKET_REQUEST_WRITE         1
+#define SOCKET_REQUEST_WRITE_READ    2
+#define SOCKET_REQUEST_ACQUIRE_BUS   3   /* Serve only this client until released */
+#define SOCKET_REQUEST_RELEASE_BUS   4
+
+/**
+ * Request priorities. The server always sends the queued request with the
+ * highest priority next, so flash programming and sequencing are not held
+ * up behind telemetry polling. SOCKET_PRIORITY_DEFAULT is served as
+ * SOCKET_PRIORITY_NORMAL, so zero initialized clients do not jump the queue.
+ */
+typedef enum
+{
+    SOCKET_PRIORITY_DEFAULT = 0,
+    SOCKET_PRIORITY_HIGH    = 1,   /* Flash programming, sequencer */
+    SOCKET_PRIORITY_NORMAL  = 2,
+    SOCKET_PRIORITY_LOW     = 3,   /* Telemetry */
+    SOCKET_NUM_PRIORITIES   = 4
+} SOCKET_Priority_e;
+
+typedef struct
+{
+    uint32_t RequestId;
+    uint8_t  Type;
+    uint8_t  Priority;
+    uint16_t WriteLength;
+    uint16_t ReadLength;
+    uint16_t Reserved;
+} SOCKET_RequestHeader_s;
+
+typedef struct
+{
+    uint32_t RequestId;
+
+    /** 0 if successful, error code of the server transport otherwise */
+    uint32_t Status;
+    uint16_t BytesRead;
+    uint16_t Reserved;
+} SOCKET_ResponseHeader_s;
+
+/**
+ * A connection to the server
+ */
+typedef struct
+{
+    int      Fd;
+    uint32_t NextRequestId;
+
+    /** SOCKET_Priority_e of the requests sent, SOCKET_PRIORITY_NORMAL by default */
+    uint8_t  Priority;
+    char     Path[SOCKET_MAX_PATH];
+} SOCKET_Client_s;
+
+/**
+ * Transport backend for the server. The transport Data is a
+ * SOCKET_Client_s and the Address is the socket path, NULL selects
+ * SOCKET_DEFAULT_PATH.
+ *
+ * The transport has the DLPC_COMMON_TRANSPORT_CAP_BUS_ARBITRATION
+ * capability. With SOCKET_AcquireBus and SOCKET_ReleaseBus as the bus
+ * callbacks, a bus session holds off the other clients, e.g. for the
+ * duration of a flash update.
+ */
+extern const DLPC_COMMON_TransportOps_s SOCKET_TransportOps;
+
+/**
+ * Sets the priority of the requests sent through a transport
+ */
+void SOCKET_SetPriority(DLPC_COMMON_Transport_s* Transport, SOCKET_Priority_e Priority);
+
+/**
+ * Bus callbacks, see DLPC_COMMON_SetBusCallbacks. The UserData is the
+ * transport, as set up by DLPC_COMMON_InitTransportContext, or NULL to use
+ * the default transport.
+ */
+uint32_t SOCKET_AcquireBus(void* UserData);
+void     SOCKET_ReleaseBus(void* UserData);
+
+/**
+ * Sends all bytes to, or receives all bytes from, a socket
+ *
+ * \return true if successful
+ */
+bool SOCKET_SendAll(int Fd, const void* Data, uint32_t Length);
+bool SOCKET_ReceiveAll(int Fd, void* Data, uint32_t Length);
+
+#ifdef __cplusplus    /* matches __cplusplus construct above */
+}
+#endif
+#endif /* SOCKET_TRANSPORT_H */
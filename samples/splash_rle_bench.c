@@ -0,0 +1,268 @@
+/*------------------------------------------------------------------------------
+ * Copyright (c) 2019 Texas Instruments Incorporated - http://www.ti.com/
+ *------------------------------------------------------------------------------
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief  Benchmarks the splash screen encoder on 1080p content and checks
+ *         that every encoding decodes back to the converted image.
+ *
+ * Usage: splash_rle_bench [<raw RGB888 1920x1080 file> ...]
+ *
+ * Without files a set of synthetic images is used. The exit code is
+ * nonzero if any round trip fails.
+ */
+
+#include "dlpc34xx_splash.h"
+#include "dlpc_common_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_WIDTH     1920
+#define IMAGE_HEIGHT    1080
+#define IMAGE_SIZE      (IMAGE_WIDTH * IMAGE_HEIGHT * 3)
+#define ITERATIONS      5
+
+typedef struct
+{
+    const char*                 Name;
+    DLPC34XX_PixelFormats_e     PixelFormat;
+    DLPC34XX_CompressionTypes_e Compression;
+    bool                        Smallest;
+} Encoding_s;
+
+static const Encoding_s s_Encodings[] =
+{
+    { "RGB565",          DLPC34XX_PF_RGB565,   DLPC34XX_CT_UNCOMPRESSED,       false },
+    { "RGB565 RLE",      DLPC34XX_PF_RGB565,   DLPC34XX_CT_RGB_RLE_COMPRESSED, false },
+    { "YCbCr422",        DLPC34XX_PF_YCBCR422, DLPC34XX_CT_UNCOMPRESSED,       false },
+    { "YCbCr422 RLE",    DLPC34XX_PF_YCBCR422, DLPC34XX_CT_YUV_RLE_COMPRESSED, false },
+    { "smallest",        DLPC34XX_PF_RGB565,   DLPC34XX_CT_UNCOMPRESSED,       true  },
+};
+
+static uint8_t s_Image[IMAGE_SIZE];
+static uint8_t s_Expected[IMAGE_WIDTH * IMAGE_HEIGHT * 2];
+static uint8_t s_Decoded[IMAGE_WIDTH * IMAGE_HEIGHT * 2];
+static uint8_t s_Encoded[IMAGE_WIDTH * IMAGE_HEIGHT * 3 + IMAGE_HEIGHT * 2 + 2];
+
+static void SetPixel(uint32_t X, uint32_t Y, uint8_t R, uint8_t G, uint8_t B)
+{
+    uint8_t* Pixel = &s_Image[(Y * IMAGE_WIDTH + X) * 3];
+
+    Pixel[0] = R;
+    Pixel[1] = G;
+    Pixel[2] = B;
+}
+
+/* Fills one of the synthetic images, returns its name or NULL past the last */
+static const char* MakeSyntheticImage(uint32_t Index)
+{
+    static const uint8_t s_Bars[8][3] =
+    {
+        { 255, 255, 255 }, { 255, 255, 0 }, { 0, 255, 255 }, { 0, 255, 0 },
+        { 255, 0, 255 }, { 255, 0, 0 }, { 0, 0, 255 }, { 0, 0, 0 },
+    };
+    uint32_t X;
+    uint32_t Y;
+    uint32_t Box;
+    uint32_t Left;
+    uint32_t Top;
+    uint8_t  Level;
+
+    srand(Index + 1);
+
+    switch (Index)
+    {
+        case 0:
+            for (Y = 0; Y < IMAGE_HEIGHT; Y++)
+            {
+                for (X = 0; X < IMAGE_WIDTH; X++)
+                {
+                    const uint8_t* Bar = s_Bars[X * 8 / IMAGE_WIDTH];
+                    SetPixel(X, Y, Bar[0], Bar[1], Bar[2]);
+                }
+            }
+            return "color bars";
+
+        case 1:
+            for (Y = 0; Y < IMAGE_HEIGHT; Y++)
+            {
+                for (X = 0; X < IMAGE_WIDTH; X++)
+                {
+                    SetPixel(X, Y, (uint8_t)(X * 256 / IMAGE_WIDTH), (uint8_t)(Y * 256 / IMAGE_HEIGHT), 128);
+                }
+            }
+            return "gradient";
+
+        case 2:
+            /* Flat background with boxes and sparse glyph-like detail */
+            memset(s_Image, 0x20, IMAGE_SIZE);
+            for (Box = 0; Box < 40; Box++)
+            {
+                Left  = rand() % (IMAGE_WIDTH - 200);
+                Top   = rand() % (IMAGE_HEIGHT - 100);
+                Level = (uint8_t)(rand() % 256);
+                for (Y = Top; Y < Top + 100; Y++)
+                {
+                    for (X = Left; X < Left + 200; X++)
+                    {
+                        SetPixel(X, Y, Level, (uint8_t)(255 - Level), 64);
+                    }
+                }
+            }
+            for (Box = 0; Box < 20000; Box++)
+            {
+                SetPixel(rand() % IMAGE_WIDTH, rand() % IMAGE_HEIGHT, 255, 255, 255);
+            }
+            return "user interface";
+
+        case 3:
+            for (X = 0; X < IMAGE_SIZE; X++)
+            {
+                s_Image[X] = (uint8_t)rand();
+            }
+            return "noise";
+
+        default:
+            return NULL;
+    }
+}
+
+static void ConvertImage(DLPC34XX_PixelFormats_e PixelFormat)
+{
+    uint32_t Y;
+
+    for (Y = 0; Y < IMAGE_HEIGHT; Y++)
+    {
+        DLPC34XX_SPLASH_ConvertRow(&s_Image[Y * IMAGE_WIDTH * 3], IMAGE_WIDTH, PixelFormat,
+                                   &s_Expected[Y * IMAGE_WIDTH * 2]);
+    }
+}
+
+/* Encodes the image every way, returns the number of failed round trips */
+static uint32_t BenchmarkImage(const char* Name)
+{
+    DLPC34XX_SplashScreenHeader_s Header;
+    const Encoding_s*             Encoding;
+    uint64_t                      EncodeMicroseconds;
+    uint64_t                      DecodeMicroseconds;
+    uint64_t                      Start;
+    uint32_t                      Failures = 0;
+    uint32_t                      Status = SUCCESS;
+    uint32_t                      Index;
+    uint32_t                      Iteration;
+
+    printf("%s\n", Name);
+
+    for (Index = 0; Index < sizeof(s_Encodings) / sizeof(s_Encodings[0]); Index++)
+    {
+        Encoding = &s_Encodings[Index];
+
+        Start = DLPC_COMMON_GetTimeInMicroseconds();
+        for (Iteration = 0; (Iteration < ITERATIONS) && (Status == SUCCESS); Iteration++)
+        {
+            if (Encoding->Smallest)
+            {
+                Status = DLPC34XX_SPLASH_EncodeSmallest(s_Image, IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 3,
+                                                        s_Encoded, sizeof(s_Encoded), &Header);
+            }
+            else
+            {
+                Status = DLPC34XX_SPLASH_EncodeImage(s_Image, IMAGE_WIDTH, IMAGE_HEIGHT, IMAGE_WIDTH * 3,
+                                                     Encoding->PixelFormat, Encoding->Compression,
+                                                     s_Encoded, sizeof(s_Encoded), &Header);
+            }
+        }
+        EncodeMicroseconds = (DLPC_COMMON_GetTimeInMicroseconds() - Start) / ITERATIONS;
+
+        Start = DLPC_COMMON_GetTimeInMicroseconds();
+        for (Iteration = 0; (Iteration < ITERATIONS) && (Status == SUCCESS); Iteration++)
+        {
+            Status = DLPC34XX_SPLASH_DecodeImage(&Header, s_Encoded, s_Decoded, sizeof(s_Decoded));
+        }
+        DecodeMicroseconds = (DLPC_COMMON_GetTimeInMicroseconds() - Start) / ITERATIONS;
+
+        ConvertImage(Header.PixelFormat);
+        if ((Status != SUCCESS) || (memcmp(s_Decoded, s_Expected, sizeof(s_Expected)) != 0))
+        {
+            printf("  %-14s round trip FAILED (status %u)\n", Encoding->Name, Status);
+            Failures++;
+            Status = SUCCESS;
+            continue;
+        }
+
+        printf("  %-14s %9u bytes %6.1f%%  encode %7.2f ms %7.1f MB/s  decode %7.2f ms\n",
+               Encoding->Name,
+               Header.SizeInBytes,
+               100.0 * Header.SizeInBytes / (IMAGE_WIDTH * IMAGE_HEIGHT * 2),
+               EncodeMicroseconds / 1000.0,
+               (EncodeMicroseconds > 0) ? (double)IMAGE_SIZE / EncodeMicroseconds : 0.0,
+               DecodeMicroseconds / 1000.0);
+    }
+
+    return Failures;
+}
+
+int main(int argc, char** argv)
+{
+    DLPC_COMMON_MappedFile_s File;
+    const char*              Name;
+    uint32_t                 Failures = 0;
+    int                      Index;
+
+    if (argc > 1)
+    {
+        for (Index = 1; Index < argc; Index++)
+        {
+            if ((DLPC_COMMON_MapFile(argv[Index], &File) != SUCCESS) || (File.Size < IMAGE_SIZE))
+            {
+                printf("Cannot read a %ux%u RGB888 image from %s\n", IMAGE_WIDTH, IMAGE_HEIGHT, argv[Index]);
+                return 1;
+            }
+            memcpy(s_Image, File.Data, IMAGE_SIZE);
+            DLPC_COMMON_UnmapFile(&File);
+
+            Failures += BenchmarkImage(argv[Index]);
+        }
+    }
+    else
+    {
+        for (Index = 0; (Name = MakeSyntheticImage(Index)) != NULL; Index++)
+        {
+            Failures += BenchmarkImage(Name);
+        }
+    }
+
+    printf("%u round trip failures\n", Failures);
+    return (Failures == 0) ? 0 : 1;
+}